@@ -0,0 +1,257 @@
+#include <DMA.hh>
+
+
+std::array<DMAStream*, dmaStreamsCount> DMAStream::streams{};
+
+DMAStream::DMAStream()
+    : DMAStreamParent(DMARequest::null)
+{
+}
+
+DMAStream::DMAStream(const DMARequest &request)
+    : DMAStreamParent(DMARequest::null)
+{
+    this->setAllParametersValue(request);
+}
+
+DMAStream::~DMAStream()
+{
+    release();
+}
+
+/** @brief Takes a stream for the request set since the last call, releasing the previous one */
+DMAStatusCodes DMAStream::init()
+{
+    if(!this->areMandatoryParametersSet())
+        return DMAStatusCodes::notReadyNotReset;
+    if(this->getDirtyParameters().none() && isReady())
+        return DMAStatusCodes::Ready;
+
+    for(const DMAStatusCodes& status : DMAStreamParent::init())
+    {
+        if(status != DMAStatusCodes::Ready)
+        {
+            this->setStatus(status);
+            return status;
+        }
+    }
+    enableIRQ(streamIRQs[getDMAStreamIndex(*route)]);
+    this->setStatus(DMAStatusCodes::Ready);
+    return DMAStatusCodes::Ready;
+}
+
+/** @brief Applied right away once the stream is initialized; before that, by the first init (Reset is returned) */
+DMAStatusCodes DMAStream::setRequest(const DMARequest &request)
+{
+    this->template setParameterValue<DMAStreamProperties::request>(request);
+    return isReady() ? init() : DMAStatusCodes::Reset;
+}
+
+/**
+ * @brief The stream is programmed with EN cleared, its flags cleared first so stale events of a previous transfer do
+ * not reach the new callback
+ */
+DMAStatusCodes DMAStream::start(const DMATransfer &transfer)
+{
+    if(!isReady())
+        return DMAStatusCodes::notReadyNotReset;
+    const DMAStatusCodes validation = validateDMATransfer(transfer, route->request);
+    if(validation != DMAStatusCodes::Ready)
+        return validation;
+    if(isBusy())
+        return DMAStatusCodes::busy;
+
+    readAndClearFlags();
+    callback = transfer.callback;
+    context = transfer.context;
+    events = transfer.events;
+
+    const bool doubleBuffer = transfer.memory1 != nullptr;
+    this->instance->PAR = getBusAddress(transfer.peripheral);
+    this->instance->M0AR = getBusAddress(transfer.memory);
+    this->instance->M1AR = doubleBuffer ? getBusAddress(transfer.memory1) : 0x0U;
+    this->instance->NDTR = transfer.length;
+    this->instance->FCR = transfer.fifoThreshold == DMAFifoThreshold::direct ? 0x0U
+        : DMA_SxFCR_DMDIS | (static_cast<uint32_t>(transfer.fifoThreshold) << DMA_SxFCR_FTH_Pos) | ((transfer.events & dmaFifoErrorEvent) ? DMA_SxFCR_FEIE : 0x0U);
+    this->instance->CR = (static_cast<uint32_t>(route->channel) << DMA_SxCR_CHSEL_Pos)
+        | (static_cast<uint32_t>(transfer.memoryBurst) << DMA_SxCR_MBURST_Pos) | (static_cast<uint32_t>(transfer.peripheralBurst) << DMA_SxCR_PBURST_Pos)
+        | (doubleBuffer ? DMA_SxCR_DBM : 0x0U) | (static_cast<uint32_t>(transfer.priority) << DMA_SxCR_PL_Pos)
+        | (static_cast<uint32_t>(transfer.memorySize) << DMA_SxCR_MSIZE_Pos) | (static_cast<uint32_t>(transfer.peripheralSize) << DMA_SxCR_PSIZE_Pos)
+        | (transfer.memoryIncrement ? DMA_SxCR_MINC : 0x0U) | (transfer.peripheralIncrement ? DMA_SxCR_PINC : 0x0U)
+        | ((transfer.circular || doubleBuffer) ? DMA_SxCR_CIRC : 0x0U) | (static_cast<uint32_t>(transfer.direction) << DMA_SxCR_DIR_Pos)
+        | ((transfer.events & dmaHalfTransferEvent) ? DMA_SxCR_HTIE : 0x0U) | ((transfer.events & dmaTransferCompleteEvent) ? DMA_SxCR_TCIE : 0x0U)
+        | ((transfer.events & dmaTransferErrorEvent) ? (DMA_SxCR_TEIE | DMA_SxCR_DMEIE) : 0x0U);
+    this->instance->CR = static_cast<uint32_t>(this->instance->CR) | DMA_SxCR_EN;
+    holdPowerConstraint();
+    return DMAStatusCodes::Ready;
+}
+
+/** @brief A stream only accepts a new configuration once EN reads back as 0, after the current beat or burst */
+bool DMAStream::stop()
+{
+    constexpr uint32_t streamDisableTimeout { 10000U };
+    if(this->instance == nullptr)
+        return true;
+    this->instance->CR = static_cast<uint32_t>(this->instance->CR) & ~DMA_SxCR_EN;
+    for(uint32_t i = 0; i < streamDisableTimeout; ++i)
+    {
+        if(!isBusy())
+        {
+            dropPowerConstraint();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DMAStream::isBusy() const
+{
+    return this->instance != nullptr && (static_cast<uint32_t>(this->instance->CR) & DMA_SxCR_EN);
+}
+
+uint16_t DMAStream::getRemaining() const
+{
+    return this->instance == nullptr ? 0U : static_cast<uint16_t>(this->instance->NDTR);
+}
+
+bool DMAStream::isOnMemory1() const
+{
+    return this->instance != nullptr && (static_cast<uint32_t>(this->instance->CR) & DMA_SxCR_CT);
+}
+
+/** @brief Replaces the buffer of the double buffer pair the stream is not using. It is picked up at the next switch */
+void DMAStream::setIdleBuffer(const volatile void *buffer)
+{
+    if(isOnMemory1())
+        this->instance->M0AR = getBusAddress(buffer);
+    else
+        this->instance->M1AR = getBusAddress(buffer);
+}
+
+/**
+ * @brief Hands the subscribed events among the flags raised to the callback of the transfer. A stream the hardware
+ * disabled (end of a one-shot transfer, error), and the callback did not start again, no longer needs its clock in sleep
+ */
+void DMAStream::handleInterrupt()
+{
+    const uint32_t raised = readAndClearFlags() & events;
+    if(raised && callback != nullptr)
+        callback(raised, context);
+    if(!isBusy())
+        dropPowerConstraint();
+}
+
+/**
+ * @brief Free stream among the ones wired to request that the fewest peripheral requests can use. Ties go to the
+ * first listed in dmaRequestMap
+ */
+const DMARequestRoute* DMAStream::findFreeStream(const DMARequest &request)
+{
+    const DMARequestRoute* best { nullptr };
+    for(const DMARequestRoute& candidate : dmaRequestMap)
+    {
+        if(candidate.request != request || streams[getDMAStreamIndex(candidate)] != nullptr)
+            continue;
+        if(best == nullptr || getDMAStreamDemand(getDMAStreamIndex(candidate)) < getDMAStreamDemand(getDMAStreamIndex(*best)))
+            best = &candidate;
+    }
+    return best;
+}
+
+/** @brief Trades the stream held for one serving request, and takes the clock of its controller */
+DMAStatusCodes DMAStream::configRequest(const DMARequest &request, DMAStream &stream)
+{
+    stream.release();
+    if(request == DMARequest::null)
+        return DMAStatusCodes::invalidRequest;
+    const DMARequestRoute* route = findFreeStream(request);
+    if(route == nullptr)
+        return DMAStatusCodes::noStreamAvailable;
+
+    const uint32_t controllerBase = route->controller ? DMA2_BASE : DMA1_BASE;
+    if(!stream.setInstancePtr(getPeripheralInstance<DMA_Stream_TypeDef>(controllerBase + 0x10U + 0x18U * route->stream)))
+        return DMAStatusCodes::notReadyNotReset;
+    stream.dmaClock = PeripheralClockHandle<>(route->controller ? AvailablePeripherals::_DMA2 : AvailablePeripherals::_DMA1);
+    stream.route = route;
+    streams[getDMAStreamIndex(*route)] = &stream;
+    return DMAStatusCodes::Ready;
+}
+
+/** @brief Stops the transfer and frees the stream for other drivers. The request is left dirty so init claims a stream again */
+void DMAStream::release()
+{
+    if(route == nullptr)
+        return;
+    stop();
+    dropPowerConstraint();
+    streams[getDMAStreamIndex(*route)] = nullptr;
+    route = nullptr;
+    callback = nullptr;
+    dmaClock.release();
+    this->setAllParametersDirty();
+    this->setStatus(DMAStatusCodes::Reset);
+}
+
+DMA_TypeDef* DMAStream::getDMA() const
+{
+    return getPeripheralInstance<DMA_TypeDef>(route->controller ? DMA2_BASE : DMA1_BASE);
+}
+
+/** @brief Interrupt flags of the stream, shifted down to the stream 0 positions (DMA_LISR_xxIF0) */
+uint32_t DMAStream::readAndClearFlags()
+{
+    DMA_TypeDef* dma = getDMA();
+    const bool low = route->stream < 4U;
+    const uint32_t shift = streamFlagShifts[route->stream % 4U];
+    const uint32_t flags = ((low ? static_cast<uint32_t>(dma->LISR) : static_cast<uint32_t>(dma->HISR)) >> shift) & streamFlags;
+    if(low)
+        dma->LIFCR = flags << shift;
+    else
+        dma->HIFCR = flags << shift;
+    return flags;
+}
+
+/** @brief Keeps the controller clock running in sleep, and the idle path out of stop, while a transfer runs */
+void DMAStream::holdPowerConstraint()
+{
+    if(powerConstraint == PowerConstraints::invalidConstraint)
+        powerConstraint = PowerConstraints::addWakeLatencyConstraint(PowerConstraints::sleepOnly, getPeripheralClockMask(dmaClock.getPeripheral()));
+}
+
+void DMAStream::dropPowerConstraint()
+{
+    PowerConstraints::removeWakeLatencyConstraint(powerConstraint);
+    powerConstraint = PowerConstraints::invalidConstraint;
+}
+
+void DMAStream::enableIRQ(const IRQn_Type &irq)
+{
+    PeripheralRegisters<NVIC_Type, NVIC_BASE>::get()->ISER[static_cast<uint32_t>(irq) >> 5U] = 0x1U << (static_cast<uint32_t>(irq) & 0x1FU);
+}
+
+
+// DMA stream interrupt handlers. They override the weak aliases of startup_stm32f411retx.s
+
+template<std::size_t Index>
+static void dispatchInterrupt()
+{
+    if(DMAStream* driver = DMAStream::getDriver(Index))
+        driver->handleInterrupt();
+}
+
+extern "C" void DMA1_Stream0_IRQHandler() { dispatchInterrupt<0>(); }
+extern "C" void DMA1_Stream1_IRQHandler() { dispatchInterrupt<1>(); }
+extern "C" void DMA1_Stream2_IRQHandler() { dispatchInterrupt<2>(); }
+extern "C" void DMA1_Stream3_IRQHandler() { dispatchInterrupt<3>(); }
+extern "C" void DMA1_Stream4_IRQHandler() { dispatchInterrupt<4>(); }
+extern "C" void DMA1_Stream5_IRQHandler() { dispatchInterrupt<5>(); }
+extern "C" void DMA1_Stream6_IRQHandler() { dispatchInterrupt<6>(); }
+extern "C" void DMA1_Stream7_IRQHandler() { dispatchInterrupt<7>(); }
+extern "C" void DMA2_Stream0_IRQHandler() { dispatchInterrupt<8>(); }
+extern "C" void DMA2_Stream1_IRQHandler() { dispatchInterrupt<9>(); }
+extern "C" void DMA2_Stream2_IRQHandler() { dispatchInterrupt<10>(); }
+extern "C" void DMA2_Stream3_IRQHandler() { dispatchInterrupt<11>(); }
+extern "C" void DMA2_Stream4_IRQHandler() { dispatchInterrupt<12>(); }
+extern "C" void DMA2_Stream5_IRQHandler() { dispatchInterrupt<13>(); }
+extern "C" void DMA2_Stream6_IRQHandler() { dispatchInterrupt<14>(); }
+extern "C" void DMA2_Stream7_IRQHandler() { dispatchInterrupt<15>(); }
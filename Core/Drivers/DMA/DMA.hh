@@ -0,0 +1,285 @@
+#ifndef __DMA_H__
+#define __DMA_H__
+
+/**
+ * @file DMA.hh
+ * @brief Streams of DMA1/DMA2 handed out per request. A driver asks for the request of its peripheral (USART2_RX,
+ * SPI1_TX, memory to memory...) and gets one of the streams the request is wired to in RM0383 tables 27/28, with the
+ * matching channel. When several streams can serve it, the free one fewest other requests can use is taken, so the
+ * streams peripherals compete for stay available.
+ *
+ * Interrupts of the 16 streams go through one flat table, indexed by controller * 8 + stream, to the driver holding
+ * the stream, which hands the events of its transfer to the callback given with it.
+ *
+ * A busy stream holds a sleepOnly power constraint with its controller clock, from start until stop or the interrupt
+ * that finds it disabled, so the idle path does not stop the transfer.
+ */
+
+#include <STM32PeripheralBase.hh>
+#include <FlatContainer.hh>
+#include <PeripheralClockHandle.hh>
+#include <PowerConstraints.hh>
+#include <array>
+
+
+enum class DMAStatusCodes
+{
+    Reset,
+    Ready,
+    busy,
+    invalidRequest,
+    invalidTransfer,
+    noStreamAvailable,
+    notReadyNotReset,
+    streamBusy,
+    transferError,
+};
+
+// ADC1 and SDIO being CMSIS macros, their requests are named after the data they move
+enum class DMARequest : uint8_t
+{
+    memoryToMemory,
+    ADC1_DATA,
+    SDIO_DATA,
+    SPI1_RX, SPI1_TX, SPI2_RX, SPI2_TX, SPI3_RX, SPI3_TX, SPI4_RX, SPI4_TX, SPI5_RX, SPI5_TX,
+    I2C1_RX, I2C1_TX, I2C2_RX, I2C2_TX, I2C3_RX, I2C3_TX,
+    USART1_RX, USART1_TX, USART2_RX, USART2_TX, USART6_RX, USART6_TX,
+    TIM1_UP, TIM2_UP, TIM3_UP, TIM4_UP, TIM5_UP,
+    null,
+};
+
+// Register field values: DIR, PSIZE/MSIZE, PBURST/MBURST, FTH and PL of RM0383 9.5.5/9.5.10
+enum class DMADirection : uint8_t { peripheralToMemory = 0x0U, memoryToPeripheral = 0x1U, memoryToMemory = 0x2U };
+enum class DMADataSize : uint8_t { byte = 0x0U, halfWord = 0x1U, word = 0x2U };
+enum class DMABurst : uint8_t { single = 0x0U, incremental4 = 0x1U, incremental8 = 0x2U, incremental16 = 0x3U };
+// direct disables the FIFO: every request moves one item straight through
+enum class DMAFifoThreshold : uint8_t { quarter = 0x0U, half = 0x1U, threeQuarters = 0x2U, full = 0x3U, direct = 0x4U };
+enum class DMAPriority : uint8_t { low = 0x0U, medium = 0x1U, high = 0x2U, veryHigh = 0x3U };
+
+// Events of a stream: its interrupt flags, shifted down to the stream 0 positions (DMA_LISR_xxIF0)
+constexpr uint32_t dmaHalfTransferEvent { DMA_LISR_HTIF0 };
+constexpr uint32_t dmaTransferCompleteEvent { DMA_LISR_TCIF0 };
+constexpr uint32_t dmaTransferErrorEvent { DMA_LISR_TEIF0 | DMA_LISR_DMEIF0 };
+constexpr uint32_t dmaFifoErrorEvent { DMA_LISR_FEIF0 };
+
+using DMACallback = void(*)(const uint32_t& events, void* context);
+
+/**
+ * @brief One transfer of a stream. With memoryToMemory, peripheral is the source and memory the destination. length
+ * counts items of peripheralSize
+ */
+struct DMATransfer
+{
+    DMADirection direction { DMADirection::peripheralToMemory };
+    const volatile void* peripheral { nullptr };
+    const volatile void* memory { nullptr };
+    // Second buffer of double buffer mode: the stream alternates between memory and memory1 until stopped
+    const volatile void* memory1 { nullptr };
+    uint16_t length { 0 };
+    DMADataSize peripheralSize { DMADataSize::byte };
+    DMADataSize memorySize { DMADataSize::byte };
+    bool peripheralIncrement { false };
+    bool memoryIncrement { true };
+    bool circular { false };
+    DMAPriority priority { DMAPriority::low };
+    DMAFifoThreshold fifoThreshold { DMAFifoThreshold::direct };
+    DMABurst peripheralBurst { DMABurst::single };
+    DMABurst memoryBurst { DMABurst::single };
+    // Called from the stream interrupt with the events among events that occurred
+    DMACallback callback { nullptr };
+    void* context { nullptr };
+    uint32_t events { dmaTransferCompleteEvent | dmaTransferErrorEvent };
+};
+
+/** @brief Stream a request is wired to. controller is 0 for DMA1 and 1 for DMA2 */
+struct DMARequestRoute
+{
+    DMARequest request;
+    uint8_t controller;
+    uint8_t stream;
+    uint8_t channel;
+};
+
+constexpr std::size_t dmaStreamsCount { 16 };
+
+/**
+ * @brief Request mapping of RM0383 tables 27 (DMA1) and 28 (DMA2). Only DMA2 can access memory on both sides: memory
+ * to memory is served by its streams, listed from the lowest arbitration priority
+ */
+constexpr std::array<DMARequestRoute, 56> dmaRequestMap
+{{
+    { DMARequest::SPI3_RX, 0, 0, 0 }, { DMARequest::SPI3_RX, 0, 2, 0 }, { DMARequest::SPI2_RX, 0, 3, 0 }, { DMARequest::SPI2_TX, 0, 4, 0 },
+    { DMARequest::SPI3_TX, 0, 5, 0 }, { DMARequest::SPI3_TX, 0, 7, 0 },
+    { DMARequest::I2C1_RX, 0, 0, 1 }, { DMARequest::I2C3_RX, 0, 1, 1 }, { DMARequest::I2C1_RX, 0, 5, 1 }, { DMARequest::I2C1_TX, 0, 6, 1 },
+    { DMARequest::I2C1_TX, 0, 7, 1 },
+    { DMARequest::TIM4_UP, 0, 6, 2 },
+    { DMARequest::TIM2_UP, 0, 1, 3 }, { DMARequest::I2C3_RX, 0, 2, 3 }, { DMARequest::I2C3_TX, 0, 4, 3 }, { DMARequest::TIM2_UP, 0, 7, 3 },
+    { DMARequest::USART2_RX, 0, 5, 4 }, { DMARequest::USART2_TX, 0, 6, 4 },
+    { DMARequest::TIM3_UP, 0, 2, 5 },
+    { DMARequest::TIM5_UP, 0, 0, 6 }, { DMARequest::TIM5_UP, 0, 6, 6 },
+    { DMARequest::I2C2_RX, 0, 2, 7 }, { DMARequest::I2C2_RX, 0, 3, 7 }, { DMARequest::I2C2_TX, 0, 7, 7 },
+
+    { DMARequest::ADC1_DATA, 1, 0, 0 }, { DMARequest::ADC1_DATA, 1, 4, 0 },
+    { DMARequest::SPI5_RX, 1, 3, 2 }, { DMARequest::SPI5_TX, 1, 4, 2 },
+    { DMARequest::SPI1_RX, 1, 0, 3 }, { DMARequest::SPI1_RX, 1, 2, 3 }, { DMARequest::SPI1_TX, 1, 3, 3 }, { DMARequest::SPI1_TX, 1, 5, 3 },
+    { DMARequest::SPI4_RX, 1, 0, 4 }, { DMARequest::SPI4_TX, 1, 1, 4 }, { DMARequest::USART1_RX, 1, 2, 4 }, { DMARequest::SDIO_DATA, 1, 3, 4 },
+    { DMARequest::USART1_RX, 1, 5, 4 }, { DMARequest::SDIO_DATA, 1, 6, 4 }, { DMARequest::USART1_TX, 1, 7, 4 },
+    { DMARequest::USART6_RX, 1, 1, 5 }, { DMARequest::USART6_RX, 1, 2, 5 }, { DMARequest::SPI4_RX, 1, 3, 5 }, { DMARequest::SPI4_TX, 1, 4, 5 },
+    { DMARequest::USART6_TX, 1, 6, 5 }, { DMARequest::USART6_TX, 1, 7, 5 },
+    { DMARequest::TIM1_UP, 1, 5, 6 },
+    { DMARequest::SPI5_RX, 1, 5, 7 }, { DMARequest::SPI5_TX, 1, 6, 7 },
+
+    { DMARequest::memoryToMemory, 1, 7, 0 }, { DMARequest::memoryToMemory, 1, 6, 0 }, { DMARequest::memoryToMemory, 1, 5, 0 }, { DMARequest::memoryToMemory, 1, 4, 0 },
+    { DMARequest::memoryToMemory, 1, 3, 0 }, { DMARequest::memoryToMemory, 1, 2, 0 }, { DMARequest::memoryToMemory, 1, 1, 0 }, { DMARequest::memoryToMemory, 1, 0, 0 },
+}};
+
+/** @brief Clock of the controller serving request. Every stream a request is wired to is on the same controller */
+constexpr AvailablePeripherals getDMARequestPeripheral(const DMARequest& request)
+{
+    for(const DMARequestRoute& route : dmaRequestMap)
+    {
+        if(route.request == request)
+            return route.controller ? AvailablePeripherals::_DMA2 : AvailablePeripherals::_DMA1;
+    }
+    return AvailablePeripherals::_DMA2;
+}
+
+constexpr std::size_t getDMAStreamIndex(const DMARequestRoute& route) { return route.controller * 8U + route.stream; }
+
+/** @brief Number of peripheral requests stream index can serve: the arbitration cost of taking it */
+constexpr uint32_t getDMAStreamDemand(const std::size_t& index)
+{
+    uint32_t demand { 0 };
+    for(const DMARequestRoute& route : dmaRequestMap)
+    {
+        if(route.request != DMARequest::memoryToMemory && getDMAStreamIndex(route) == index)
+            ++demand;
+    }
+    return demand;
+}
+
+constexpr uint32_t getDMADataSizeBytes(const DMADataSize& size) { return 0x1U << static_cast<uint32_t>(size); }
+constexpr uint32_t getDMABurstBeats(const DMABurst& burst) { return burst == DMABurst::single ? 1U : 0x2U << static_cast<uint32_t>(burst); }
+
+/**
+ * @brief Checks transfer against the constraints of RM0383 9.3: memory to memory only on its own request, with the
+ * FIFO and without circular mode; bursts only through the FIFO, and a memory burst has to fit the FIFO threshold
+ * evenly; the length has to be a whole number of memory items
+ */
+constexpr DMAStatusCodes validateDMATransfer(const DMATransfer& transfer, const DMARequest& request)
+{
+    if(transfer.length == 0 || transfer.peripheral == nullptr || transfer.memory == nullptr)
+        return DMAStatusCodes::invalidTransfer;
+    const bool memoryToMemory = transfer.direction == DMADirection::memoryToMemory;
+    if(memoryToMemory != (request == DMARequest::memoryToMemory))
+        return DMAStatusCodes::invalidTransfer;
+    const bool doubleBuffer = transfer.memory1 != nullptr;
+    if(memoryToMemory && (transfer.circular || doubleBuffer || transfer.fifoThreshold == DMAFifoThreshold::direct))
+        return DMAStatusCodes::invalidTransfer;
+
+    const uint32_t memoryItem = getDMADataSizeBytes(transfer.memorySize);
+    if(transfer.fifoThreshold == DMAFifoThreshold::direct)
+    {
+        // In direct mode the memory side takes the peripheral data size
+        if(transfer.memorySize != transfer.peripheralSize || transfer.memoryBurst != DMABurst::single || transfer.peripheralBurst != DMABurst::single)
+            return DMAStatusCodes::invalidTransfer;
+    }
+    else
+    {
+        const uint32_t thresholdBytes = (static_cast<uint32_t>(transfer.fifoThreshold) + 1U) * 4U;
+        const uint32_t memoryBurstBytes = getDMABurstBeats(transfer.memoryBurst) * memoryItem;
+        if(memoryBurstBytes > thresholdBytes || thresholdBytes % memoryBurstBytes)
+            return DMAStatusCodes::invalidTransfer;
+    }
+    if((transfer.length * getDMADataSizeBytes(transfer.peripheralSize)) % memoryItem)
+        return DMAStatusCodes::invalidTransfer;
+    return DMAStatusCodes::Ready;
+}
+
+
+enum class DMAStreamProperties : uint8_t { request, __length };
+constexpr std::size_t DMAStreamMandatoryParameters = 1 << static_cast<std::size_t>(DMAStreamProperties::request);
+class DMAStream;
+using DMAStreamPropertiesContainer = FlatContainer<DMAStreamProperties, DMARequest>;
+using DMAStreamPeripheralBase = PeripheralBase<DMAStream, DMAStatusCodes, DMAStreamMandatoryParameters, DMAStreamPropertiesContainer>;
+using DMAStreamParent = STM32PeripheralBase<DMA_Stream_TypeDef, DMAStreamPeripheralBase>;
+using DMAStreamFunctionsContainer = DMAStreamPeripheralBase::ConfigFunctionsType;
+
+
+class DMAStream : public DMAStreamParent
+{
+    public:
+
+        // Constructors & Destructor
+        DMAStream();
+        explicit DMAStream(const DMARequest &request);
+        ~DMAStream();
+        DMAStream(const DMAStream &) = delete;
+        DMAStream &operator=(const DMAStream &) = delete;
+
+        // Takes a stream for the request, if it changed since the last call
+        DMAStatusCodes init();
+        DMAStatusCodes setRequest(const DMARequest &request);
+        bool isReady() const { return getStatus() == DMAStatusCodes::Ready; }
+
+        /**
+         * @brief Programs and enables the stream. The buffers have to stay valid until the transfer completes, or
+         * until stop() for circular and double buffer transfers
+         */
+        DMAStatusCodes start(const DMATransfer &transfer);
+        // Disables the stream. False if it did not stop within the timeout
+        bool stop();
+        // Stops the transfer and frees the stream for the other drivers. The next init takes one again
+        void release();
+        bool isBusy() const;
+        // Items left in the current block (NDTR)
+        uint16_t getRemaining() const;
+
+        // Double buffer mode: buffer the stream is filling or draining, and replacement of the other one
+        bool isOnMemory1() const;
+        void setIdleBuffer(const volatile void *buffer);
+
+        // Stream held, once initialized
+        const DMARequestRoute *getRoute() const { return route; }
+
+        // Dispatch from the IRQ handlers
+        void handleInterrupt();
+        static DMAStream *getDriver(const std::size_t &index) { return streams[index]; }
+
+    private:
+
+        // The config functions are bound at compile time: PeripheralBase::init calls them directly
+        friend DMAStreamPeripheralBase;
+        static constexpr DMAStreamFunctionsContainer getConfigFunctions() { return { &DMAStream::configRequest }; }
+
+        static DMAStatusCodes configRequest(const DMARequest &request, DMAStream &stream);
+
+        static constexpr uint32_t streamFlags { DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0 };
+        static constexpr std::array<uint32_t, 4> streamFlagShifts { 0U, 6U, 16U, 22U };
+        static constexpr std::array<IRQn_Type, dmaStreamsCount> streamIRQs
+        {
+            DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn, DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+            DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn, DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn,
+        };
+
+        static const DMARequestRoute *findFreeStream(const DMARequest &request);
+        DMA_TypeDef *getDMA() const;
+        uint32_t readAndClearFlags();
+        static void enableIRQ(const IRQn_Type &irq);
+        void holdPowerConstraint();
+        void dropPowerConstraint();
+
+        const DMARequestRoute *route { nullptr };
+        DMACallback callback { nullptr };
+        void *context { nullptr };
+        uint32_t events { 0 };
+        uint8_t powerConstraint { PowerConstraints::invalidConstraint };
+
+        PeripheralClockHandle<> dmaClock;
+
+        // Driver holding every stream, indexed by controller * 8 + stream
+        static std::array<DMAStream *, dmaStreamsCount> streams;
+};
+
+
+#endif // __DMA_H__
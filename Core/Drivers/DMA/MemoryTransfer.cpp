@@ -0,0 +1,211 @@
+#include <MemoryTransfer.hh>
+#include <algorithm>
+#include <cstdint>
+
+// Word accesses allowed to alias any object, as the ones of memcpy. The unaligned one is a single LDR on the
+// Cortex-M4, which handles unaligned word loads in hardware
+using AliasedWord = uint32_t __attribute__((__may_alias__));
+using UnalignedWord = uint32_t __attribute__((__may_alias__, __aligned__(1)));
+
+
+MemoryTransfer::MemoryTransfer(const std::size_t &cpuThreshold)
+    : stream(DMARequest::memoryToMemory), cpuThreshold(cpuThreshold)
+{
+}
+
+DMAStatusCodes MemoryTransfer::init()
+{
+    return stream.init();
+}
+
+DMAStatusCodes MemoryTransfer::copy(void *destination, const void *source, const std::size_t &size, const MemoryTransferCallback &callback, void *context)
+{
+    if(destination == nullptr || source == nullptr)
+        return DMAStatusCodes::invalidTransfer;
+    if(busy)
+        return DMAStatusCodes::busy;
+    if(isDoneByCpu(size))
+    {
+        copyWithCpu(destination, source, size);
+        if(callback != nullptr)
+            callback(DMAStatusCodes::Ready, context);
+        return DMAStatusCodes::Ready;
+    }
+    return start(static_cast<uint8_t*>(destination), static_cast<const uint8_t*>(source), size, callback, context);
+}
+
+DMAStatusCodes MemoryTransfer::set(void *destination, const uint8_t &value, const std::size_t &size, const MemoryTransferCallback &callback, void *context)
+{
+    if(destination == nullptr)
+        return DMAStatusCodes::invalidTransfer;
+    if(busy)
+        return DMAStatusCodes::busy;
+    if(isDoneByCpu(size))
+    {
+        setWithCpu(destination, value, size);
+        if(callback != nullptr)
+            callback(DMAStatusCodes::Ready, context);
+        return DMAStatusCodes::Ready;
+    }
+    fillPattern = 0x01010101U * value;
+    return start(static_cast<uint8_t*>(destination), nullptr, size, callback, context);
+}
+
+/** @brief Byte-wise up to a word-aligned destination, then 16 bytes per iteration when the source is aligned too */
+void MemoryTransfer::copyWithCpu(void *destination, const void *source, const std::size_t &size)
+{
+    uint8_t* to = static_cast<uint8_t*>(destination);
+    const uint8_t* from = static_cast<const uint8_t*>(source);
+    std::size_t left = size;
+    for(; left != 0 && (reinterpret_cast<uintptr_t>(to) & 0x3U); --left)
+        *to++ = *from++;
+
+    AliasedWord* toWords = reinterpret_cast<AliasedWord*>(to);
+    if(!(reinterpret_cast<uintptr_t>(from) & 0x3U))
+    {
+        const AliasedWord* fromWords = reinterpret_cast<const AliasedWord*>(from);
+        // Four words per iteration: one LDM/STM pair
+        for(; left >= 16U; left -= 16U, toWords += 4, fromWords += 4)
+        {
+            toWords[0] = fromWords[0];
+            toWords[1] = fromWords[1];
+            toWords[2] = fromWords[2];
+            toWords[3] = fromWords[3];
+        }
+        for(; left >= 4U; left -= 4U)
+            *toWords++ = *fromWords++;
+        from = reinterpret_cast<const uint8_t*>(fromWords);
+    }
+    else
+    {
+        const UnalignedWord* fromWords = reinterpret_cast<const UnalignedWord*>(from);
+        for(; left >= 4U; left -= 4U)
+            *toWords++ = *fromWords++;
+        from = reinterpret_cast<const uint8_t*>(fromWords);
+    }
+    to = reinterpret_cast<uint8_t*>(toWords);
+
+    for(; left != 0; --left)
+        *to++ = *from++;
+}
+
+void MemoryTransfer::setWithCpu(void *destination, const uint8_t &value, const std::size_t &size)
+{
+    uint8_t* to = static_cast<uint8_t*>(destination);
+    std::size_t left = size;
+    for(; left != 0 && (reinterpret_cast<uintptr_t>(to) & 0x3U); --left)
+        *to++ = value;
+
+    const uint32_t pattern = 0x01010101U * value;
+    AliasedWord* toWords = reinterpret_cast<AliasedWord*>(to);
+    for(; left >= 16U; left -= 16U, toWords += 4)
+    {
+        toWords[0] = pattern;
+        toWords[1] = pattern;
+        toWords[2] = pattern;
+        toWords[3] = pattern;
+    }
+    for(; left >= 4U; left -= 4U)
+        *toWords++ = pattern;
+    to = reinterpret_cast<uint8_t*>(toWords);
+
+    for(; left != 0; --left)
+        *to++ = value;
+}
+
+/**
+ * @brief The CPU takes the bytes up to the first burst-aligned destination byte and the tail under a burst. Chunks
+ * are whole bursts, so both addresses keep their alignment from one chunk to the next
+ */
+DMAStatusCodes MemoryTransfer::start(uint8_t *destination, const uint8_t *source, const std::size_t &size, const MemoryTransferCallback &callback, void *context)
+{
+    const std::size_t head = std::min<std::size_t>(size, (burstBytes - (reinterpret_cast<uintptr_t>(destination) & (burstBytes - 1U))) & (burstBytes - 1U));
+    const std::size_t body = (size - head) & ~(burstBytes - 1U);
+    const std::size_t tail = size - head - body;
+    if(source == nullptr)
+    {
+        setWithCpu(destination, static_cast<uint8_t>(fillPattern), head);
+        setWithCpu(destination + head + body, static_cast<uint8_t>(fillPattern), tail);
+    }
+    else
+    {
+        copyWithCpu(destination, source, head);
+        copyWithCpu(destination + head + body, source + head + body, tail);
+    }
+
+    this->destination = destination + head;
+    this->source = source == nullptr ? nullptr : source + head;
+    this->remaining = body;
+    const uintptr_t sourceAddress = reinterpret_cast<uintptr_t>(this->source);
+    this->sourceSize = (source == nullptr || !(sourceAddress & 0x3U)) ? DMADataSize::word : DMADataSize::byte;
+    // A source burst could cross a 1 KB boundary unless it starts on one of its own size
+    this->sourceBurst = (source != nullptr && !(sourceAddress & (burstBytes - 1U))) ? DMABurst::incremental4 : DMABurst::single;
+    this->callback = callback;
+    this->context = context;
+    busy = true;
+    if(remaining == 0)
+    {
+        finish(DMAStatusCodes::Ready);
+        return DMAStatusCodes::Ready;
+    }
+
+    const DMAStatusCodes status = startChunk();
+    if(status != DMAStatusCodes::Ready)
+        busy = false;
+    return status;
+}
+
+/** @brief Up to maxItems source items, written in 4-word bursts on the 16-byte aligned destination once the FIFO is full */
+DMAStatusCodes MemoryTransfer::startChunk()
+{
+    const bool filling = source == nullptr;
+    const std::size_t item = getDMADataSizeBytes(sourceSize);
+    const std::size_t bytes = std::min(remaining, maxItems * item);
+    const DMATransfer transfer
+    {
+        .direction = DMADirection::memoryToMemory,
+        .peripheral = filling ? static_cast<const volatile void*>(&fillPattern) : static_cast<const volatile void*>(source),
+        .memory = destination,
+        .length = static_cast<uint16_t>(bytes / item),
+        .peripheralSize = sourceSize,
+        .memorySize = DMADataSize::word,
+        .peripheralIncrement = !filling,
+        .memoryIncrement = true,
+        .fifoThreshold = DMAFifoThreshold::full,
+        .peripheralBurst = sourceBurst,
+        .memoryBurst = DMABurst::incremental4,
+        .callback = &MemoryTransfer::handleStreamEvents,
+        .context = this,
+    };
+    const DMAStatusCodes status = stream.start(transfer);
+    if(status != DMAStatusCodes::Ready)
+        return status;
+    destination += bytes;
+    if(!filling)
+        source += bytes;
+    remaining -= bytes;
+    return DMAStatusCodes::Ready;
+}
+
+void MemoryTransfer::finish(const DMAStatusCodes &status)
+{
+    busy = false;
+    if(callback != nullptr)
+        callback(status, context);
+}
+
+/** @brief Stream interrupt: next chunk, or completion */
+void MemoryTransfer::handleStreamEvents(const uint32_t &events, void *context)
+{
+    MemoryTransfer& transfer = *static_cast<MemoryTransfer*>(context);
+    if(events & dmaTransferErrorEvent)
+        transfer.finish(DMAStatusCodes::transferError);
+    else if(transfer.remaining == 0)
+        transfer.finish(DMAStatusCodes::Ready);
+    else
+    {
+        const DMAStatusCodes status = transfer.startChunk();
+        if(status != DMAStatusCodes::Ready)
+            transfer.finish(status);
+    }
+}
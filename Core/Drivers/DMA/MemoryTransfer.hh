@@ -0,0 +1,83 @@
+#ifndef __MEMORYTRANSFER_H__
+#define __MEMORYTRANSFER_H__
+
+/**
+ * @file MemoryTransfer.hh
+ * @brief Bulk copies and fills on a DMA2 memory-to-memory stream, the CPU being free meanwhile. Blocks below a size
+ * threshold do not pay back programming the stream and its interrupt: the CPU does them right away, a word at a time.
+ *
+ * The stream moves the middle of a block, from the first 16-byte aligned destination byte, through its FIFO. A burst
+ * must not cross a 1 KB boundary (RM0383, 9.3.11), and the stream does not report it as an error when it does, so
+ * bursts only run on 16-byte aligned addresses: the destination is written in 4-word bursts, and the source is read
+ * in 4-word bursts when it is 16-byte aligned too, in single words when it is only word aligned, in single bytes packed
+ * into words otherwise. The head up to the aligned destination and the tail under a burst are copied by the CPU before
+ * the stream starts. Blocks longer than one stream transfer (NDTR is 16 bits) are chained from the transfer complete
+ * interrupt.
+ */
+
+#include <DMA.hh>
+#include <cstddef>
+
+// status is Ready, or transferError if the stream hit a bus error
+using MemoryTransferCallback = void(*)(const DMAStatusCodes& status, void* context);
+
+class MemoryTransfer
+{
+    public:
+
+        // Programming the stream and taking its interrupt costs about as much CPU time as copying this many bytes
+        static constexpr std::size_t defaultCpuThreshold { 256 };
+
+        // Constructors & Destructor
+        explicit MemoryTransfer(const std::size_t &cpuThreshold = defaultCpuThreshold);
+        MemoryTransfer(const MemoryTransfer &) = delete;
+        MemoryTransfer &operator=(const MemoryTransfer &) = delete;
+
+        // Takes a memory to memory stream of DMA2. Without one, every block is done by the CPU
+        DMAStatusCodes init();
+
+        /**
+         * @brief Copies size bytes from source to destination, which must not overlap. Both buffers have to stay valid
+         * until callback runs: from the stream interrupt, or before copy returns when the CPU did the whole block
+         */
+        DMAStatusCodes copy(void *destination, const void *source, const std::size_t &size, const MemoryTransferCallback &callback = nullptr, void *context = nullptr);
+        // Sets size bytes of destination to value, completing like copy
+        DMAStatusCodes set(void *destination, const uint8_t &value, const std::size_t &size, const MemoryTransferCallback &callback = nullptr, void *context = nullptr);
+        bool isBusy() const { return busy; }
+
+        // The CPU loops, on their own
+        static void copyWithCpu(void *destination, const void *source, const std::size_t &size);
+        static void setWithCpu(void *destination, const uint8_t &value, const std::size_t &size);
+
+    private:
+
+        static constexpr std::size_t burstBytes { 16 };
+        // Largest NDTR keeping a chunk a whole number of bursts
+        static constexpr std::size_t maxItems { 0xFFF0U };
+
+        bool isDoneByCpu(const std::size_t &size) const { return size < cpuThreshold || !stream.isReady(); }
+        // Head and tail by the CPU, middle to the stream. source is null for a fill
+        DMAStatusCodes start(uint8_t *destination, const uint8_t *source, const std::size_t &size, const MemoryTransferCallback &callback, void *context);
+        DMAStatusCodes startChunk();
+        void finish(const DMAStatusCodes &status);
+        static void handleStreamEvents(const uint32_t &events, void *context);
+
+        DMAStream stream;
+        std::size_t cpuThreshold;
+
+        // Part of the block left to the stream
+        uint8_t *destination { nullptr };
+        const uint8_t *source { nullptr };
+        std::size_t remaining { 0 };
+        DMADataSize sourceSize { DMADataSize::word };
+        DMABurst sourceBurst { DMABurst::single };
+        // Source of a fill: the value in every byte
+        uint32_t fillPattern { 0 };
+
+        MemoryTransferCallback callback { nullptr };
+        void *context { nullptr };
+        volatile bool busy { false };
+};
+
+
+#endif // __MEMORYTRANSFER_H__
@@ -0,0 +1,193 @@
+#ifndef __ALTERNATEFUNCTIONMAP_H__
+#define __ALTERNATEFUNCTIONMAP_H__
+
+/**
+ * @file AlternateFunctionMap.hh
+ * @brief Alternate function routing of the STM32F411 (datasheet DS10314, table 9), as a constexpr table.
+ * A peripheral signal is attached to a pin by name and the AF index is looked up by the compiler, so routing a
+ * signal to a pin that can not carry it does not build, and the configuration is a single AFR[0]/AFR[1] field write.
+ */
+
+#include <IOPinTypes.hh>
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief Peripheral signals that can be routed to a GPIO pin
+ */
+enum class GpioSignal : uint8_t
+{
+    // AF0: system
+    mco1, mco2, swdio, swclk, swo,
+    // AF1: TIM1/TIM2
+    tim1Ch1, tim1Ch2, tim1Ch3, tim1Ch4,
+    tim2Ch1, tim2Ch2, tim2Ch3, tim2Ch4,
+    // AF2: TIM3/TIM4/TIM5
+    tim3Ch1, tim3Ch2, tim3Ch3, tim3Ch4,
+    tim4Ch1, tim4Ch2, tim4Ch3, tim4Ch4,
+    tim5Ch1, tim5Ch2, tim5Ch3, tim5Ch4,
+    // AF4/AF9: I2C1/I2C2/I2C3
+    i2c1Scl, i2c1Sda, i2c2Scl, i2c2Sda, i2c3Scl, i2c3Sda,
+    // AF5/AF6: SPI1/SPI2/SPI3
+    spi1Nss, spi1Sck, spi1Miso, spi1Mosi,
+    spi2Nss, spi2Sck, spi2Miso, spi2Mosi,
+    spi3Nss, spi3Sck, spi3Miso, spi3Mosi,
+    // AF7/AF8: USART1/USART2/USART6
+    usart1Tx, usart1Rx, usart2Tx, usart2Rx, usart6Tx, usart6Rx,
+    // AF10: USB OTG FS
+    otgFsDm, otgFsDp,
+};
+
+/**
+ * @brief One row of the alternate function table: signal routed to port/pin through alternateFunction
+ */
+struct AlternateFunctionEntry
+{
+    GpioPort port;
+    GpioPin pin;
+    GpioSignal signal;
+    uint8_t alternateFunction;
+};
+
+constexpr uint8_t invalidAlternateFunction { 0xFFU };
+
+constexpr std::array alternateFunctionTable
+{
+    // AF0
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_8, GpioSignal::mco1, 0 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_9, GpioSignal::mco2, 0 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_13, GpioSignal::swdio, 0 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_14, GpioSignal::swclk, 0 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::swo, 0 },
+    // AF1
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_8, GpioSignal::tim1Ch1, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_9, GpioSignal::tim1Ch2, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_10, GpioSignal::tim1Ch3, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_11, GpioSignal::tim1Ch4, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_0, GpioSignal::tim2Ch1, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_5, GpioSignal::tim2Ch1, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_15, GpioSignal::tim2Ch1, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_1, GpioSignal::tim2Ch2, 1 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::tim2Ch2, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_2, GpioSignal::tim2Ch3, 1 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_10, GpioSignal::tim2Ch3, 1 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_3, GpioSignal::tim2Ch4, 1 },
+    // AF2
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_6, GpioSignal::tim3Ch1, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_4, GpioSignal::tim3Ch1, 2 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_6, GpioSignal::tim3Ch1, 2 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_7, GpioSignal::tim3Ch2, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_5, GpioSignal::tim3Ch2, 2 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_7, GpioSignal::tim3Ch2, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_0, GpioSignal::tim3Ch3, 2 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_8, GpioSignal::tim3Ch3, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_1, GpioSignal::tim3Ch4, 2 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_9, GpioSignal::tim3Ch4, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_6, GpioSignal::tim4Ch1, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_7, GpioSignal::tim4Ch2, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_8, GpioSignal::tim4Ch3, 2 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_9, GpioSignal::tim4Ch4, 2 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_0, GpioSignal::tim5Ch1, 2 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_1, GpioSignal::tim5Ch2, 2 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_2, GpioSignal::tim5Ch3, 2 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_3, GpioSignal::tim5Ch4, 2 },
+    // AF4
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_6, GpioSignal::i2c1Scl, 4 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_8, GpioSignal::i2c1Scl, 4 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_7, GpioSignal::i2c1Sda, 4 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_9, GpioSignal::i2c1Sda, 4 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_10, GpioSignal::i2c2Scl, 4 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_8, GpioSignal::i2c3Scl, 4 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_9, GpioSignal::i2c3Sda, 4 },
+    // AF5
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_4, GpioSignal::spi1Nss, 5 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_15, GpioSignal::spi1Nss, 5 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_5, GpioSignal::spi1Sck, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::spi1Sck, 5 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_6, GpioSignal::spi1Miso, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_4, GpioSignal::spi1Miso, 5 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_7, GpioSignal::spi1Mosi, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_5, GpioSignal::spi1Mosi, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_9, GpioSignal::spi2Nss, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_12, GpioSignal::spi2Nss, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_10, GpioSignal::spi2Sck, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_13, GpioSignal::spi2Sck, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_14, GpioSignal::spi2Miso, 5 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_2, GpioSignal::spi2Miso, 5 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_15, GpioSignal::spi2Mosi, 5 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_3, GpioSignal::spi2Mosi, 5 },
+    // AF6
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_4, GpioSignal::spi3Nss, 6 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_15, GpioSignal::spi3Nss, 6 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::spi3Sck, 6 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_10, GpioSignal::spi3Sck, 6 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_4, GpioSignal::spi3Miso, 6 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_11, GpioSignal::spi3Miso, 6 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_5, GpioSignal::spi3Mosi, 6 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_12, GpioSignal::spi3Mosi, 6 },
+    // AF7
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_9, GpioSignal::usart1Tx, 7 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_15, GpioSignal::usart1Tx, 7 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_6, GpioSignal::usart1Tx, 7 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_10, GpioSignal::usart1Rx, 7 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::usart1Rx, 7 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_7, GpioSignal::usart1Rx, 7 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_2, GpioSignal::usart2Tx, 7 },
+    AlternateFunctionEntry{ GpioPort::D, GpioPin::_5, GpioSignal::usart2Tx, 7 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_3, GpioSignal::usart2Rx, 7 },
+    AlternateFunctionEntry{ GpioPort::D, GpioPin::_6, GpioSignal::usart2Rx, 7 },
+    // AF8
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_11, GpioSignal::usart6Tx, 8 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_6, GpioSignal::usart6Tx, 8 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_12, GpioSignal::usart6Rx, 8 },
+    AlternateFunctionEntry{ GpioPort::C, GpioPin::_7, GpioSignal::usart6Rx, 8 },
+    // AF9
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_3, GpioSignal::i2c2Sda, 9 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_9, GpioSignal::i2c2Sda, 9 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_4, GpioSignal::i2c3Sda, 9 },
+    AlternateFunctionEntry{ GpioPort::B, GpioPin::_8, GpioSignal::i2c3Sda, 9 },
+    // AF10
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_11, GpioSignal::otgFsDm, 10 },
+    AlternateFunctionEntry{ GpioPort::A, GpioPin::_12, GpioSignal::otgFsDp, 10 },
+};
+
+/**
+ * @brief AF index that routes signal to port/pin, or invalidAlternateFunction if the pin can not carry the signal
+ */
+constexpr uint8_t getAlternateFunction(const GpioPort& port, const GpioPin& pin, const GpioSignal& signal)
+{
+    for(const AlternateFunctionEntry& entry : alternateFunctionTable)
+    {
+        if(entry.port == port && entry.pin == pin && entry.signal == signal)
+            return entry.alternateFunction;
+    }
+    return invalidAlternateFunction;
+}
+
+constexpr bool isAlternateFunctionAvailable(const GpioPort& port, const GpioPin& pin, const GpioSignal& signal)
+{
+    return getAlternateFunction(port, pin, signal) != invalidAlternateFunction;
+}
+
+/** @brief A pin can only be listed once per signal, otherwise the table would be ambiguous */
+constexpr bool isAlternateFunctionTableConsistent()
+{
+    for(std::size_t i = 0; i < alternateFunctionTable.size(); ++i)
+    {
+        const AlternateFunctionEntry& entry = alternateFunctionTable[i];
+        if(entry.port == GpioPort::null || entry.pin == GpioPin::null || entry.alternateFunction > 15U)
+            return false;
+        for(std::size_t j = i + 1; j < alternateFunctionTable.size(); ++j)
+        {
+            const AlternateFunctionEntry& other = alternateFunctionTable[j];
+            if(entry.port == other.port && entry.pin == other.pin && entry.signal == other.signal)
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isAlternateFunctionTableConsistent(), "[alternate function table has an invalid or duplicated entry]");
+
+
+#endif // __ALTERNATEFUNCTIONMAP_H__
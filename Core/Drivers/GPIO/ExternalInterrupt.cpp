@@ -0,0 +1,38 @@
+#include <ExternalInterrupt.hh>
+
+// EXTI interrupt handlers. They override the weak aliases of startup_stm32f411retx.s
+
+extern "C" void EXTI0_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLine<0>();
+}
+
+extern "C" void EXTI1_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLine<1>();
+}
+
+extern "C" void EXTI2_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLine<2>();
+}
+
+extern "C" void EXTI3_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLine<3>();
+}
+
+extern "C" void EXTI4_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLine<4>();
+}
+
+extern "C" void EXTI9_5_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLines(ExternalInterrupt<>::lines9to5);
+}
+
+extern "C" void EXTI15_10_IRQHandler()
+{
+    ExternalInterrupt<>::dispatchLines(ExternalInterrupt<>::lines15to10);
+}
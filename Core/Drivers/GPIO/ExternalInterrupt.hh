@@ -0,0 +1,185 @@
+#ifndef __EXTERNALINTERRUPT_H__
+#define __EXTERNALINTERRUPT_H__
+
+/**
+ * @file ExternalInterrupt.hh
+ * @brief GPIO interrupts through the EXTI controller.
+ * Lines 0..15 are routed to a port through SYSCFG EXTICR and armed through EXTI IMR/RTSR/FTSR. Callbacks live in
+ * a flat, statically sized table indexed by line, so dispatch from the EXTI IRQ handlers is a table access and an
+ * indirect call, with no allocation and no search. Unused entries point to a no-op so dispatch has no null check.
+ * The EXTI hardware is edge sensitive only: level-triggered inputs have to re-check the pin from the callback.
+ */
+
+#include <IOPinTypes.hh>
+#include <PeripheralBaseTypes.hh>
+#include <PeripheralClockHandle.hh>
+#include <algorithm>
+#include <array>
+#include <bit>
+
+/** @brief Edges that trigger the interrupt, as the RTSR (bit 0) and FTSR (bit 1) selection */
+enum class GpioTrigger : uint8_t { rising = 0x1, falling = 0x2, both = 0x3 };
+
+using GpioInterruptCallback = void(*)(void* context);
+
+struct GpioInterruptHandler
+{
+    GpioInterruptCallback callback;
+    void* context;
+};
+
+/**
+ * @brief EXTI line management and dispatch
+ *
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+class ExternalInterrupt
+{
+    public:
+
+        static constexpr std::size_t numberOfLines { 16 };
+        static constexpr uint32_t lines9to5 { 0x000003E0U };
+        static constexpr uint32_t lines15to10 { 0x0000FC00U };
+
+        static bool enable(const GpioPort& port, const GpioPin& pin, const GpioTrigger& trigger, const GpioInterruptCallback& callback, void* context = nullptr);
+        static void disable(const GpioPort& port, const GpioPin& pin);
+        static bool isEnabled(const GpioPin& pin);
+
+        // Dispatch from the IRQ handlers
+        template<uint32_t Line>
+        static void dispatchLine();
+        static void dispatchLines(const uint32_t& lines);
+
+    private:
+
+        static void ignoreInterrupt(void* context) { }
+        static constexpr IRQn_Type getIRQn(const uint32_t& line);
+
+        static auto* getEXTI() { return Registers<EXTI_TypeDef, EXTI_BASE>::get(); }
+        static auto* getSYSCFG() { return Registers<SYSCFG_TypeDef, SYSCFG_BASE>::get(); }
+        static auto* getNVIC() { return Registers<NVIC_Type, NVIC_BASE>::get(); }
+
+        static inline constinit std::array<GpioInterruptHandler, numberOfLines> handlers { []() {
+            std::array<GpioInterruptHandler, numberOfLines> table {};
+            for(GpioInterruptHandler& handler : table)
+                handler = GpioInterruptHandler{ &ignoreInterrupt, nullptr };
+            return table;
+        }() };
+        // SYSCFG holds the EXTICR routing: its clock is held while a line is in use
+        static inline constinit PeripheralClockHandle<Registers> syscfgClock {};
+        static inline constinit std::array<GpioPort, numberOfLines> owners { []() {
+            std::array<GpioPort, numberOfLines> table {};
+            table.fill(GpioPort::null);
+            return table;
+        }() };
+};
+
+template<template<typename, uint32_t> class Registers>
+constexpr IRQn_Type ExternalInterrupt<Registers>::getIRQn(const uint32_t& line)
+{
+    if(line <= 4U)
+        return static_cast<IRQn_Type>(EXTI0_IRQn + static_cast<int>(line));
+    if(line <= 9U)
+        return EXTI9_5_IRQn;
+    return EXTI15_10_IRQn;
+}
+
+/**
+ * @brief Routes the line of pin to port, registers the callback and arms the line.
+ * @return false if the line is already used by a pin of another port (EXTI lines are shared by the pins with the same number)
+ */
+template<template<typename, uint32_t> class Registers>
+inline bool ExternalInterrupt<Registers>::enable(const GpioPort& port, const GpioPin& pin, const GpioTrigger& trigger, const GpioInterruptCallback& callback, void* context)
+{
+    if(port == GpioPort::null || pin == GpioPin::null || callback == nullptr)
+        return false;
+
+    const uint32_t line = static_cast<uint32_t>(pin);
+    if(owners[line] != GpioPort::null && owners[line] != port)
+        return false;
+
+    const uint32_t lineMask = 0x1U << line;
+    auto* exti = getEXTI();
+
+    // Mask the line while it is being reconfigured
+    exti->IMR = static_cast<uint32_t>(exti->IMR) & ~lineMask;
+    handlers[line] = GpioInterruptHandler{ callback, context };
+    owners[line] = port;
+
+    if(!syscfgClock.isValid())
+        syscfgClock = PeripheralClockHandle<Registers>(AvailablePeripherals::_SYSCGF);
+
+    auto& exticr = getSYSCFG()->EXTICR[line / 4U];
+    const uint32_t exticrShift = (line % 4U) * 4U;
+    exticr = (static_cast<uint32_t>(exticr) & ~(0xFU << exticrShift)) | (static_cast<uint32_t>(port) << exticrShift);
+
+    const uint32_t rising = (static_cast<uint32_t>(trigger) & 0x1U) << line;
+    const uint32_t falling = ((static_cast<uint32_t>(trigger) >> 1U) & 0x1U) << line;
+    exti->RTSR = (static_cast<uint32_t>(exti->RTSR) & ~lineMask) | rising;
+    exti->FTSR = (static_cast<uint32_t>(exti->FTSR) & ~lineMask) | falling;
+    exti->PR = lineMask;
+    exti->IMR = static_cast<uint32_t>(exti->IMR) | lineMask;
+
+    const IRQn_Type irq = getIRQn(line);
+    getNVIC()->ISER[static_cast<uint32_t>(irq) >> 5U] = 0x1U << (static_cast<uint32_t>(irq) & 0x1FU);
+    return true;
+}
+
+/**
+ * @brief Masks the line and releases it, with the SYSCFG clock once no line is left. The NVIC entry is left enabled
+ * since it may be shared with other lines
+ */
+template<template<typename, uint32_t> class Registers>
+inline void ExternalInterrupt<Registers>::disable(const GpioPort& port, const GpioPin& pin)
+{
+    if(pin == GpioPin::null)
+        return;
+    const uint32_t line = static_cast<uint32_t>(pin);
+    if(owners[line] != port)
+        return;
+
+    auto* exti = getEXTI();
+    exti->IMR = static_cast<uint32_t>(exti->IMR) & ~(0x1U << line);
+    handlers[line] = GpioInterruptHandler{ &ignoreInterrupt, nullptr };
+    owners[line] = GpioPort::null;
+    if(std::ranges::all_of(owners, [](const GpioPort& owner) { return owner == GpioPort::null; }))
+        syscfgClock.release();
+}
+
+template<template<typename, uint32_t> class Registers>
+inline bool ExternalInterrupt<Registers>::isEnabled(const GpioPin& pin)
+{
+    if(pin == GpioPin::null)
+        return false;
+    return owners[static_cast<uint32_t>(pin)] != GpioPort::null;
+}
+
+/** @brief Dispatch for the lines with a dedicated IRQ (EXTI0..EXTI4): one PR store and one indirect call */
+template<template<typename, uint32_t> class Registers>
+template<uint32_t Line>
+inline void ExternalInterrupt<Registers>::dispatchLine()
+{
+    static_assert(Line < numberOfLines, "[EXTI line out of range]");
+    getEXTI()->PR = 0x1U << Line;
+    const GpioInterruptHandler& handler = handlers[Line];
+    handler.callback(handler.context);
+}
+
+/** @brief Dispatch for the shared IRQs (EXTI9_5, EXTI15_10): one PR load, one PR store and one indirect call per pending line */
+template<template<typename, uint32_t> class Registers>
+inline void ExternalInterrupt<Registers>::dispatchLines(const uint32_t& lines)
+{
+    auto* exti = getEXTI();
+    uint32_t pending = static_cast<uint32_t>(exti->PR) & lines;
+    exti->PR = pending;
+    while(pending)
+    {
+        const GpioInterruptHandler& handler = handlers[std::countr_zero(pending)];
+        handler.callback(handler.context);
+        pending &= pending - 1U;
+    }
+}
+
+
+#endif // __EXTERNALINTERRUPT_H__
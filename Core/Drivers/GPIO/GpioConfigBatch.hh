@@ -0,0 +1,201 @@
+#ifndef __GPIOCONFIGBATCH_H__
+#define __GPIOCONFIGBATCH_H__
+
+/**
+ * @file GpioConfigBatch.hh
+ * @brief Staged GPIO configuration. Settings of any number of pins are accumulated in RAM, per port and per
+ * register, and then committed with at most one read-modify-write per touched register. A register whose
+ * every field is staged is written with a single store, without reading it first.
+ */
+
+#include <StaticPin.hh>
+#include <array>
+#include <utility>
+
+/**
+ * @brief Settings that can be staged for a pin, as flags of a QueuedSettings_t
+ */
+enum class GpioSetting : QueuedSettings_t
+{
+    mode = 0x01,
+    pupd = 0x02,
+    outputType = 0x04,
+    outputSpeed = 0x08,
+    alternateFunction = 0x10,
+};
+
+/**
+ * @brief Pending field mask and value of every configuration register of one port
+ */
+struct GpioPortStagedSettings
+{
+    uint32_t modeMask { 0 };
+    uint32_t modeValue { 0 };
+    uint32_t outputTypeMask { 0 };
+    uint32_t outputTypeValue { 0 };
+    uint32_t outputSpeedMask { 0 };
+    uint32_t outputSpeedValue { 0 };
+    uint32_t pupdMask { 0 };
+    uint32_t pupdValue { 0 };
+    uint32_t alternateFunctionMask[2] { 0, 0 };
+    uint32_t alternateFunctionValue[2] { 0, 0 };
+
+    constexpr bool isEmpty() const
+    {
+        return !(modeMask | outputTypeMask | outputSpeedMask | pupdMask | alternateFunctionMask[0] | alternateFunctionMask[1]);
+    }
+};
+
+class GpioConfigBatch
+{
+    public:
+
+        constexpr void stageMode(const GpioPort& port, const GpioPin& pin, const GpioMode& mode);
+        constexpr void stagePUPD(const GpioPort& port, const GpioPin& pin, const GpioPUPD& pupd);
+        constexpr void stageOutputType(const GpioPort& port, const GpioPin& pin, const GpioOutputType& outputType);
+        constexpr void stageOutputSpeed(const GpioPort& port, const GpioPin& pin, const GpioOutputSpeed& outputSpeed);
+        constexpr void stageAlternateFunction(const GpioPort& port, const GpioPin& pin, const uint8_t& alternateFunction);
+
+        constexpr bool isEmpty() const;
+        constexpr const GpioPortStagedSettings& getStagedSettings(const GpioPort& port) const;
+        constexpr void clear();
+
+        /** @brief Writes every staged setting to the hardware. The batch is left untouched so a constant batch can be committed */
+        template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+        void commit() const;
+
+    private:
+
+        static constexpr bool isValid(const GpioPort& port, const GpioPin& pin);
+        static constexpr void stageField(uint32_t& mask, uint32_t& value, const uint32_t& fieldWidth, const uint32_t& fieldIndex, const uint32_t& fieldValue);
+
+        template<template<typename, uint32_t> class Registers, GpioPort Port>
+        void commitPort() const;
+
+        template<template<typename, uint32_t> class Registers, GpioPort... Ports>
+        void commitPorts() const;
+
+        static void commitRegister(auto& reg, const uint32_t& mask, const uint32_t& value, const uint32_t& implementedBits = 0xFFFFFFFFU);
+
+        std::array<GpioPortStagedSettings, AVAILABLE_PORTS> ports {};
+};
+
+constexpr bool GpioConfigBatch::isValid(const GpioPort& port, const GpioPin& pin)
+{
+    return port != GpioPort::null && pin != GpioPin::null;
+}
+
+/** @brief Stages a field of fieldWidth bits at position fieldIndex. A later stage of the same field replaces the former one */
+constexpr void GpioConfigBatch::stageField(uint32_t& mask, uint32_t& value, const uint32_t& fieldWidth, const uint32_t& fieldIndex, const uint32_t& fieldValue)
+{
+    const uint32_t fieldMask = ((0x1U << fieldWidth) - 1U) << (fieldIndex * fieldWidth);
+    mask |= fieldMask;
+    value = (value & ~fieldMask) | ((fieldValue << (fieldIndex * fieldWidth)) & fieldMask);
+}
+
+constexpr void GpioConfigBatch::stageMode(const GpioPort& port, const GpioPin& pin, const GpioMode& mode)
+{
+    if(!isValid(port, pin) || mode == GpioMode::null)
+        return;
+    GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(port)];
+    stageField(settings.modeMask, settings.modeValue, 2U, static_cast<uint32_t>(pin), static_cast<uint32_t>(mode));
+}
+
+constexpr void GpioConfigBatch::stagePUPD(const GpioPort& port, const GpioPin& pin, const GpioPUPD& pupd)
+{
+    if(!isValid(port, pin))
+        return;
+    GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(port)];
+    stageField(settings.pupdMask, settings.pupdValue, 2U, static_cast<uint32_t>(pin), static_cast<uint32_t>(pupd));
+}
+
+constexpr void GpioConfigBatch::stageOutputType(const GpioPort& port, const GpioPin& pin, const GpioOutputType& outputType)
+{
+    if(!isValid(port, pin))
+        return;
+    GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(port)];
+    stageField(settings.outputTypeMask, settings.outputTypeValue, 1U, static_cast<uint32_t>(pin), static_cast<uint32_t>(outputType));
+}
+
+constexpr void GpioConfigBatch::stageOutputSpeed(const GpioPort& port, const GpioPin& pin, const GpioOutputSpeed& outputSpeed)
+{
+    if(!isValid(port, pin))
+        return;
+    GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(port)];
+    stageField(settings.outputSpeedMask, settings.outputSpeedValue, 2U, static_cast<uint32_t>(pin), static_cast<uint32_t>(outputSpeed));
+}
+
+/** @brief Stages the AF index of the pin in AFR[0] (pins 0..7) or AFR[1] (pins 8..15) */
+constexpr void GpioConfigBatch::stageAlternateFunction(const GpioPort& port, const GpioPin& pin, const uint8_t& alternateFunction)
+{
+    if(!isValid(port, pin))
+        return;
+    GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(port)];
+    const uint32_t pinNumber = static_cast<uint32_t>(pin);
+    stageField(settings.alternateFunctionMask[pinNumber / 8U], settings.alternateFunctionValue[pinNumber / 8U], 4U, pinNumber % 8U, alternateFunction);
+}
+
+constexpr bool GpioConfigBatch::isEmpty() const
+{
+    for(const GpioPortStagedSettings& settings : ports)
+    {
+        if(!settings.isEmpty())
+            return false;
+    }
+    return true;
+}
+
+constexpr const GpioPortStagedSettings& GpioConfigBatch::getStagedSettings(const GpioPort& port) const
+{
+    return ports[static_cast<std::size_t>(port)];
+}
+
+constexpr void GpioConfigBatch::clear()
+{
+    ports = {};
+}
+
+template<template<typename, uint32_t> class Registers>
+inline void GpioConfigBatch::commit() const
+{
+    commitPorts<Registers, GpioPort::A, GpioPort::B, GpioPort::C, GpioPort::D, GpioPort::E, GpioPort::H>();
+}
+
+template<template<typename, uint32_t> class Registers, GpioPort... Ports>
+inline void GpioConfigBatch::commitPorts() const
+{
+    (commitPort<Registers, Ports>(), ...);
+}
+
+/** @brief Commits the staged settings of one port. Registers are written in the order AFR, OTYPER, OSPEEDR, PUPDR, MODER so a pin is only switched to its new mode once the rest of its configuration is in place */
+template<template<typename, uint32_t> class Registers, GpioPort Port>
+inline void GpioConfigBatch::commitPort() const
+{
+    const GpioPortStagedSettings& settings = ports[static_cast<std::size_t>(Port)];
+    if(settings.isEmpty())
+        return;
+
+    auto* regs = Registers<GPIO_TypeDef, getGpioPortBaseAddress(Port)>::get();
+    commitRegister(regs->AFR[0], settings.alternateFunctionMask[0], settings.alternateFunctionValue[0]);
+    commitRegister(regs->AFR[1], settings.alternateFunctionMask[1], settings.alternateFunctionValue[1]);
+    commitRegister(regs->OTYPER, settings.outputTypeMask, settings.outputTypeValue, 0x0000FFFFU);
+    commitRegister(regs->OSPEEDR, settings.outputSpeedMask, settings.outputSpeedValue);
+    commitRegister(regs->PUPDR, settings.pupdMask, settings.pupdValue);
+    commitRegister(regs->MODER, settings.modeMask, settings.modeValue);
+}
+
+/** @brief Nothing staged: no access. Every implemented field staged: one store. Otherwise: one read-modify-write */
+inline void GpioConfigBatch::commitRegister(auto& reg, const uint32_t& mask, const uint32_t& value, const uint32_t& implementedBits)
+{
+    if(!mask)
+        return;
+    if(mask == implementedBits)
+    {
+        reg = value;
+        return;
+    }
+    reg = (static_cast<uint32_t>(reg) & ~mask) | value;
+}
+
+
+#endif // __GPIOCONFIGBATCH_H__
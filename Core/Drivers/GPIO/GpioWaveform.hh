@@ -0,0 +1,212 @@
+#ifndef __GPIOWAVEFORM_H__
+#define __GPIOWAVEFORM_H__
+
+/**
+ * @file GpioWaveform.hh
+ * @brief Hardware-timed GPIO waveforms. A buffer of precomputed BSRR words is streamed to the BSRR register of a
+ * port by DMA2, one word per TIM1 update event (DMA2 Stream5 Channel6, RM0383 table 28). Once started the CPU is not
+ * involved: every pin of the group changes on the same bus cycle and the sample period is as stable as the timer clock.
+ *
+ * The stream is claimed from DMAStream with the TIM1_UP request from start to stop, so it is not handed to another
+ * driver (memory to memory, USART1_RX, SPI1_TX, SPI5_RX) meanwhile. DMAStream always goes through the memory mapped
+ * registers: Registers only resolves the port and TIM1. While the waveform plays, TIM1 and the port are kept clocked
+ * in sleep by a sleepOnly power constraint, next to the one of the stream.
+ */
+
+#include <PinGroup.hh>
+#include <PeripheralClockHandle.hh>
+#include <ClockFrequencies.hh>
+#include <DMA.hh>
+#include <PowerConstraints.hh>
+#include <array>
+#include <cstddef>
+
+enum class GpioWaveformStatusCodes
+{
+    Ready,
+    invalidBuffer,
+    invalidTiming,
+    // DMA2 Stream5 is held by another driver, or did not stop
+    streamBusy,
+};
+
+/**
+ * @brief Waveform player for a group of pins of one port
+ *
+ * @tparam Port GPIO port driven by the waveform
+ * @tparam Mask Pins driven by the waveform, one bit per pin as in IOPin's allocatedIOPins. The other pins of the port are never touched
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers = PeripheralRegisters>
+class GpioWaveform
+{
+    public:
+
+        using PortGroupType = PortGroup<Port, Mask, Registers>;
+
+        static constexpr uint32_t maxSamples { 0xFFFFU };
+        static constexpr uint32_t bsrrAddress { getGpioPortBaseAddress(Port) + offsetof(GPIO_TypeDef, BSRR) };
+
+        // Buffer construction: bit n of a sample is the level of pin n of the port
+        static constexpr uint32_t makeWord(const AllocatedPin_t& sample);
+        template<std::size_t N>
+        static constexpr std::array<uint32_t, N> makeWaveform(const std::array<AllocatedPin_t, N>& samples);
+
+        static void configurePins();
+
+        /**
+         * @brief Plays words, one per (prescaler + 1) * (autoReload + 1) timer clock cycles. The buffer has to stay
+         * valid while the waveform plays; with loop set it is replayed until stop()
+         */
+        static GpioWaveformStatusCodes start(const uint32_t* words, const uint16_t& length, const uint16_t& prescaler, const uint16_t& autoReload, const bool& loop = false);
+        /** @brief Plays words at SampleRate samples per second. PSC/ARR are computed by the compiler from the TIM1 clock of Clocks */
+        template<ClockFrequencies Clocks, uint32_t SampleRate>
+        static GpioWaveformStatusCodes start(const uint32_t* words, const uint16_t& length, const bool& loop = false);
+        static void stop();
+        static bool isRunning();
+        static uint16_t getRemainingSamples();
+
+    private:
+
+        static void enableClocks();
+
+        static auto* getPort() { return Registers<GPIO_TypeDef, getGpioPortBaseAddress(Port)>::get(); }
+        static auto* getTimer() { return Registers<TIM_TypeDef, TIM1_BASE>::get(); }
+
+        // The stream, with the DMA2 clock, and TIM1 are held from start to stop. The port clock is kept once taken:
+        // the pins hold the last level played after stop
+        static inline DMAStream stream { DMARequest::TIM1_UP };
+        static constinit inline PeripheralClockHandle<Registers> portClock {};
+        static constinit inline PeripheralClockHandle<Registers> timerClock {};
+        static constinit inline uint8_t powerConstraint { PowerConstraints::invalidConstraint };
+};
+
+/** @brief BSRR word that drives the pins of the group to sample: set bits in the low half, reset bits in the high half */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+constexpr uint32_t GpioWaveform<Port, Mask, Registers>::makeWord(const AllocatedPin_t& sample)
+{
+    const uint32_t high = static_cast<uint32_t>(sample) & Mask;
+    return high | ((high ^ Mask) << 16U);
+}
+
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+template<std::size_t N>
+constexpr std::array<uint32_t, N> GpioWaveform<Port, Mask, Registers>::makeWaveform(const std::array<AllocatedPin_t, N>& samples)
+{
+    std::array<uint32_t, N> words {};
+    for(std::size_t i = 0; i < N; ++i)
+        words[i] = makeWord(samples[i]);
+    return words;
+}
+
+/** @brief Switches every pin of the group to output with a single MODER read-modify-write, the port clock taken first */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void GpioWaveform<Port, Mask, Registers>::configurePins()
+{
+    if(!portClock.isValid())
+        portClock = PeripheralClockHandle<Registers>(*getGpioPortPeripheral(static_cast<uint32_t>(Port)));
+    PortGroupType::setMode(GpioMode::output);
+}
+
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline GpioWaveformStatusCodes GpioWaveform<Port, Mask, Registers>::start(const uint32_t* words, const uint16_t& length, const uint16_t& prescaler, const uint16_t& autoReload, const bool& loop)
+{
+    if(words == nullptr || length == 0)
+        return GpioWaveformStatusCodes::invalidBuffer;
+    // The counter does not run with a null auto-reload value
+    if(autoReload == 0)
+        return GpioWaveformStatusCodes::invalidTiming;
+
+    stop();
+    if(stream.isBusy() || stream.init() != DMAStatusCodes::Ready)
+        return GpioWaveformStatusCodes::streamBusy;
+    enableClocks();
+
+    // No event is subscribed: the stream runs without its interrupt
+    const DMATransfer transfer
+    {
+        .direction = DMADirection::memoryToPeripheral,
+        .peripheral = &getPort()->BSRR,
+        .memory = words,
+        .length = length,
+        .peripheralSize = DMADataSize::word,
+        .memorySize = DMADataSize::word,
+        .circular = loop,
+        .priority = DMAPriority::veryHigh,
+        .events = 0U,
+    };
+    if(stream.start(transfer) != DMAStatusCodes::Ready)
+        return GpioWaveformStatusCodes::streamBusy;
+
+    // The update generated to load the prescaler happens before UDE is set, so it does not consume a sample
+    auto* timer = getTimer();
+    timer->PSC = prescaler;
+    timer->ARR = autoReload;
+    timer->CNT = 0;
+    timer->EGR = TIM_EGR_UG;
+    timer->SR = 0;
+    timer->DIER = TIM_DIER_UDE;
+    timer->CR1 = TIM_CR1_ARPE | TIM_CR1_CEN;
+    powerConstraint = PowerConstraints::addWakeLatencyConstraint(PowerConstraints::sleepOnly,
+        getPeripheralClockMask(AvailablePeripherals::_TIM1) | getPeripheralClockMask(*getGpioPortPeripheral(static_cast<uint32_t>(Port))));
+    return GpioWaveformStatusCodes::Ready;
+}
+
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+template<ClockFrequencies Clocks, uint32_t SampleRate>
+inline GpioWaveformStatusCodes GpioWaveform<Port, Mask, Registers>::start(const uint32_t* words, const uint16_t& length, const bool& loop)
+{
+    constexpr TimerTiming timing { getTimerTiming(Clocks.getTimerFrequency(PeripheralBridges::APB2), SampleRate) };
+    static_assert(timing.isValid, "[the sample rate can not be produced exactly from the TIM1 clock]");
+    return start(words, length, timing.prescaler, static_cast<uint16_t>(timing.autoReload), loop);
+}
+
+/**
+ * @brief Stops the timer and the stream, and gives the stream and TIM1 back. The pins keep the level of the last word
+ * played
+ */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void GpioWaveform<Port, Mask, Registers>::stop()
+{
+    if(!timerClock.isValid())
+        return;
+    auto* timer = getTimer();
+    timer->CR1 = static_cast<uint32_t>(timer->CR1) & ~TIM_CR1_CEN;
+    timer->DIER = static_cast<uint32_t>(timer->DIER) & ~TIM_DIER_UDE;
+    PowerConstraints::removeWakeLatencyConstraint(powerConstraint);
+    powerConstraint = PowerConstraints::invalidConstraint;
+    if(stream.stop())
+    {
+        stream.release();
+        timerClock.release();
+    }
+}
+
+/** @brief True until the last word of a one-shot waveform has been transferred; always true for a looping one until stop() */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline bool GpioWaveform<Port, Mask, Registers>::isRunning()
+{
+    return stream.isBusy();
+}
+
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline uint16_t GpioWaveform<Port, Mask, Registers>::getRemainingSamples()
+{
+    return stream.getRemaining();
+}
+
+/**
+ * @brief A user of the clocks of TIM1 and the port, so they are not gated off under the waveform by the last driver
+ * handle of one of them. The stream holds the DMA2 clock
+ */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void GpioWaveform<Port, Mask, Registers>::enableClocks()
+{
+    if(!portClock.isValid())
+        portClock = PeripheralClockHandle<Registers>(*getGpioPortPeripheral(static_cast<uint32_t>(Port)));
+    if(!timerClock.isValid())
+        timerClock = PeripheralClockHandle<Registers>(AvailablePeripherals::_TIM1);
+}
+
+
+#endif // __GPIOWAVEFORM_H__
@@ -1,16 +1,13 @@
 #include <IOPin.hh>
 
 
-#ifdef COMPILE
+AllocatedPin_t IOPin::allocatedIOPins[AVAILABLE_PORTS]{};
+GpioConfigBatch IOPin::stagedConfiguration{};
+bool IOPin::isStagingConfiguration{false};
 
 IOPin::IOPin() 
-    : IOPinParent(IOPinFunctionsContainer{&IOPin::configPort, &IOPin::configPin, &IOPin::configMode, &IOPin::configState})
+    : IOPinParent(GpioPort::null, GpioPin::null, GpioMode::null, GpioState::null)
 {
-    //setConfigFunctionsExecutionOrder(IOPinFunctionsExecutionOrder{IOPinProperties::mode, IOPinProperties::pin, IOPinProperties::port});
-    //setAllParametersValue(GpioPort::A, GpioPin::null, GpioMode::alternateFunction, GpioState::null);
-    std::size_t a = this->mandatoryParameter;
-    a = a / 32;
-
 }
 
 IOPin::IOPin(const IOPin &other) : IOPin()
@@ -46,56 +43,79 @@ IOPin& IOPin::operator=(IOPin &&other)
 
 IOPin::~IOPin()
 {
-    
+    disableInterrupt();
+    deAllocatePin();
 }
 
 IOPinStatusCodes IOPin::setPort(const GpioPort &port)
 { 
-    return IOPinStatusCodes::Reset;
+    this->template setParameterValue<IOPinProperties::port>(port);
+    return configPort(port, *this);
 }
 IOPinStatusCodes IOPin::setPin(const GpioPin &pin)
 { 
-    return IOPinStatusCodes::Reset;
+    this->template setParameterValue<IOPinProperties::pin>(pin);
+    return configPin(pin, *this);
 }
 IOPinStatusCodes IOPin::setMode(const GpioMode &mode)
 { 
-    return IOPinStatusCodes::Reset;
+    this->template setParameterValue<IOPinProperties::mode>(mode);
+    queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::mode);
+    return initQueuedSettings();
 }
 IOPinStatusCodes IOPin::setPUPD(const GpioPUPD &pupd)
 { 
-    return IOPinStatusCodes::Reset;
+    queuedPUPD = pupd;
+    queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::pupd);
+    return initQueuedSettings();
 }
 IOPinStatusCodes IOPin::setOutputType(const GpioOutputType &outputType)
 { 
-    return IOPinStatusCodes::Reset;
+    queuedOutputType = outputType;
+    queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::outputType);
+    return initQueuedSettings();
 }
 IOPinStatusCodes IOPin::setOutputSpeed(const GpioOutputSpeed &outputSpeed)
 { 
-    return IOPinStatusCodes::Reset;
+    queuedOutputSpeed = outputSpeed;
+    queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::outputSpeed);
+    return initQueuedSettings();
+}
+IOPinStatusCodes IOPin::setAlternateFunction(const GpioSignal &signal)
+{
+    if(!isPortSet() || !isPinSet())
+        return IOPinStatusCodes::notReadyNotReset;
+    const uint8_t alternateFunction = getAlternateFunction(this->template getParameterValue<IOPinProperties::port>(), this->template getParameterValue<IOPinProperties::pin>(), signal);
+    if(alternateFunction == invalidAlternateFunction)
+        return IOPinStatusCodes::alternateFunctionNotAvailable;
+    queuedAlternateFunction = alternateFunction;
+    this->template setParameterValue<IOPinProperties::mode>(GpioMode::alternateFunction);
+    queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::alternateFunction) | static_cast<QueuedSettings_t>(GpioSetting::mode);
+    return initQueuedSettings();
 }
 IOPinStatusCodes IOPin::setInputMode()
 { 
-    return IOPinStatusCodes::Reset;
+    return setMode(GpioMode::input);
 }
 IOPinStatusCodes IOPin::setOutputMode()
 { 
-    return IOPinStatusCodes::Reset;
+    return setMode(GpioMode::output);
 }
 IOPinStatusCodes IOPin::setPullup()
 { 
-    return IOPinStatusCodes::Reset;
+    return setPUPD(GpioPUPD::pullUp);
 }
 IOPinStatusCodes IOPin::setPulldown()
 { 
-    return IOPinStatusCodes::Reset;
+    return setPUPD(GpioPUPD::pullDown);
 }
 IOPinStatusCodes IOPin::setPullPushOutputType()
 { 
-    return IOPinStatusCodes::Reset;
+    return setOutputType(GpioOutputType::pushPull);
 }
 IOPinStatusCodes IOPin::setOpenDrainOutputType()
 { 
-    return IOPinStatusCodes::Reset;
+    return setOutputType(GpioOutputType::openDrain);
 }
 bool IOPin::read()
 {
@@ -117,64 +137,210 @@ bool IOPin::isReady()
 {
     return true;
 }
+IOPinStatusCodes IOPin::enableInterrupt(const GpioTrigger &trigger, const GpioInterruptCallback &callback, void *context)
+{
+    // Only on the pin this IOPin holds: the line follows allocatedPort/allocatedPin, not the parameters
+    if(!isLocated())
+        return IOPinStatusCodes::notReadyNotReset;
+    if(!ExternalInterrupt<>::enable(allocatedPort, allocatedPin, trigger, callback, context))
+        return IOPinStatusCodes::interruptLineInUse;
+    interruptEnabled = true;
+    return IOPinStatusCodes::Ready;
+}
+/** @brief Masks and releases the line armed by enableInterrupt. Also run before the pin moves and on destruction */
+void IOPin::disableInterrupt()
+{
+    if(!interruptEnabled)
+        return;
+    ExternalInterrupt<>::disable(allocatedPort, allocatedPin);
+    interruptEnabled = false;
+}
 bool IOPin::isAllocated(const GpioPort &port, const GpioPin &pin)
 {
-    return true;
+    if(port == GpioPort::null || pin == GpioPin::null)
+        return false;
+    return allocatedIOPins[static_cast<uintCast_t>(port)] & static_cast<AllocatedPin_t>(0x1U << static_cast<uintCast_t>(pin));
 }
 bool IOPin::isAllocated(const GPIO_TypeDef *port, const GpioPin &pin)
 {
-    return true;
+    return isAllocated(getPortFromGPIOStruct(port), pin);
 }
 
 
 bool IOPin::isPinSet()
 {
-    
+    return this->template getParameterValue<IOPinProperties::pin>() != GpioPin::null;
 }
 
 bool IOPin::isPortSet()
 {
-    
+    return this->template getParameterValue<IOPinProperties::port>() != GpioPort::null;
+}
+
+/** @brief True once the port and pin set are the ones this pin holds: a pin refused by checkLocation is never written */
+bool IOPin::isLocated()
+{
+    return allocatedPort != GpioPort::null && allocatedPort == this->template getParameterValue<IOPinProperties::port>()
+        && allocatedPin == this->template getParameterValue<IOPinProperties::pin>();
 }
 
 bool IOPin::isReallocating(const GpioPin &pin)
 {
-    
+    return isPinSet() && pin != this->template getParameterValue<IOPinProperties::pin>();
 }
 
 bool IOPin::isReallocating(const GpioPort &port)
 {
-    
+    return isPortSet() && port != this->template getParameterValue<IOPinProperties::port>();
 }
 
 GPIO_TypeDef* IOPin::getGPIOPtrInstance(const GpioPort &port)
 {
-    
+    if(port == GpioPort::null)
+        return nullptr;
+    return getPeripheralInstance<GPIO_TypeDef>(getGpioPortBaseAddress(port));
 }
 
 GpioPort IOPin::getPortFromGPIOStruct(const GPIO_TypeDef* gpio)
 {
-    
+    for(const GpioPort port : { GpioPort::A, GpioPort::B, GpioPort::C, GpioPort::D, GpioPort::E, GpioPort::H })
+    {
+        if(gpio == getPeripheralInstance<GPIO_TypeDef>(getGpioPortBaseAddress(port)))
+            return port;
+    }
+    return GpioPort::null;
+}
+
+/** @brief Whether the port and pin set can be taken: Ready until both are known, or when this pin already holds them */
+IOPinStatusCodes IOPin::checkLocation()
+{
+    const GpioPort port = this->template getParameterValue<IOPinProperties::port>();
+    const GpioPin pin = this->template getParameterValue<IOPinProperties::pin>();
+    if(port == GpioPort::null || pin == GpioPin::null || (port == allocatedPort && pin == allocatedPin))
+        return IOPinStatusCodes::Ready;
+    if(isAllocated(port, pin))
+        return IOPinStatusCodes::alreadyAllocatedPin;
+    return IOPinStatusCodes::Ready;
 }
 
+/** @brief Frees the pin held, if any, and marks the port and pin set as used. checkLocation has accepted them */
 void IOPin::allocatePin()
 {
-    
+    const GpioPort port = this->template getParameterValue<IOPinProperties::port>();
+    const GpioPin pin = this->template getParameterValue<IOPinProperties::pin>();
+    if(port == GpioPort::null || pin == GpioPin::null || (port == allocatedPort && pin == allocatedPin))
+        return;
+    // The handler context is this pin and the line is the former pin's: neither survives the move
+    disableInterrupt();
+    deAllocatePin();
+    allocatedIOPins[static_cast<uintCast_t>(port)] |= static_cast<AllocatedPin_t>(0x1U << static_cast<uintCast_t>(pin));
+    allocatedPort = port;
+    allocatedPin = pin;
 }
 
 void IOPin::deAllocatePin()
 {
-    
+    if(allocatedPort == GpioPort::null || allocatedPin == GpioPin::null)
+        return;
+    allocatedIOPins[static_cast<uintCast_t>(allocatedPort)] &= static_cast<AllocatedPin_t>(~(0x1U << static_cast<uintCast_t>(allocatedPin)));
+    allocatedPort = GpioPort::null;
+    allocatedPin = GpioPin::null;
 }
 
+/** @brief Runs the config function of every parameter changed since the last init, then writes the settings they queued */
 IOPinStatusCodes IOPin::init()
 {
-    return IOPinStatusCodes::Reset;
+    if(!this->areMandatoryParametersSet())
+        return IOPinStatusCodes::notReadyNotReset;
+    for(const IOPinStatusCodes& status : IOPinParent::init())
+    {
+        if(status != IOPinStatusCodes::Ready)
+            return status;
+    }
+    return initQueuedSettings(true);
+}
+
+/**
+ * @brief Moves the queued settings of this pin to the staged configuration. Outside of a staged configuration
+ * they are committed right away, still with a single read-modify-write per register
+ */
+IOPinStatusCodes IOPin::initQueuedSettings(const bool &triggerError, const uint8_t &retries)
+{
+    if(!isLocated())
+    {
+        // Settings stay queued until the pin is known and taken
+        return triggerError ? IOPinStatusCodes::initQueuedSettingsFailed : IOPinStatusCodes::Reset;
+    }
+
+    stageQueuedSettings(stagedConfiguration);
+    if(!isStagingConfiguration)
+    {
+        stagedConfiguration.commit();
+        stagedConfiguration.clear();
+    }
+    return IOPinStatusCodes::Ready;
+}
+
+void IOPin::stageQueuedSettings(GpioConfigBatch &batch)
+{
+    const GpioPort port = this->template getParameterValue<IOPinProperties::port>();
+    const GpioPin pin = this->template getParameterValue<IOPinProperties::pin>();
+
+    if(queuedSettings & static_cast<QueuedSettings_t>(GpioSetting::mode))
+        batch.stageMode(port, pin, this->template getParameterValue<IOPinProperties::mode>());
+    if(queuedSettings & static_cast<QueuedSettings_t>(GpioSetting::pupd))
+        batch.stagePUPD(port, pin, queuedPUPD);
+    if(queuedSettings & static_cast<QueuedSettings_t>(GpioSetting::outputType))
+        batch.stageOutputType(port, pin, queuedOutputType);
+    if(queuedSettings & static_cast<QueuedSettings_t>(GpioSetting::outputSpeed))
+        batch.stageOutputSpeed(port, pin, queuedOutputSpeed);
+    if(queuedSettings & static_cast<QueuedSettings_t>(GpioSetting::alternateFunction))
+        batch.stageAlternateFunction(port, pin, queuedAlternateFunction);
+    appliedSettings |= queuedSettings;
+    appliedPort = port;
+    appliedPin = pin;
+    queuedSettings = 0;
+}
+
+/**
+ * @brief The pin moved to another port or pin number: every setting written to the former pin is queued again for
+ * the new one, mode and state run again on the next init, and the former pin goes back to input
+ */
+void IOPin::moveAppliedSettings()
+{
+    constexpr IOPinPeripheralBase::ParametersMaskType dependents { (0x1U << static_cast<uint32_t>(IOPinProperties::mode)) | (0x1U << static_cast<uint32_t>(IOPinProperties::state)) };
+    const GpioPort port = this->template getParameterValue<IOPinProperties::port>();
+    const GpioPin pin = this->template getParameterValue<IOPinProperties::pin>();
+    if(appliedPort == GpioPort::null || (appliedPort == port && appliedPin == pin))
+        return;
+
+    stagedConfiguration.stageMode(appliedPort, appliedPin, GpioMode::input);
+    if(!isStagingConfiguration)
+    {
+        stagedConfiguration.commit();
+        stagedConfiguration.clear();
+    }
+    queuedSettings |= appliedSettings;
+    this->setParametersDirty(dependents);
+    appliedPort = GpioPort::null;
+    appliedPin = GpioPin::null;
+}
+
+void IOPin::beginStagedConfiguration()
+{
+    isStagingConfiguration = true;
+}
+
+void IOPin::commitStagedConfiguration()
+{
+    isStagingConfiguration = false;
+    stagedConfiguration.commit();
+    stagedConfiguration.clear();
 }
 
 void IOPin::setInstancePtr()
 {
-    
+    IOPinParent::setInstancePtr(getGPIOPtrInstance(this->template getParameterValue<IOPinProperties::port>()));
 }
 void IOPin::setDefaultSettings()
 {
@@ -186,4 +352,56 @@ IOPinStatusCodes IOPin::preInit()
     return IOPinStatusCodes::Reset;
 }
 
-#endif
\ No newline at end of file
+/**
+ * @brief Points the pin at the GPIO of port and takes a user of the port clock; the handle of the previous port, if
+ * any, is released. A pin already used by another IOPin is refused
+ */
+IOPinStatusCodes IOPin::configPort(const GpioPort& port, IOPin& pin)
+{
+    const std::optional<AvailablePeripherals> peripheral = getGpioPortPeripheral(static_cast<uint32_t>(port));
+    if(port == GpioPort::null || !peripheral)
+        return IOPinStatusCodes::notReadyNotReset;
+    const IOPinStatusCodes location = pin.checkLocation();
+    if(location != IOPinStatusCodes::Ready)
+        return location;
+    pin.setInstancePtr();
+    if(pin.instance == nullptr)
+        return IOPinStatusCodes::notReadyNotReset;
+    pin.allocatePin();
+    // The former port is released while its clock is still held
+    pin.moveAppliedSettings();
+    if(!pin.portClock.isValid() || pin.portClock.getPeripheral() != *peripheral)
+        pin.portClock = PeripheralClockHandle<>(*peripheral);
+    return IOPinStatusCodes::Ready;
+}
+
+IOPinStatusCodes IOPin::configPin(const GpioPin& pin, IOPin& obj)
+{
+    if(pin == GpioPin::null)
+        return IOPinStatusCodes::notReadyNotReset;
+    const IOPinStatusCodes location = obj.checkLocation();
+    if(location != IOPinStatusCodes::Ready)
+        return location;
+    obj.allocatePin();
+    obj.moveAppliedSettings();
+    return IOPinStatusCodes::Ready;
+}
+
+IOPinStatusCodes IOPin::configMode(const GpioMode& mode, IOPin& pin)
+{
+    if(mode != GpioMode::null)
+        pin.queuedSettings |= static_cast<QueuedSettings_t>(GpioSetting::mode);
+    return IOPinStatusCodes::Ready;
+}
+
+/** @brief Drives the output through BSRR, so no other pin of the port is touched */
+IOPinStatusCodes IOPin::configState(const GpioState& state, IOPin& pin)
+{
+    if(state == GpioState::null)
+        return IOPinStatusCodes::Ready;
+    if(pin.instance == nullptr || !pin.isLocated())
+        return IOPinStatusCodes::notReadyNotReset;
+    const uint32_t bit = 0x1U << static_cast<uintCast_t>(pin.template getParameterValue<IOPinProperties::pin>());
+    pin.instance->BSRR = state == GpioState::high ? bit : bit << 16U;
+    return IOPinStatusCodes::Ready;
+}
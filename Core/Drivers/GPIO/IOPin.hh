@@ -2,16 +2,13 @@
 #define __IOPIN_H__
 
 #include <IOPinTypes.hh>
-#include <Container.hh>
+#include <FlatContainer.hh>
 #include <STM32PeripheralBase.hh>
-#include <IOPinTypes.hh>
-
-
+#include <GpioConfigBatch.hh>
+#include <ExternalInterrupt.hh>
+#include <AlternateFunctionMap.hh>
+#include <PeripheralClockHandle.hh>
 
-//#define COMPILE
-#ifdef COMPILE
-
-#define AVAILABLE_PORTS 7U
 
 enum class IOPinStatusCodes 
 { 
@@ -19,8 +16,10 @@ enum class IOPinStatusCodes
     Ready,
     ArgumentTypeNotAllowed,
     alreadyAllocatedPin,
+    alternateFunctionNotAvailable,
     handlerNotAllocated,
     initQueuedSettingsFailed,
+    interruptLineInUse,
     modeNotAllowed,
     notReadyNotReset,
     readingDeallocatedPin,
@@ -31,14 +30,15 @@ enum class IOPinStatusCodes
 
 enum class IOPinProperties : uint8_t { port, pin, mode, state,  __length };
 constexpr std::size_t IOPinMandatoryParameters = 1 << static_cast<std::size_t>(IOPinProperties::port) | 1 << static_cast<std::size_t>(IOPinProperties::pin);
-using IOPinPropertiesContainer = Container<IOPinProperties, GpioPort, GpioPin, GpioMode, GpioState>;
-using IOPinPeripheralBase = PeripheralBase<IOPinStatusCodes, IOPinMandatoryParameters, IOPinPropertiesContainer>;
+class IOPin;
+using IOPinPropertiesContainer = FlatContainer<IOPinProperties, GpioPort, GpioPin, GpioMode, GpioState>;
+using IOPinPeripheralBase = PeripheralBase<IOPin, IOPinStatusCodes, IOPinMandatoryParameters, IOPinPropertiesContainer>;
 using IOPinParent = STM32PeripheralBase<GPIO_TypeDef, IOPinPeripheralBase>;
-using ConfigPortFunctionType = IOPinStatusCodes(*)(const GpioPort&, IOPinPeripheralBase*);
-using ConfigPinFunctionType = IOPinStatusCodes(*)(const GpioPin&, IOPinPeripheralBase*);
-using ConfigModeFunctionType = IOPinStatusCodes(*)(const GpioMode&, IOPinPeripheralBase*);
-using ConfigStateFunctionType = IOPinStatusCodes(*)(const GpioState&, IOPinPeripheralBase*);
-using IOPinFunctionsContainer = Container<IOPinProperties, ConfigPortFunctionType, ConfigPinFunctionType, ConfigModeFunctionType, ConfigStateFunctionType>;
+using ConfigPortFunctionType = IOPinStatusCodes(*)(const GpioPort&, IOPin&);
+using ConfigPinFunctionType = IOPinStatusCodes(*)(const GpioPin&, IOPin&);
+using ConfigModeFunctionType = IOPinStatusCodes(*)(const GpioMode&, IOPin&);
+using ConfigStateFunctionType = IOPinStatusCodes(*)(const GpioState&, IOPin&);
+using IOPinFunctionsContainer = FlatContainer<IOPinProperties, ConfigPortFunctionType, ConfigPinFunctionType, ConfigModeFunctionType, ConfigStateFunctionType>;
 
 
 class IOPin  : public IOPinParent 
@@ -47,7 +47,7 @@ class IOPin  : public IOPinParent
 
         // Constructors & Destructor
         explicit IOPin();
-        virtual ~IOPin();
+        ~IOPin();
 
         template <typename... T>
         explicit IOPin(const T &...args);
@@ -68,6 +68,9 @@ class IOPin  : public IOPinParent
         IOPin &operator=(IOPin &&other);
 
 
+        // Runs the config functions of the parameters changed since the last call, then writes the queued settings
+        IOPinStatusCodes init();
+
         // Main functions that the interface offers
         IOPinStatusCodes setPort(const GpioPort &port);
         IOPinStatusCodes setPin(const GpioPin &pin);
@@ -75,6 +78,8 @@ class IOPin  : public IOPinParent
         IOPinStatusCodes setPUPD(const GpioPUPD &pupd);
         IOPinStatusCodes setOutputType(const GpioOutputType &outputType);
         IOPinStatusCodes setOutputSpeed(const GpioOutputSpeed &outputSpeed);
+        // Routes a peripheral signal to the pin, with the AF index taken from AlternateFunctionMap.hh
+        IOPinStatusCodes setAlternateFunction(const GpioSignal &signal);
 
         IOPinStatusCodes setInputMode();
         IOPinStatusCodes setOutputMode();
@@ -89,20 +94,35 @@ class IOPin  : public IOPinParent
         bool read();
         bool isReady();
 
+        // Interrupts on the EXTI line of the pin. A line can only be used by one port at a time
+        IOPinStatusCodes enableInterrupt(const GpioTrigger &trigger, const GpioInterruptCallback &callback, void *context = nullptr);
+        void disableInterrupt();
+
         // Utility public functions
         static bool isAllocated(const GpioPort &port, const GpioPin &pin);
         static bool isAllocated(const GPIO_TypeDef *port, const GpioPin &pin);
 
+        // Staged configuration: from begin to commit, the settings of every IOPin are only coalesced in RAM and
+        // commitStagedConfiguration writes them with at most one read-modify-write per GPIO register
+        static void beginStagedConfiguration();
+        static void commitStagedConfiguration();
+
     protected:
 
     private:
 
+        // The config functions are bound at compile time: PeripheralBase::init calls them directly
+        friend IOPinPeripheralBase;
+        static constexpr IOPinFunctionsContainer getConfigFunctions() { return { &IOPin::configPort, &IOPin::configPin, &IOPin::configMode, &IOPin::configState }; }
+
         bool isPinSet();
         bool isPortSet();
+        bool isLocated();
         bool isReallocating(const GpioPin &pin);
         bool isReallocating(const GpioPort &port);
         GPIO_TypeDef *getGPIOPtrInstance(const GpioPort &port);
         static GpioPort getPortFromGPIOStruct(const GPIO_TypeDef* gpio);
+        IOPinStatusCodes checkLocation();
         void allocatePin();
         void deAllocatePin();
 
@@ -122,52 +142,56 @@ class IOPin  : public IOPinParent
         bool setPortAndPin(const T &param);
 
 
-        IOPinStatusCodes init();
         IOPinStatusCodes preInit();
         void setDefaultSettings();
         template <typename Arg>
         IOPinStatusCodes init(const Arg &arg);
 
-        constexpr static IOPinStatusCodes configPort(const GpioPort& mode, IOPinPeripheralBase* obj) {
-
-            return IOPinStatusCodes::Ready;
-        }
-        constexpr static IOPinStatusCodes configPin(const GpioPin& pin, IOPinPeripheralBase* obj) {
-
-            uint32_t a = 32;
-            uint32_t b = a / 41;
-            return IOPinStatusCodes::Ready;
-        }
-        constexpr static IOPinStatusCodes configMode(const GpioMode& pin, IOPinPeripheralBase* obj) {
-
-            uint32_t a = 32;
-            uint32_t b = a / 41;
-            return IOPinStatusCodes::Ready;
-        }
-        constexpr static IOPinStatusCodes configState(const GpioState& pin, IOPinPeripheralBase* obj) {
-
-            uint32_t a = 32;
-            uint32_t b = a / 41;
-            return IOPinStatusCodes::Reset;
-        }
+        static IOPinStatusCodes configPort(const GpioPort& port, IOPin& pin);
+        static IOPinStatusCodes configPin(const GpioPin& pin, IOPin& obj);
+        static IOPinStatusCodes configMode(const GpioMode& mode, IOPin& pin);
+        static IOPinStatusCodes configState(const GpioState& state, IOPin& pin);
 
         void setInstancePtr();
-
+        void stageQueuedSettings(GpioConfigBatch &batch);
+        void moveAppliedSettings();
+
+        // Settings waiting for initQueuedSettings, flagged with GpioSetting values
+        QueuedSettings_t queuedSettings { 0 };
+        GpioPUPD queuedPUPD { GpioPUPD::disabled };
+        GpioOutputType queuedOutputType { GpioOutputType::pushPull };
+        GpioOutputSpeed queuedOutputSpeed { GpioOutputSpeed::low };
+        uint8_t queuedAlternateFunction { 0 };
+        // Settings already written to the hardware, and the pin they were written to
+        QueuedSettings_t appliedSettings { 0 };
+        GpioPort appliedPort { GpioPort::null };
+        GpioPin appliedPin { GpioPin::null };
+        // Pin marked as used in allocatedIOPins, freed when the pin moves or is destroyed
+        GpioPort allocatedPort { GpioPort::null };
+        GpioPin allocatedPin { GpioPin::null };
+        // Line of the allocated pin armed by enableInterrupt, disabled before the pin moves or is destroyed
+        bool interruptEnabled { false };
+        // Keeps the port clock on while the pin exists; the last pin of a port gates its clock off
+        PeripheralClockHandle<> portClock;
+
+        static GpioConfigBatch stagedConfiguration;
+        static bool isStagingConfiguration;
+
+        // Runtime allocation bitmap: IOPin locations are run-time values. The pins known at compile time are checked by BoardPinMap
         static AllocatedPin_t allocatedIOPins[AVAILABLE_PORTS];
 };
 template<typename... T>
-IOPin::IOPin(const T &...args)
+IOPin::IOPin(const T &...args) : IOPin()
 {
-
+    this->setParametersValues(args...);
 }
 
 template<typename Arg>
 IOPinStatusCodes IOPin::init(const Arg &arg)
 {
-
+    this->setParametersValues(arg);
+    return init();
 }
 
 
-#endif
-
 #endif // __IOPIN_H__
\ No newline at end of file
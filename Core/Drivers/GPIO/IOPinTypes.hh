@@ -8,6 +8,8 @@ typedef int32_t intCast_t;
 typedef uint32_t uintCast_t;
 typedef uint8_t QueuedSettings_t;
 
+#define AVAILABLE_PORTS 8U   // Indexed by GpioPort, which goes up to H = 7 (F and G do not exist on the F411)
+
 enum class GpioPort{null = -1, A = 0x0, B = 0x01, C = 0x02, D = 0x03, E = 0x04, H = 0x07};
 enum class GpioPin{null = -1, _0 = 0UL, _1 = 1UL, _2 = 2UL, _3 = 3UL, _4 = 4UL, _5 = 5UL, _6 = 6UL, _7 = 7UL, _8 = 8UL, _9 = 9UL, _10 = 10UL, _11 = 11UL, _12 = 12UL, _13 = 13UL, _14 = 14UL, _15 = 15UL};
 enum class GpioState{null = -1, low = 0, high = 1};
@@ -0,0 +1,187 @@
+#ifndef __PINGROUP_H__
+#define __PINGROUP_H__
+
+/**
+ * @file PinGroup.hh
+ * @brief Groups of pins of the same port driven and sampled together.
+ * The group is described with the same per-port bitmap used by IOPin's allocation table (AllocatedPin_t),
+ * so any subset of a port is set and cleared with a single BSRR store and read with a single IDR load.
+ * All the lines of the group change on the same bus cycle, so there is no skew between them.
+ * Like StaticPin, a group is stateless and does not take its pins in IOPin's allocation table: its pins are
+ * declared in BoardPinMap, which rejects a pin used twice at compile time.
+ */
+
+#include <StaticPin.hh>
+#include <bit>
+
+/**
+ * @brief Arbitrary subset of the pins of a port
+ *
+ * @tparam Port GPIO port of the group
+ * @tparam Mask Pins of the group, one bit per pin as in IOPin's allocatedIOPins
+ * @tparam Registers Register block resolver. Defaults to the memory mapped GPIO registers
+ */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PortGroup
+{
+    static_assert(Port != GpioPort::null, "[PortGroup requires a valid port]");
+    static_assert(Mask != 0, "[PortGroup requires at least one pin]");
+
+    public:
+
+        static constexpr GpioPort port { Port };
+        static constexpr AllocatedPin_t mask { Mask };
+        static constexpr uint32_t baseAddress { getGpioPortBaseAddress(Port) };
+
+        // Port-format operations: bit n of the argument/result is pin n of the port. Bits outside the group are ignored
+        static void set(const AllocatedPin_t& pins);
+        static void clear(const AllocatedPin_t& pins);
+        static void write(const AllocatedPin_t& pins);
+        static void toggle(const AllocatedPin_t& pins = Mask);
+        static AllocatedPin_t read();
+        static AllocatedPin_t readOutput();
+
+        static void setMode(const GpioMode& mode);
+
+    private:
+
+        static constexpr uint32_t bsrrResetShift { 16U };
+
+        // Lowest bit of the 2-bit MODER/OSPEEDR/PUPDR field of every pin of the group. Multiplying it by a
+        // field value replicates the value in every field of the group
+        static constexpr uint32_t twoBitsFieldsLowBits { []() {
+            uint32_t bits { 0 };
+            for(uint32_t pin = 0; pin < 16U; ++pin)
+                bits |= ((Mask >> pin) & 0x1U) << (pin * 2U);
+            return bits;
+        }() };
+
+        static auto* getRegisters() { return Registers<GPIO_TypeDef, baseAddress>::get(); }
+};
+
+/** @brief Drives high the given pins of the group. Single BSRR store */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void PortGroup<Port, Mask, Registers>::set(const AllocatedPin_t& pins)
+{
+    getRegisters()->BSRR = static_cast<uint32_t>(pins & Mask);
+}
+
+/** @brief Drives low the given pins of the group. Single BSRR store */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void PortGroup<Port, Mask, Registers>::clear(const AllocatedPin_t& pins)
+{
+    getRegisters()->BSRR = static_cast<uint32_t>(pins & Mask) << bsrrResetShift;
+}
+
+/** @brief Drives every pin of the group at once: pins whose bit is set go high, the rest of the group goes low. Single BSRR store */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void PortGroup<Port, Mask, Registers>::write(const AllocatedPin_t& pins)
+{
+    const uint32_t high = static_cast<uint32_t>(pins) & Mask;
+    getRegisters()->BSRR = high | ((high ^ Mask) << bsrrResetShift);
+}
+
+/** @brief Inverts the given pins of the group. One ODR load plus one BSRR store */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void PortGroup<Port, Mask, Registers>::toggle(const AllocatedPin_t& pins)
+{
+    auto* regs = getRegisters();
+    const uint32_t selected = static_cast<uint32_t>(pins) & Mask;
+    const uint32_t current = static_cast<uint32_t>(regs->ODR) & selected;
+    regs->BSRR = (current << bsrrResetShift) | (current ^ selected);
+}
+
+/** @brief Input level of the group, in port format. Single IDR load */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline AllocatedPin_t PortGroup<Port, Mask, Registers>::read()
+{
+    return static_cast<AllocatedPin_t>(static_cast<uint32_t>(getRegisters()->IDR) & Mask);
+}
+
+/** @brief Output level of the group, in port format. Single ODR load */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline AllocatedPin_t PortGroup<Port, Mask, Registers>::readOutput()
+{
+    return static_cast<AllocatedPin_t>(static_cast<uint32_t>(getRegisters()->ODR) & Mask);
+}
+
+/** @brief Sets the mode of every pin of the group with a single MODER read-modify-write */
+template<GpioPort Port, AllocatedPin_t Mask, template<typename, uint32_t> class Registers>
+inline void PortGroup<Port, Mask, Registers>::setMode(const GpioMode& mode)
+{
+    if(mode == GpioMode::null)
+        return;
+
+    auto& moder = getRegisters()->MODER;
+    moder = (static_cast<uint32_t>(moder) & ~(twoBitsFieldsLowBits * 0x3U)) | (twoBitsFieldsLowBits * static_cast<uint32_t>(mode));
+}
+
+
+/**
+ * @brief Builds the port bitmap of a list of pins
+ */
+template<GpioPin... Pins>
+constexpr AllocatedPin_t getPinsMask()
+{
+    static_assert(((Pins != GpioPin::null) && ...), "[a pin group can not contain a null pin]");
+    constexpr AllocatedPin_t mask = (static_cast<AllocatedPin_t>(0x1U << static_cast<uint32_t>(Pins)) | ... | 0);
+    static_assert(std::popcount(mask) == sizeof...(Pins), "[a pin group can not contain the same pin twice]");
+    return mask;
+}
+
+/**
+ * @brief Group made of an explicit list of pins on the registers of Registers. The resolver comes first since the
+ * pin list is a pack, e.g. PinGroupOn<SimulatedRegisters, GpioPort::B, GpioPin::_0, GpioPin::_7>
+ */
+template<template<typename, uint32_t> class Registers, GpioPort Port, GpioPin... Pins>
+using PinGroupOn = PortGroup<Port, getPinsMask<Pins...>(), Registers>;
+
+/**
+ * @brief Group made of an explicit list of pins, e.g. PinGroup<GpioPort::B, GpioPin::_0, GpioPin::_7, GpioPin::_12>
+ */
+template<GpioPort Port, GpioPin... Pins>
+using PinGroup = PinGroupOn<PeripheralRegisters, Port, Pins...>;
+
+
+/**
+ * @brief Contiguous pins of a port used as a parallel bus. Values are written and read right-aligned,
+ * e.g. an 8-bit bus on PB8..PB15 is PortBus<GpioPort::B, GpioPin::_8, 8> and writeValue(0xA5) drives PB15..PB8 = 1010 0101
+ *
+ * @tparam Port GPIO port of the bus
+ * @tparam LowestPin Pin carrying bit 0 of the bus
+ * @tparam Width Number of lines of the bus
+ * @tparam Registers Register block resolver. Defaults to the memory mapped GPIO registers
+ */
+template<GpioPort Port, GpioPin LowestPin, std::size_t Width, template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PortBus : public PortGroup<Port, static_cast<AllocatedPin_t>(((0x1UL << Width) - 1U) << static_cast<uint32_t>(LowestPin)), Registers>
+{
+    static_assert(LowestPin != GpioPin::null, "[PortBus requires a valid lowest pin]");
+    static_assert(Width > 0 && (Width + static_cast<std::size_t>(LowestPin)) <= 16U, "[PortBus does not fit in the port]");
+
+    public:
+
+        using PortGroupType = PortGroup<Port, static_cast<AllocatedPin_t>(((0x1UL << Width) - 1U) << static_cast<uint32_t>(LowestPin)), Registers>;
+
+        static constexpr std::size_t width { Width };
+        static constexpr uint32_t shift { static_cast<uint32_t>(LowestPin) };
+
+        static void writeValue(const uint16_t& value);
+        static uint16_t readValue();
+};
+
+/** @brief Drives the whole bus to value. Single BSRR store */
+template<GpioPort Port, GpioPin LowestPin, std::size_t Width, template<typename, uint32_t> class Registers>
+inline void PortBus<Port, LowestPin, Width, Registers>::writeValue(const uint16_t& value)
+{
+    PortGroupType::write(static_cast<AllocatedPin_t>(static_cast<uint32_t>(value) << shift));
+}
+
+/** @brief Samples the whole bus. Single IDR load */
+template<GpioPort Port, GpioPin LowestPin, std::size_t Width, template<typename, uint32_t> class Registers>
+inline uint16_t PortBus<Port, LowestPin, Width, Registers>::readValue()
+{
+    return static_cast<uint16_t>(PortGroupType::read() >> shift);
+}
+
+
+#endif // __PINGROUP_H__
@@ -0,0 +1,155 @@
+#ifndef __PINMAP_H__
+#define __PINMAP_H__
+
+/**
+ * @file PinMap.hh
+ * @brief Compile-time registry of every pin a board uses.
+ * Each pin is declared once, with its mode and alternate function. Declaring the same pin twice is a
+ * static_assert failure, so allocation conflicts are reported by the compiler instead of by IOPin at runtime.
+ */
+
+#include <IOPinTypes.hh>
+#include <StaticPin.hh>
+#include <GpioConfigBatch.hh>
+#include <AlternateFunctionMap.hh>
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief Usage of one pin of the board
+ */
+struct PinAssignment
+{
+    GpioPort port { GpioPort::null };
+    GpioPin pin { GpioPin::null };
+    GpioMode mode { GpioMode::null };
+    uint8_t alternateFunction { 0 };
+};
+
+/**
+ * @brief Assignment of a pin to a peripheral signal, with the AF index taken from the alternate function table.
+ * Routing a signal to a pin that can not carry it stops the build
+ */
+consteval PinAssignment alternateFunctionPin(const GpioPort& port, const GpioPin& pin, const GpioSignal& signal)
+{
+    if(!isAlternateFunctionAvailable(port, pin, signal))
+        throw "[the pin can not carry this signal, see AlternateFunctionMap.hh]";
+    return PinAssignment{ port, pin, GpioMode::alternateFunction, getAlternateFunction(port, pin, signal) };
+}
+
+/**
+ * @brief Board pin map
+ *
+ * @tparam Assignments Every pin used by the board
+ */
+template<PinAssignment... Assignments>
+class PinMap
+{
+    public:
+
+        static constexpr std::size_t numberOfPins { sizeof...(Assignments) };
+        static constexpr std::array<PinAssignment, sizeof...(Assignments)> assignments { Assignments... };
+
+        static constexpr bool contains(const GpioPort& port, const GpioPin& pin);
+        static constexpr PinAssignment getAssignment(const GpioPort& port, const GpioPin& pin);
+        static constexpr AllocatedPin_t getAllocatedPins(const GpioPort& port);
+
+        /** @brief Per-port bitmap of the used pins, same layout as IOPin's allocatedIOPins */
+        static constexpr std::array<AllocatedPin_t, AVAILABLE_PORTS> allocatedPins { []() {
+            std::array<AllocatedPin_t, AVAILABLE_PORTS> pins {};
+            for(const PinAssignment& assignment : assignments)
+            {
+                if(assignment.port != GpioPort::null && assignment.pin != GpioPin::null)
+                    pins[static_cast<std::size_t>(assignment.port)] |= static_cast<AllocatedPin_t>(0x1U << static_cast<uint32_t>(assignment.pin));
+            }
+            return pins;
+        }() };
+
+        /** @brief Mode and alternate function of every pin of the map, staged at compile time */
+        static constexpr GpioConfigBatch configuration { []() {
+            GpioConfigBatch batch {};
+            for(const PinAssignment& assignment : assignments)
+            {
+                batch.stageMode(assignment.port, assignment.pin, assignment.mode);
+                if(assignment.mode == GpioMode::alternateFunction)
+                    batch.stageAlternateFunction(assignment.port, assignment.pin, assignment.alternateFunction);
+            }
+            return batch;
+        }() };
+
+        /** @brief Configures every pin of the map with at most one read-modify-write per GPIO register */
+        template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+        static void configure() { configuration.template commit<Registers>(); }
+
+        /** @brief StaticPin for a pin of the map. Using a pin that is not declared in the map does not compile */
+        template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers = PeripheralRegisters>
+            requires (contains(Port, Pin))
+        using StaticPinType = StaticPin<Port, Pin, Registers>;
+
+    private:
+
+        static constexpr bool areAssignmentsValid();
+        static constexpr bool isEveryPinAllocatedOnce();
+
+        static_assert(areAssignmentsValid(), "[pin map entries require a port, a pin, a mode and an alternate function in 0..15]");
+        static_assert(isEveryPinAllocatedOnce(), "[the same pin is allocated twice in the pin map]");
+};
+
+template<PinAssignment... Assignments>
+constexpr bool PinMap<Assignments...>::contains(const GpioPort& port, const GpioPin& pin)
+{
+    for(const PinAssignment& assignment : assignments)
+    {
+        if(assignment.port == port && assignment.pin == pin)
+            return true;
+    }
+    return false;
+}
+
+/** @brief Assignment of a pin, or a default constructed (null) assignment if the pin is not in the map */
+template<PinAssignment... Assignments>
+constexpr PinAssignment PinMap<Assignments...>::getAssignment(const GpioPort& port, const GpioPin& pin)
+{
+    for(const PinAssignment& assignment : assignments)
+    {
+        if(assignment.port == port && assignment.pin == pin)
+            return assignment;
+    }
+    return PinAssignment{};
+}
+
+template<PinAssignment... Assignments>
+constexpr AllocatedPin_t PinMap<Assignments...>::getAllocatedPins(const GpioPort& port)
+{
+    if(port == GpioPort::null)
+        return 0;
+    return allocatedPins[static_cast<std::size_t>(port)];
+}
+
+template<PinAssignment... Assignments>
+constexpr bool PinMap<Assignments...>::areAssignmentsValid()
+{
+    for(const PinAssignment& assignment : assignments)
+    {
+        if(assignment.port == GpioPort::null || assignment.pin == GpioPin::null || assignment.mode == GpioMode::null || assignment.alternateFunction > 15U)
+            return false;
+    }
+    return true;
+}
+
+template<PinAssignment... Assignments>
+constexpr bool PinMap<Assignments...>::isEveryPinAllocatedOnce()
+{
+    for(std::size_t i = 0; i < assignments.size(); ++i)
+    {
+        for(std::size_t j = i + 1; j < assignments.size(); ++j)
+        {
+            if(assignments[i].port == assignments[j].port && assignments[i].pin == assignments[j].pin)
+                return false;
+        }
+    }
+    return true;
+}
+
+
+#endif // __PINMAP_H__
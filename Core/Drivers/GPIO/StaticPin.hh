@@ -0,0 +1,217 @@
+#ifndef __STATICPIN_H__
+#define __STATICPIN_H__
+
+/**
+ * @file StaticPin.hh
+ * @brief Compile-time GPIO pin. Port and pin are template arguments, so the class carries no state,
+ * no vtable and no parameter container: every output operation is a single store to BSRR and every
+ * input operation is a single load from IDR.
+ */
+
+#include <IOPinTypes.hh>
+#include <PeripheralBaseTypes.hh>
+#include <ExternalInterrupt.hh>
+#include <AlternateFunctionMap.hh>
+#include <PeripheralClockHandle.hh>
+
+/**
+ * @brief Base address of the GPIO register block of a port. Ports are placed every 0x400 bytes starting at GPIOA
+ */
+constexpr uint32_t getGpioPortBaseAddress(const GpioPort& port)
+{
+    return GPIOA_BASE + static_cast<uint32_t>(port) * (GPIOB_BASE - GPIOA_BASE);
+}
+
+/**
+ * @brief Zero-overhead GPIO pin
+ *
+ * @tparam Port GPIO port of the pin
+ * @tparam Pin GPIO pin number
+ * @tparam Registers Register block resolver. Defaults to the memory mapped GPIO registers
+ */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers = PeripheralRegisters>
+class StaticPin
+{
+    static_assert(Port != GpioPort::null, "[StaticPin requires a valid port]");
+    static_assert(Pin != GpioPin::null, "[StaticPin requires a valid pin]");
+    static_assert(getGpioPortPeripheral(static_cast<uint32_t>(Port)).has_value(), "[StaticPin requires a port of the F411]");
+
+    public:
+
+        static constexpr GpioPort port { Port };
+        static constexpr GpioPin pin { Pin };
+        static constexpr uint32_t baseAddress { getGpioPortBaseAddress(Port) };
+        static constexpr AllocatedPin_t mask { static_cast<AllocatedPin_t>(0x1U << static_cast<uint32_t>(Pin)) };
+
+        // The pin type holds one user of the port clock from enableClock to disableClock, so the port is not gated
+        // off under it when the last IOPin of the port goes away
+        static void enableClock();
+        static void disableClock();
+
+        // Output operations: one BSRR store each
+        static void set();
+        static void clear();
+        static void write(const bool& state);
+        static void toggle();
+
+        // Input operations: one IDR/ODR load each
+        static bool read();
+        static bool readOutput();
+
+        // Configuration: one read-modify-write on the corresponding register each
+        static void setMode(const GpioMode& mode);
+        static void setPUPD(const GpioPUPD& pupd);
+        static void setOutputType(const GpioOutputType& outputType);
+        static void setOutputSpeed(const GpioOutputSpeed& outputSpeed);
+
+        // Routes a peripheral signal to the pin. Signals the pin can not carry do not compile
+        template<GpioSignal Signal>
+            requires (isAlternateFunctionAvailable(Port, Pin, Signal))
+        static void setAlternateFunction();
+
+        // Interrupts on the EXTI line of the pin
+        static bool enableInterrupt(const GpioTrigger& trigger, const GpioInterruptCallback& callback, void* context = nullptr);
+        static void disableInterrupt();
+
+    private:
+
+        static constexpr uint32_t pinNumber { static_cast<uint32_t>(Pin) };
+        static constexpr uint32_t bsrrResetShift { 16U };
+
+        static auto* getRegisters() { return Registers<GPIO_TypeDef, baseAddress>::get(); }
+
+        static void writeTwoBitsField(auto& reg, const uint32_t& value);
+
+        static constinit inline PeripheralClockHandle<Registers> portClock {};
+};
+
+/** @brief Takes the pin's user of the port clock, enabling it if no other user holds it. Repeated calls take one user */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::enableClock()
+{
+    if(!portClock.isValid())
+        portClock = PeripheralClockHandle<Registers>(*getGpioPortPeripheral(static_cast<uint32_t>(Port)));
+}
+
+/** @brief Drops the pin's user of the port clock. The clock is gated off only if no other user holds it */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::disableClock()
+{
+    portClock.release();
+}
+
+/** @brief Drives the pin high. Single BSRR store */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::set()
+{
+    getRegisters()->BSRR = static_cast<uint32_t>(mask);
+}
+
+/** @brief Drives the pin low. Single BSRR store */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::clear()
+{
+    getRegisters()->BSRR = static_cast<uint32_t>(mask) << bsrrResetShift;
+}
+
+/**
+ * @brief Drives the pin to the given state. Single BSRR store, branch-free: the set bit is shifted into
+ * the reset half of BSRR when the requested state is low
+ */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::write(const bool& state)
+{
+    getRegisters()->BSRR = static_cast<uint32_t>(mask) << (static_cast<uint32_t>(!state) * bsrrResetShift);
+}
+
+/**
+ * @brief Inverts the output. One ODR load plus one BSRR store; unlike an ODR read-modify-write,
+ * a concurrent write to another pin of the same port can not be lost
+ */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::toggle()
+{
+    auto* regs = getRegisters();
+    const uint32_t current = static_cast<uint32_t>(regs->ODR) & mask;
+    regs->BSRR = (current << bsrrResetShift) | (current ^ mask);
+}
+
+/** @brief Reads the input level of the pin. Single IDR load */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline bool StaticPin<Port, Pin, Registers>::read()
+{
+    return static_cast<uint32_t>(getRegisters()->IDR) & mask;
+}
+
+/** @brief Reads back the level the pin is being driven to. Single ODR load */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline bool StaticPin<Port, Pin, Registers>::readOutput()
+{
+    return static_cast<uint32_t>(getRegisters()->ODR) & mask;
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::setMode(const GpioMode& mode)
+{
+    if(mode == GpioMode::null)
+        return;
+    writeTwoBitsField(getRegisters()->MODER, static_cast<uint32_t>(mode));
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::setPUPD(const GpioPUPD& pupd)
+{
+    writeTwoBitsField(getRegisters()->PUPDR, static_cast<uint32_t>(pupd));
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::setOutputType(const GpioOutputType& outputType)
+{
+    auto& reg = getRegisters()->OTYPER;
+    reg = (static_cast<uint32_t>(reg) & ~static_cast<uint32_t>(mask)) | (static_cast<uint32_t>(outputType) << pinNumber);
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::setOutputSpeed(const GpioOutputSpeed& outputSpeed)
+{
+    writeTwoBitsField(getRegisters()->OSPEEDR, static_cast<uint32_t>(outputSpeed));
+}
+
+/**
+ * @brief Writes the AF index of Signal, resolved at compile time, to the pin field of AFR[0] or AFR[1] and then
+ * switches the pin to alternate function mode. One read-modify-write on each register
+ */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+template<GpioSignal Signal>
+    requires (isAlternateFunctionAvailable(Port, Pin, Signal))
+inline void StaticPin<Port, Pin, Registers>::setAlternateFunction()
+{
+    constexpr uint32_t alternateFunction { getAlternateFunction(Port, Pin, Signal) };
+    constexpr uint32_t shift { (pinNumber % 8U) * 4U };
+    auto& afr = getRegisters()->AFR[pinNumber / 8U];
+    afr = (static_cast<uint32_t>(afr) & ~(0xFU << shift)) | (alternateFunction << shift);
+    writeTwoBitsField(getRegisters()->MODER, static_cast<uint32_t>(GpioMode::alternateFunction));
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline bool StaticPin<Port, Pin, Registers>::enableInterrupt(const GpioTrigger& trigger, const GpioInterruptCallback& callback, void* context)
+{
+    return ExternalInterrupt<Registers>::enable(Port, Pin, trigger, callback, context);
+}
+
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::disableInterrupt()
+{
+    ExternalInterrupt<Registers>::disable(Port, Pin);
+}
+
+/** @brief Read-modify-write of the 2-bit field that belongs to this pin in MODER, OSPEEDR or PUPDR */
+template<GpioPort Port, GpioPin Pin, template<typename, uint32_t> class Registers>
+inline void StaticPin<Port, Pin, Registers>::writeTwoBitsField(auto& reg, const uint32_t& value)
+{
+    constexpr uint32_t shift { pinNumber * 2U };
+    reg = (static_cast<uint32_t>(reg) & ~(0x3U << shift)) | ((value & 0x3U) << shift);
+}
+
+
+#endif // __STATICPIN_H__
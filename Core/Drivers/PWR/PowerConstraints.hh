@@ -0,0 +1,122 @@
+#ifndef __POWERCONSTRAINTS_H__
+#define __POWERCONSTRAINTS_H__
+
+/**
+ * @file PowerConstraints.hh
+ * @brief Wake-up latency constraints and sleep clocks registered by the drivers, read by PowerManager. A driver
+ * with a transfer in flight (a busy DMA stream, a USART receiving) registers the sleepOnly budget with the clocks
+ * the transfer needs, so the idle path neither stops its clocks nor gates them in sleep. The registry is not a
+ * template: drivers on the memory mapped registers and every PowerManager instantiation see the same constraints.
+ */
+
+#include <ClockGating.hh>
+#include <array>
+#include <limits>
+
+enum class PowerMode : uint8_t { run, sleep, stop, stopLowPowerRegulator, standby, __length };
+
+constexpr std::size_t powerModesCount { static_cast<std::size_t>(PowerMode::__length) };
+
+/**
+ * @brief Worst-case wake-up time of every mode, in microseconds (DS10314 low-power mode wakeup timings, rounded up).
+ * The stop modes include the flash wake-up; standby exits through a reset
+ */
+constexpr std::array<uint32_t, powerModesCount> powerModeWakeLatency { 0U, 1U, 15U, 115U, 320U };
+
+/** @brief Deepest mode that wakes up within wakeLatencyBudget microseconds */
+constexpr PowerMode getDeepestPowerMode(const uint32_t& wakeLatencyBudget)
+{
+    PowerMode mode { PowerMode::run };
+    for(std::size_t i = 0; i < powerModesCount; ++i)
+    {
+        if(powerModeWakeLatency[i] <= wakeLatencyBudget)
+            mode = static_cast<PowerMode>(i);
+    }
+    return mode;
+}
+
+/** @brief Slot of the registry: a budget in microseconds and the clocks kept running in sleep meanwhile */
+struct PowerConstraint
+{
+    uint32_t microseconds { std::numeric_limits<uint32_t>::max() };
+    PeripheralClockMask sleepClocks {};
+    bool used { false };
+};
+
+class PowerConstraints
+{
+    public:
+
+        static constexpr uint32_t maxConstraints { 8U };
+        static constexpr uint8_t invalidConstraint { 0xFFU };
+        static constexpr uint32_t noConstraint { std::numeric_limits<uint32_t>::max() };
+        // Budget of a transfer that needs its peripheral clocked: only sleep keeps the clocks running
+        static constexpr uint32_t sleepOnly { powerModeWakeLatency[static_cast<std::size_t>(PowerMode::sleep)] };
+
+        /**
+         * @brief Wake-up latency constraint, in microseconds, with the peripheral clocks kept running in sleep
+         * meanwhile. Returns the id the driver keeps until it removes it, or invalidConstraint if every slot is taken
+         */
+        static uint8_t addWakeLatencyConstraint(const uint32_t& microseconds, const PeripheralClockMask& sleepClocks = {});
+        static void removeWakeLatencyConstraint(const uint8_t& id);
+        static uint32_t getWakeLatencyBudget();
+        static PeripheralClockMask getSleepClocks();
+
+        // Standby loses the SRAM and the peripheral registers and wakes up through a reset: idle only enters it once
+        // the application allows it
+        static void allowStandby(const bool& allowed) { standbyAllowed = allowed; }
+        static bool isStandbyAllowed() { return standbyAllowed; }
+        static PowerMode getAllowedPowerMode();
+
+    private:
+
+        static constinit inline std::array<PowerConstraint, maxConstraints> constraints {};
+        static constinit inline bool standbyAllowed { false };
+};
+
+inline uint8_t PowerConstraints::addWakeLatencyConstraint(const uint32_t& microseconds, const PeripheralClockMask& sleepClocks)
+{
+    for(uint8_t id = 0; id < maxConstraints; ++id)
+    {
+        if(!constraints[id].used)
+        {
+            constraints[id] = PowerConstraint{ microseconds, sleepClocks, true };
+            return id;
+        }
+    }
+    return invalidConstraint;
+}
+
+inline void PowerConstraints::removeWakeLatencyConstraint(const uint8_t& id)
+{
+    if(id < maxConstraints)
+        constraints[id] = PowerConstraint{};
+}
+
+/** @brief Tightest registered constraint, or noConstraint if there is none */
+inline uint32_t PowerConstraints::getWakeLatencyBudget()
+{
+    uint32_t budget { noConstraint };
+    for(const PowerConstraint& constraint : constraints)
+        budget = constraint.microseconds < budget ? constraint.microseconds : budget;
+    return budget;
+}
+
+/** @brief Clocks of every registered constraint */
+inline PeripheralClockMask PowerConstraints::getSleepClocks()
+{
+    PeripheralClockMask clocks {};
+    for(const PowerConstraint& constraint : constraints)
+        clocks = clocks | constraint.sleepClocks;
+    return clocks;
+}
+
+/** @brief Deepest mode within the budget. Without constraint, that is stop with the low-power regulator unless standby is allowed */
+inline PowerMode PowerConstraints::getAllowedPowerMode()
+{
+    const PowerMode mode = getDeepestPowerMode(getWakeLatencyBudget());
+    return mode == PowerMode::standby && !standbyAllowed ? PowerMode::stopLowPowerRegulator : mode;
+}
+
+
+#endif // __POWERCONSTRAINTS_H__
@@ -0,0 +1,186 @@
+#ifndef __POWERMANAGER_H__
+#define __POWERMANAGER_H__
+
+/**
+ * @file PowerManager.hh
+ * @brief Low-power mode selection. Drivers register the longest wake-up time they can tolerate (PowerConstraints.hh),
+ * and the idle path enters the deepest mode that wakes up within the tightest of them (sleep, stop with the main or
+ * the low-power regulator, and standby once the application allows it). In sleep, the RCC LPENR registers keep only
+ * the clocks the constraints name running. Stop mode exits on the HSI, so the clock tree is switched back before
+ * returning. The cycles spent running and in sleep are accumulated from the core cycle counter. It stops with the
+ * core clock in the stop modes, so those only count their entries, and standby is not counted at all: it exits
+ * through a reset.
+ */
+
+#include <PowerConstraints.hh>
+#include <ClockTree.hh>
+#include <ClockGating.hh>
+#include <PeripheralClockHandle.hh>
+#include <array>
+
+enum class PowerManagerStatusCodes
+{
+    Ready,
+    clockRestoreFailed,
+    invalidMode,
+};
+
+/** @brief Times a mode was entered and core cycles spent in it. cycles stays 0 for the stop modes, whose time CYCCNT does not see */
+struct PowerModeStatistics
+{
+    uint32_t entries { 0 };
+    uint64_t cycles { 0 };
+};
+
+/**
+ * @brief Cortex-M4 primitives used by the power manager. Tests replace it to emulate the wake-up.
+ * DWT CYCCNT only counts while the core is clocked: it keeps counting in sleep, and stops in stop and standby
+ */
+struct CortexCore
+{
+    static void enableCycleCounter()
+    {
+        CoreDebug->DEMCR = static_cast<uint32_t>(CoreDebug->DEMCR) | CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL = static_cast<uint32_t>(DWT->CTRL) | DWT_CTRL_CYCCNTENA_Msk;
+    }
+    static uint32_t getCycleCount() { return DWT->CYCCNT; }
+    static void waitForInterrupt() { __DSB(); __WFI(); __ISB(); }
+};
+
+/**
+ * @brief Power manager of the STM32F411
+ *
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ * @tparam Core Cycle counter and WFI provider
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters, class Core = CortexCore>
+class PowerManager : public PowerConstraints
+{
+    public:
+
+        static void init();
+
+        /** @brief Enters the deepest allowed mode until the next interrupt, then restores Configuration */
+        template<ClockConfiguration Configuration>
+        static PowerManagerStatusCodes idle() { return enter<Configuration>(getAllowedPowerMode()); }
+        template<ClockConfiguration Configuration>
+        static PowerManagerStatusCodes enter(const PowerMode& mode);
+
+        static const PowerModeStatistics& getStatistics(const PowerMode& mode) { return statistics[static_cast<std::size_t>(mode)]; }
+        static void resetStatistics();
+
+    private:
+
+        static constexpr uint32_t deepSleepBits { PWR_CR_LPDS | PWR_CR_PDDS | PWR_CR_FPDS };
+
+        static void writeSleepClocks();
+        static void account(const PowerMode& mode, const uint32_t& from, const uint32_t& to);
+
+        static auto* getRCC() { return Registers<RCC_TypeDef, RCC_BASE>::get(); }
+        static auto* getPWR() { return Registers<PWR_TypeDef, PWR_BASE>::get(); }
+        static auto* getSCB() { return Registers<SCB_Type, SCB_BASE>::get(); }
+
+        // Clocks last written to the LPENR registers, so a sleep with the same constraints does not write them again
+        static constinit inline PeripheralClockMask writtenSleepClocks {};
+        static constinit inline bool sleepClocksWritten { false };
+        // Held from init on: the mode bits are written at every idle
+        static constinit inline PeripheralClockHandle<Registers> pwrClock {};
+        static constinit inline std::array<PowerModeStatistics, powerModesCount> statistics {};
+        static constinit inline uint32_t lastTransition { 0 };
+};
+
+/** @brief PWR clock for the mode bits and cycle counter */
+template<template<typename, uint32_t> class Registers, class Core>
+inline void PowerManager<Registers, Core>::init()
+{
+    if(!pwrClock.isValid())
+        pwrClock = PeripheralClockHandle<Registers>(AvailablePeripherals::_PWR);
+    Core::enableCycleCounter();
+    lastTransition = Core::getCycleCount();
+}
+
+/**
+ * @brief Enters mode until the next interrupt. Sleep first leaves only the clocks of the constraints running in the
+ * LPENR registers. The deep modes set SLEEPDEEP and the PWR_CR mode bits; after a stop the core runs from the HSI, so
+ * Configuration is applied again before returning
+ */
+template<template<typename, uint32_t> class Registers, class Core>
+template<ClockConfiguration Configuration>
+inline PowerManagerStatusCodes PowerManager<Registers, Core>::enter(const PowerMode& mode)
+{
+    if(mode == PowerMode::run)
+        return PowerManagerStatusCodes::Ready;
+    if(mode >= PowerMode::__length)
+        return PowerManagerStatusCodes::invalidMode;
+
+    auto* pwr = getPWR();
+    auto* scb = getSCB();
+    const bool deepSleep = mode != PowerMode::sleep;
+    if(!deepSleep)
+        writeSleepClocks();
+    uint32_t modeBits { 0 };
+    if(mode == PowerMode::stopLowPowerRegulator)
+        modeBits = PWR_CR_LPDS | PWR_CR_FPDS;
+    else if(mode == PowerMode::standby)
+        modeBits = PWR_CR_PDDS | PWR_CR_CWUF;
+    pwr->CR = (static_cast<uint32_t>(pwr->CR) & ~deepSleepBits) | modeBits;
+    scb->SCR = (static_cast<uint32_t>(scb->SCR) & ~SCB_SCR_SLEEPDEEP_Msk) | (deepSleep ? SCB_SCR_SLEEPDEEP_Msk : 0U);
+
+    const uint32_t entry = Core::getCycleCount();
+    account(PowerMode::run, lastTransition, entry);
+    Core::waitForInterrupt();
+    const uint32_t wake = Core::getCycleCount();
+    // Only sleep keeps the counter running. A standby that returns here never happened on the hardware
+    if(mode != PowerMode::standby)
+        account(mode, entry, mode == PowerMode::sleep ? wake : entry);
+    lastTransition = wake;
+
+    scb->SCR = static_cast<uint32_t>(scb->SCR) & ~SCB_SCR_SLEEPDEEP_Msk;
+    if(!deepSleep)
+        return PowerManagerStatusCodes::Ready;
+    if(ClockTree<Registers>::template apply<Configuration>() != RCCStatusCodes::Ready)
+        return PowerManagerStatusCodes::clockRestoreFailed;
+    return PowerManagerStatusCodes::Ready;
+}
+
+template<template<typename, uint32_t> class Registers, class Core>
+inline void PowerManager<Registers, Core>::resetStatistics()
+{
+    statistics = {};
+    lastTransition = Core::getCycleCount();
+}
+
+/**
+ * @brief Every clock the constraints do not name is gated in sleep. The flash and SRAM1 interfaces stay clocked only
+ * when a DMA does, since it is their only user then
+ */
+template<template<typename, uint32_t> class Registers, class Core>
+inline void PowerManager<Registers, Core>::writeSleepClocks()
+{
+    const PeripheralClockMask sleepClocks = getSleepClocks();
+    if(sleepClocksWritten && sleepClocks == writtenSleepClocks)
+        return;
+    auto* rcc = getRCC();
+    constexpr uint32_t dma { RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMA2EN };
+    const uint32_t memories = (sleepClocks.ahb1 & dma) ? (RCC_AHB1LPENR_FLITFLPEN | RCC_AHB1LPENR_SRAM1LPEN) : 0U;
+    rcc->AHB1LPENR = sleepClocks.ahb1 | memories;
+    rcc->AHB2LPENR = sleepClocks.ahb2;
+    rcc->APB1LPENR = sleepClocks.apb1;
+    rcc->APB2LPENR = sleepClocks.apb2;
+    writtenSleepClocks = sleepClocks;
+    sleepClocksWritten = true;
+}
+
+/** @brief Unsigned difference, so one wrap of the 32-bit counter between two transitions is accounted correctly */
+template<template<typename, uint32_t> class Registers, class Core>
+inline void PowerManager<Registers, Core>::account(const PowerMode& mode, const uint32_t& from, const uint32_t& to)
+{
+    PowerModeStatistics& modeStatistics = statistics[static_cast<std::size_t>(mode)];
+    if(mode != PowerMode::run)
+        ++modeStatistics.entries;
+    modeStatistics.cycles += to - from;
+}
+
+
+#endif // __POWERMANAGER_H__
@@ -7,164 +7,217 @@
  * @brief Base class driver for all of the peripherals on STM32 microcontroller
  * @version 0.1
  * @date 2023-04-15
- * 
+ *
  * @copyright Copyright (c) 2023
- * 
+ *
 */
 
 /**
  * @brief  Required inclued headers
  */
 #include <PeripheralBaseTypes.hh>
-#include <Container.hh>
-#include <bitset>
+#include <FlatContainer.hh>
+#include <array>
 
 
-template<typename T>
-struct StaticManager { std::size_t classInstanceCounter; };
+template<typename Derived, typename StatusCode, std::size_t MandatoryParameters, typename ParametersContainer>
+class PeripheralBase;
 
 /**
- * @brief 
- * 
- * @tparam StatusCode is an enum class listing all the possible errors/malfunctioning (hardware related) for that particular peripheral
- * @tparam Parameter is an object of the type "types"
+ * @brief Parameters and status of a driver, and the dispatch of its configuration functions. The driver derives from
+ * it (CRTP) and binds one configuration function per parameter at compile time, in
+ *
+ *     static constexpr ConfigFunctionsType getConfigFunctions() { return { &Driver::configA, &Driver::configB }; }
+ *
+ * so init calls every one of them directly, in label order, and the compiler can inline them into straight-line
+ * register writes: no function pointer is stored in the object or read at run time.
+ *
+ * Every parameter carries a dirty bit, set when a setter changes its value and cleared when its config function
+ * succeeds, so a re-initialization only writes the registers of the parameters that changed. The values given to the
+ * constructor are defaults: they are dirty, but a mandatory parameter still has to be set before init runs anything.
+ *
+ * @tparam Derived The driver class
+ * @tparam StatusCode is an enum class listing all the possible errors/malfunctioning (hardware related) for that particular peripheral. Must contain Reset and Ready
+ * @tparam MandatoryParameters Bitmask of the labels that have to be set before the peripheral is initialized
+ * @tparam ParametersLabels Labels of the parameters, with the trailing __length member
+ * @tparam Parameters Types of the parameters
  */
-
-
-template<
-    typename StatusCode,
-    template<typename, typename...>class MembersContainer,
-    typename ParametersLabels, 
-    typename Parameters, 
-    typename Functions, 
-    typename NumberOfMandatoryParameters
-    >
-class PeripheralBase; 
-
-template<
-    EnumType StatusCode, 
-    template<EnumType, typename...>class MembersContainer,
-    EnumType ParameterLabels, 
-    typename... Parameters, 
-    typename... Functions, 
-    std::size_t NumberOfMandatoryParameters
-    >
-class PeripheralBase<
-    StatusCode, 
-    MembersContainer, 
-    ParameterLabels, 
-    MembersContainer<ParameterLabels, Parameters...>, 
-    MembersContainer<ParameterLabels, Functions...>, 
-    std::array<uint8_t, NumberOfMandatoryParameters>
-    >
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+class PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>
 {
     public:
-        //<----------------------------------------------Public constructors---------------------------------------------->//
-        virtual ~PeripheralBase();
-        //<---------------------------------------------------------------------------------------------------------->//
-
-    protected:
 
-        using PeripheralBaseType = PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters> >;
-        using FunctionsContainerType = MembersContainer<ParameterLabels, StatusCode(*)(const Parameters&, PeripheralBaseType*) ...>;
+        using ParametersContainerType = FlatContainer<ParametersLabels, Parameters...>;
+        using ConfigFunctionsType = FlatContainer<ParametersLabels, StatusCode(*)(const Parameters&, Derived&)...>;
         using ConfigFunctionsResponseType = std::array<StatusCode, sizeof...(Parameters)>;
+        using ParametersMaskType = ContainerMask<sizeof...(Parameters)>;
+
+    protected:
 
         //<---------------------------------------------- constructors---------------------------------------------->//
-        constexpr explicit PeripheralBase();
+        constexpr PeripheralBase() = default;
         constexpr explicit PeripheralBase(const Parameters&... initialValues);
 
-        constexpr explicit PeripheralBase(const PeripheralBase& other);
-        constexpr explicit PeripheralBase(PeripheralBase &&other);
-
         //<---------------------------------------------- Getter methods ---------------------------------------------->//
-        bool isResetOrReady();
-        StatusCode getStatus();
+        bool isResetOrReady() const;
+        StatusCode getStatus() const { return status; }
 
-        template<ParameterLabels Parameter>
-        auto&& getParameterValue();
+        template<ParametersLabels Parameter>
+        constexpr const auto& getParameterValue() const { return parameters.template getMemberValue<Parameter>(); }
         //<---------------------------------------------------------------------------------------------------------->//
 
 
         //<---------------------------------------------- Setter methods ---------------------------------------------->//
-        void setStatus(const StatusCode& status);
+        void setStatus(const StatusCode& status) { this->status = status; }
 
-        void setAllParametersValue(Parameters&&... parameters);
+        constexpr void setAllParametersValue(const Parameters&... parameters);
 
-        template<ParameterLabels Param, typename Value>
-        void setParameterValue(const Value& value);
+        template<ParametersLabels Param, typename Value>
+        constexpr void setParameterValue(const Value& value);
 
         template<typename... Args>
-        void setParametersValues(const Args&... args);
+        constexpr void setParametersValues(const Args&... args);
         //<---------------------------------------------------------------------------------------------------------->//
 
-
         //<---------------------------------------------- Utility methods ---------------------------------------------->//
 
         template<typename T>
-        constexpr bool assertArgumentType();
+        static constexpr bool assertArgumentType() { return ParametersContainerType::template isTypeIn<T>().any(); }
 
         template<typename T>
-        constexpr std::vector<uint8_t> isValueSet(const T& value);
+        constexpr ContainerMask<sizeof...(Parameters)> isValueSet(const T& value) const { return parameters.isTypeAndValueIn(value); }
 
         template<typename T>
-        constexpr bool isValueSetBool(const T& value);
+        constexpr bool isValueSetBool(const T& value) const { return isValueSet<T>(value).any(); }
+
+        constexpr bool areMandatoryParametersSet() const { return (setParameters & mandatoryParametersMask) == mandatoryParametersMask; }
+        constexpr ParametersMaskType getDirtyParameters() const { return dirtyParameters; }
+        template<ParametersLabels Parameter>
+        constexpr bool isParameterDirty() const { return dirtyParameters.test(static_cast<std::size_t>(Parameter)); }
+        // Forces the next init to run every config function, e.g. after the peripheral went through a reset
+        constexpr void setAllParametersDirty() { dirtyParameters = allParametersMask; }
+        // For config functions whose change invalidates what other parameters wrote (a pin moving to another port)
+        constexpr void setParametersDirty(const ParametersMaskType& dependents) { dirtyParameters = dirtyParameters | dependents; }
         //<---------------------------------------------------------------------------------------------------------->//
 
         //<---------------------------------------------- Hardware initialization methods --------------------------->//
         ConfigFunctionsResponseType init();
-        //template<std::size_t
 
+        template<ParametersLabels Parameter>
+        StatusCode invokeConfigFunction();
         //<---------------------------------------------------------------------------------------------------------->//
 
-        //Children-accessible class members
-        void setParameterAsMandatory(const ParameterLabels& parameter);
+        static constexpr std::size_t numberOfProperties { sizeof...(Parameters) };
+        static constexpr std::size_t mandatoryParameters { MandatoryParameters };
 
     private:
 
-        //<---------------------------------------------------------------------------------------------------------->//
-
-        template<std::size_t I = 0>
-        constexpr StatusCode invokeAllConfigFunctionsHelper(std::array<StatusCode, sizeof...(Parameters)>& v);
+        static_assert(MandatoryParameters < (std::size_t{0x1U} << sizeof...(Parameters)), "[mandatory parameter out of the labels]");
 
-        template<std::size_t I>
-        constexpr StatusCode invokeConfigFunction();
+        static constexpr ParametersMaskType allParametersMask { static_cast<uint32_t>((std::size_t{0x1U} << sizeof...(Parameters)) - 1U) };
+        static constexpr ParametersMaskType mandatoryParametersMask { static_cast<uint32_t>(MandatoryParameters) };
 
-        template<ParameterLabels Parameter>
-        constexpr StatusCode invokeConfigFunction();
+        template<std::size_t Index>
+        StatusCode initParameter();
 
-        constexpr ConfigFunctionsResponseType invokeAllConfigFunctions();
-        //<---------------------------------------------------------------------------------------------------------->//
+        StatusCode status { StatusCode::Reset };
+        ParametersContainerType parameters {};
+        ParametersMaskType dirtyParameters { allParametersMask };
+        // Parameters given a value through a setter since construction
+        ParametersMaskType setParameters {};
+};
 
-        //<-------------------------------------------- Pure virtual methods --------------------------------------->//
-        //virtual void setDefaultSettings() = 0;
-        //<---------------------------------------------------------------------------------------------------------->//
 
-        static const constexpr std::size_t numberOfProperties { sizeof...(Parameters) };
-        static StaticManager<PeripheralBaseType> staticManager;
-        constexpr static FunctionsContainerType *const functions { nullptr };
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+constexpr PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::PeripheralBase(const Parameters&... initialValues)
+    : parameters{ initialValues... }
+{
+}
 
-        StatusCode status { StatusCode::Reset };
-        MembersContainer<ParameterLabels, Parameters...>*const parameters { nullptr };
-};
-//PeripheralBase<StatusCode, MembersContainer, ParameterLabels, Container<ParameterLabels, Parameters...>, Container<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters> >
-template<EnumType StatusCode, template<EnumType, typename...>class MembersContainer, EnumType ParameterLabels, typename... Parameters, typename... Functions, std::size_t NumberOfMandatoryParameters>
-StaticManager<PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters> >> PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters>>::staticManager{0};
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+inline bool PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::isResetOrReady() const
+{
+    return status == StatusCode::Ready || status == StatusCode::Reset;
+}
 
-//template<EnumType StatusCode, template<EnumType, typename...>class MembersContainer, EnumType ParameterLabels, typename... Parameters, typename... Functions, std::size_t NumberOfMandatoryParameters>
-//MembersContainer<ParameterLabels, StatusCode(*)(const Parameters&, PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters> >*) ...> PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters>>::
+/** @brief Sets every parameter. Only the ones whose value changes become dirty */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+constexpr void PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::setAllParametersValue(const Parameters&... values)
+{
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        (setParameterValue<static_cast<ParametersLabels>(Indices)>(values), ...);
+    }(std::index_sequence_for<Parameters...>{});
+}
 
-template<EnumType StatusCode, template<EnumType, typename...>class MembersContainer, EnumType ParameterLabels, typename... Parameters, typename... Functions, std::size_t NumberOfMandatoryParameters>
-constexpr PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters>>::PeripheralBase()
+/** @brief Sets Param, marking it dirty if its value changes */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+template<ParametersLabels Param, typename Value>
+constexpr void PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::setParameterValue(const Value& value)
 {
-    if constexpr (this->functions==nullptr)
-        this = new MembersContainer<ParameterLabels, Parameters...>();    
+    auto& parameter = parameters.template getMemberValue<Param>();
+    setParameters.set(static_cast<std::size_t>(Param));
+    if(parameter != value)
+    {
+        parameter = value;
+        dirtyParameters.set(static_cast<std::size_t>(Param));
+    }
 }
 
+/** @brief Every parameter of the type of one of args takes its value. The ones that already held it stay clean */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+template<typename... Args>
+constexpr void PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::setParametersValues(const Args&... args)
+{
+    const ParametersMaskType assigned { (ParametersMaskType{} | ... | ParametersContainerType::template isTypeIn<Args>()) };
+    const ParametersMaskType unchanged { (ParametersMaskType{} | ... | parameters.isTypeAndValueIn(args)) };
+    parameters.setMembersValues(args...);
+    setParameters = setParameters | assigned;
+    dirtyParameters = dirtyParameters | ParametersMaskType{ assigned.bits & ~unchanged.bits };
+}
 
-//template<EnumType StatusCode, template<EnumType, typename...>class MembersContainer, EnumType ParameterLabels, typename... Parameters, typename... Functions, std::size_t NumberOfMandatoryParameters>
-//constexpr PeripheralBase<StatusCode, MembersContainer, ParameterLabels, MembersContainer<ParameterLabels, Parameters...>, MembersContainer<ParameterLabels, Functions...>, std::array<uint8_t, NumberOfMandatoryParameters>>::PeripheralBase()
+/**
+ * @brief Runs the configuration function of every dirty parameter, in label order, and returns their status codes.
+ * Clean parameters report Ready. Nothing runs, and every entry is Reset, while a mandatory parameter is not set
+ */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+inline auto PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::init() -> ConfigFunctionsResponseType
+{
+    ConfigFunctionsResponseType responses;
+    if(!areMandatoryParametersSet())
+    {
+        responses.fill(StatusCode::Reset);
+        return responses;
+    }
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        ((responses[Indices] = initParameter<Indices>()), ...);
+    }(std::index_sequence_for<Parameters...>{});
+    return responses;
+}
 
+/** @brief Direct call of the configuration function of Parameter, resolved from Derived::getConfigFunctions at compile time */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+template<ParametersLabels Parameter>
+inline StatusCode PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::invokeConfigFunction()
+{
+    constexpr auto configFunction = Derived::getConfigFunctions().template getMemberValue<Parameter>();
+    static_assert(configFunction != nullptr, "[missing configuration function]");
+    return configFunction(parameters.template getMemberValue<Parameter>(), static_cast<Derived&>(*this));
+}
 
+/** @brief Config function of a dirty parameter. It stays dirty if the function fails, so the next init retries it */
+template<typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
+template<std::size_t Index>
+inline StatusCode PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>::initParameter()
+{
+    if(!dirtyParameters.test(Index))
+        return StatusCode::Ready;
+    const StatusCode response = invokeConfigFunction<static_cast<ParametersLabels>(Index)>();
+    if(response == StatusCode::Ready)
+        dirtyParameters.bits &= ~(0x1U << Index);
+    return response;
+}
 
 
-#endif // __PERIPHERALBASE_H__
\ No newline at end of file
+#endif // __PERIPHERALBASE_H__
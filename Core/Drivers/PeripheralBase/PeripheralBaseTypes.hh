@@ -4,6 +4,48 @@
 #include <system.h>
 #include <stdint.h>
 
+/**
+ * @brief Resolves the register block of a memory mapped peripheral from its base address.
+ * Drivers take it as a template template parameter so the register block can be swapped
+ * (e.g. by a host-side simulation) without touching the driver code.
+ *
+ * @tparam Peripheral CMSIS register layout of the peripheral (GPIO_TypeDef, RCC_TypeDef, ...)
+ * @tparam BaseAddress Base address of the peripheral instance as defined in stm32f411xe.h
+ */
+template<typename Peripheral, uint32_t BaseAddress>
+struct PeripheralRegisters
+{
+#ifdef HOST_SIMULATION
+    static Peripheral* get() { return HostPeripheral<Peripheral, BaseAddress>::get(); }
+#else
+    static Peripheral* get() { return reinterpret_cast<Peripheral*>(static_cast<uintptr_t>(BaseAddress)); }
+#endif
+};
 
+/**
+ * @brief Register block of the instance at a base address only known at run time. nullptr, on the host, for an
+ * instance that is not simulated
+ */
+template<typename Peripheral>
+inline Peripheral* getPeripheralInstance(const uintptr_t& baseAddress)
+{
+#ifdef HOST_SIMULATION
+    return HostPeripherals::find<Peripheral>(baseAddress);
+#else
+    return reinterpret_cast<Peripheral*>(baseAddress);
+#endif
+}
 
-#endif // __PERIPHERALBASETYPES_H__
\ No newline at end of file
+
+/** @brief Address of an object as the bus masters (DMA) see it. Host builds hand out a mapped 32-bit stand-in */
+inline uint32_t getBusAddress(const volatile void* address)
+{
+#ifdef HOST_SIMULATION
+    return HostBusAddresses::map(address);
+#else
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(address));
+#endif
+}
+
+
+#endif // __PERIPHERALBASETYPES_H__
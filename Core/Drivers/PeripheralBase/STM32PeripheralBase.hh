@@ -3,15 +3,16 @@
 
 #include <system.h>
 #include <PeripheralBase.hh>
+#include <ShadowRegisters.hh>
 #include <GeneralConcepts.hh>
+#include <tuple>
 
-#ifdef COMPILE 
 template <typename Instance>
 struct PeripheralMap;
 
 template <>
 struct PeripheralMap<GPIO_TypeDef> {
-    static auto instances() 
+    static auto instances()
     {
         return std::make_tuple(GPIOA, GPIOB, GPIOC, GPIOD, GPIOE, GPIOH);
     }
@@ -21,7 +22,7 @@ template <>
 struct PeripheralMap<USART_TypeDef> {
     static auto instances()
     {
-        std::make_tuple(USART1, USART2, USART6);
+        return std::make_tuple(USART1, USART2, USART6);
     }
 };
 
@@ -29,75 +30,119 @@ template <>
 struct PeripheralMap<RCC_TypeDef> {
     static auto instances()
     {
-        std::make_tuple(RCC);
+        return std::make_tuple(RCC);
     }
 };
 
+template <>
+struct PeripheralMap<DMA_Stream_TypeDef> {
+    static auto instances()
+    {
+        return std::make_tuple(DMA1_Stream0, DMA1_Stream1, DMA1_Stream2, DMA1_Stream3, DMA1_Stream4, DMA1_Stream5, DMA1_Stream6, DMA1_Stream7,
+                               DMA2_Stream0, DMA2_Stream1, DMA2_Stream2, DMA2_Stream3, DMA2_Stream4, DMA2_Stream5, DMA2_Stream6, DMA2_Stream7);
+    }
+};
 
-template<STM32Peripheral Instance, typename BaseClass>
+
+/**
+ * @brief Peripheral driver bound to a register block of Instance
+ *
+ * @tparam Shadow Registers kept in RAM (ShadowRegisters<Instance, offsets...>). By default none: every access goes to
+ * the peripheral
+ */
+template<STM32Peripheral Instance, typename BaseClass, typename Shadow = ShadowRegisters<Instance>>
 class STM32PeripheralBase;
 
 
-template<STM32Peripheral  Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-class STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>> : public PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>
+template<STM32Peripheral Instance, typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters, std::size_t... ShadowOffsets>
+class STM32PeripheralBase<Instance, PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>, ShadowRegisters<Instance, ShadowOffsets...>>
+    : public PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>
 {
-    public:
-        virtual ~STM32PeripheralBase();
-
     protected:
 
-        using PeripheralBaseParentType = PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>;
-        using STM32PeripheralBaseType = STM32PeripheralBase<Instance, PeripheralBaseParentType>;
+        using PeripheralBaseParentType = PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>;
+        using ShadowRegistersType = ShadowRegisters<Instance, ShadowOffsets...>;
+        using STM32PeripheralBaseType = STM32PeripheralBase<Instance, PeripheralBaseParentType, ShadowRegistersType>;
 
         //<---------------------------------------------- constructors---------------------------------------------->//
-        template<typename... Functions>
-        constexpr explicit STM32PeripheralBase(const Container<ParametersLabels, Functions...>& functions);
+        constexpr STM32PeripheralBase() = default;
+        constexpr explicit STM32PeripheralBase(const Parameters&... initialValues) : PeripheralBaseParentType(initialValues...) { }
+
+        // Only the instances listed in PeripheralMap<Instance> are accepted. Pending shadow writes reach the former
+        // instance before the copies are reloaded from the new one
+        bool setInstancePtr(Instance* peripheral);
 
-        constexpr explicit STM32PeripheralBase(const STM32PeripheralBase& other);
-        constexpr explicit STM32PeripheralBase(STM32PeripheralBase &&other);
+        // Register accesses by offset in Instance (offsetof). Shadowed registers are served from RAM, loaded on first
+        // use, and only reach the peripheral on flushShadowRegisters; any other register is accessed directly
+        template<std::size_t Offset>
+        uint32_t readRegister();
+        template<std::size_t Offset>
+        void writeRegister(const uint32_t& value);
+        template<std::size_t Offset>
+        void modifyRegister(const uint32_t& clearMask, const uint32_t& setMask);
+
+        void loadShadowRegisters() { shadowRegisters.load(instance); }
+        void flushShadowRegisters() { shadowRegisters.flush(instance); }
 
         //Children-accessible class members
         Instance* instance { nullptr };
 
     private:
 
-        void setInstancePtr(const Instance& peripheral);  
-
-        virtual void setDefaultSettings() = 0;
+        [[no_unique_address]] ShadowRegistersType shadowRegisters {};
 };
 
-template <STM32Peripheral Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-template <typename... Functions>
-inline constexpr STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>>::STM32PeripheralBase(const Container<ParametersLabels, Functions...> &functions)
-    : PeripheralBaseParentType(functions)
+template<STM32Peripheral Instance, typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters, std::size_t... ShadowOffsets>
+inline bool STM32PeripheralBase<Instance, PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>, ShadowRegisters<Instance, ShadowOffsets...>>::setInstancePtr(Instance* peripheral)
 {
+    const bool known = std::apply([peripheral](auto... instances) { return ((instances == peripheral) || ...); }, PeripheralMap<Instance>::instances());
+    if(known && peripheral != instance)
+    {
+        if constexpr(ShadowRegistersType::numberOfRegisters != 0)
+        {
+            if(instance != nullptr && shadowRegisters.isDirty())
+                flushShadowRegisters();
+        }
+        this->instance = peripheral;
+        if constexpr(ShadowRegistersType::numberOfRegisters != 0)
+            loadShadowRegisters();
+    }
+    return known;
 }
 
-template <STM32Peripheral Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-inline STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>>::~STM32PeripheralBase()
-{
-    instance = nullptr;
-}
-
-template <STM32Peripheral Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-inline constexpr STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>>::STM32PeripheralBase(const STM32PeripheralBase &other)
+template<STM32Peripheral Instance, typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters, std::size_t... ShadowOffsets>
+template<std::size_t Offset>
+inline uint32_t STM32PeripheralBase<Instance, PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>, ShadowRegisters<Instance, ShadowOffsets...>>::readRegister()
 {
+    if constexpr(ShadowRegistersType::template isShadowed<Offset>())
+    {
+        if(!shadowRegisters.isLoaded())
+            loadShadowRegisters();
+        return shadowRegisters.template read<Offset>();
+    }
+    else
+        return getPeripheralRegister<Offset>(instance);
 }
 
-template <STM32Peripheral Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-inline constexpr STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>>::STM32PeripheralBase(STM32PeripheralBase &&other)
+template<STM32Peripheral Instance, typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters, std::size_t... ShadowOffsets>
+template<std::size_t Offset>
+inline void STM32PeripheralBase<Instance, PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>, ShadowRegisters<Instance, ShadowOffsets...>>::writeRegister(const uint32_t& value)
 {
+    if constexpr(ShadowRegistersType::template isShadowed<Offset>())
+    {
+        if(!shadowRegisters.isLoaded())
+            loadShadowRegisters();
+        shadowRegisters.template write<Offset>(value);
+    }
+    else
+        getPeripheralRegister<Offset>(instance) = value;
 }
 
-template <STM32Peripheral Instance, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters>
-inline void STM32PeripheralBase<Instance, PeripheralBase<StatusCode, MandatoryParameters, Container<ParametersLabels, Parameters...>>>::setInstancePtr(const Instance &peripheral)
+template<STM32Peripheral Instance, typename Derived, EnumType StatusCode, std::size_t MandatoryParameters, EnumType ParametersLabels, typename... Parameters, std::size_t... ShadowOffsets>
+template<std::size_t Offset>
+inline void STM32PeripheralBase<Instance, PeripheralBase<Derived, StatusCode, MandatoryParameters, FlatContainer<ParametersLabels, Parameters...>>, ShadowRegisters<Instance, ShadowOffsets...>>::modifyRegister(const uint32_t& clearMask, const uint32_t& setMask)
 {
-    constexpr auto instances = PeripheralMap<Instance>::instances();
-    std::apply([this, &peripheral](auto&&... instance) {
-        ((instance == peripheral ? this->instance = instance : false), ...);
-    }, instances);
+    writeRegister<Offset>((readRegister<Offset>() & ~clearMask) | setMask);
 }
 
-#endif
-
-#endif  // __S_T_M32_PERIPHERAL_BASE_HH_95TIBHUKGW20__
\ No newline at end of file
+#endif  // __S_T_M32_PERIPHERAL_BASE_HH_95TIBHUKGW20__
@@ -0,0 +1,139 @@
+#ifndef __SHADOWREGISTERS_H__
+#define __SHADOWREGISTERS_H__
+
+/**
+ * @file ShadowRegisters.hh
+ * @brief RAM copies of configuration registers. A shadowed register is read once from the peripheral; reads and
+ * read-modify-writes are then served from SRAM, and the registers modified since are written back in one burst by
+ * flush. Only registers the peripheral never changes on its own may be shadowed (configuration, not status or data).
+ */
+
+#include <GeneralConcepts.hh>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/** @brief The 32-bit register at byte Offset of the peripheral instance */
+template<std::size_t Offset, STM32Peripheral Instance>
+inline volatile uint32_t& getPeripheralRegister(Instance* instance)
+{
+    return *reinterpret_cast<volatile uint32_t*>(reinterpret_cast<uintptr_t>(instance) + Offset);
+}
+
+template<std::size_t Offset, STM32Peripheral Instance>
+inline const volatile uint32_t& getPeripheralRegister(const Instance* instance)
+{
+    return *reinterpret_cast<const volatile uint32_t*>(reinterpret_cast<uintptr_t>(instance) + Offset);
+}
+
+/**
+ * @brief Shadow copies of a set of registers of Instance
+ *
+ * @tparam Instance CMSIS register layout of the peripheral
+ * @tparam Offsets Byte offset of every shadowed register in Instance, e.g. offsetof(GPIO_TypeDef, MODER). Registers
+ * are flushed in this order
+ */
+template<STM32Peripheral Instance, std::size_t... Offsets>
+class ShadowRegisters
+{
+    public:
+
+        static constexpr std::size_t numberOfRegisters { sizeof...(Offsets) };
+
+        template<std::size_t Offset>
+        static constexpr bool isShadowed() { return ((Offset == Offsets) || ...); }
+
+        void load(const Instance* instance);
+        void flush(Instance* instance);
+
+        template<std::size_t Offset>
+        uint32_t read() const { return values[getIndex<Offset>()]; }
+        template<std::size_t Offset>
+        void write(const uint32_t& value);
+        template<std::size_t Offset>
+        void modify(const uint32_t& clearMask, const uint32_t& setMask) { write<Offset>((read<Offset>() & ~clearMask) | setMask); }
+
+        bool isLoaded() const { return loaded; }
+        bool isDirty() const { return dirty != 0; }
+
+    private:
+
+        static_assert(numberOfRegisters <= 32, "[at most 32 shadowed registers]");
+        static_assert(((Offsets % sizeof(uint32_t) == 0 && Offsets < sizeof(Instance)) && ...), "[offset is not a register of the peripheral]");
+
+        template<std::size_t Offset>
+        static constexpr std::size_t getIndex();
+
+        std::array<uint32_t, numberOfRegisters> values {};
+        uint32_t dirty { 0 };
+        bool loaded { false };
+};
+
+/** @brief No shadowed register: every access goes to the peripheral, and the layer takes no room */
+template<STM32Peripheral Instance>
+class ShadowRegisters<Instance>
+{
+    public:
+
+        static constexpr std::size_t numberOfRegisters { 0 };
+
+        template<std::size_t Offset>
+        static constexpr bool isShadowed() { return false; }
+
+        void load(const Instance*) { }
+        void flush(Instance*) { }
+
+        bool isLoaded() const { return true; }
+        bool isDirty() const { return false; }
+};
+
+/** @brief Fills every copy from the peripheral. Pending writes are dropped */
+template<STM32Peripheral Instance, std::size_t... Offsets>
+inline void ShadowRegisters<Instance, Offsets...>::load(const Instance* instance)
+{
+    std::size_t index { 0 };
+    ((values[index++] = getPeripheralRegister<Offsets>(instance)), ...);
+    dirty = 0;
+    loaded = true;
+}
+
+/** @brief Writes every copy modified since the last load or flush, one store each, in declaration order */
+template<STM32Peripheral Instance, std::size_t... Offsets>
+inline void ShadowRegisters<Instance, Offsets...>::flush(Instance* instance)
+{
+    std::size_t index { 0 };
+    ([&]()
+    {
+        if(dirty & (0x1U << index))
+            getPeripheralRegister<Offsets>(instance) = values[index];
+        ++index;
+    }(), ...);
+    dirty = 0;
+}
+
+template<STM32Peripheral Instance, std::size_t... Offsets>
+template<std::size_t Offset>
+inline void ShadowRegisters<Instance, Offsets...>::write(const uint32_t& value)
+{
+    constexpr std::size_t index { getIndex<Offset>() };
+    if(values[index] != value)
+    {
+        values[index] = value;
+        dirty |= 0x1U << index;
+    }
+}
+
+template<STM32Peripheral Instance, std::size_t... Offsets>
+template<std::size_t Offset>
+constexpr std::size_t ShadowRegisters<Instance, Offsets...>::getIndex()
+{
+    static_assert(isShadowed<Offset>(), "[register is not shadowed]");
+    constexpr std::array<std::size_t, numberOfRegisters> offsets { Offsets... };
+    std::size_t index { 0 };
+    while(offsets[index] != Offset)
+        ++index;
+    return index;
+}
+
+
+#endif // __SHADOWREGISTERS_H__
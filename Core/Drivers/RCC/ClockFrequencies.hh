@@ -0,0 +1,136 @@
+#ifndef __CLOCKFREQUENCIES_H__
+#define __CLOCKFREQUENCIES_H__
+
+/**
+ * @file ClockFrequencies.hh
+ * @brief Bus and timer frequencies of a clock tree, as a literal type drivers take as a template argument.
+ * Prescalers, reload values and baud-rate divisors derived from it are computed by the compiler, and a rate that
+ * can not be produced from the bus clock is a static_assert failure instead of a runtime division.
+ */
+
+#include <ClockTree.hh>
+#include <PeripheralClocks.hh>
+
+struct ClockFrequencies
+{
+    uint32_t sysclk { HSI_FREQUENCY };
+    uint32_t hclk { HSI_FREQUENCY };
+    uint32_t pclk1 { HSI_FREQUENCY };
+    uint32_t pclk2 { HSI_FREQUENCY };
+    uint32_t timerClock1 { HSI_FREQUENCY };     // TIM2..TIM5
+    uint32_t timerClock2 { HSI_FREQUENCY };     // TIM1, TIM9..TIM11
+
+    /** @brief Clock of the peripherals attached to bridge */
+    constexpr uint32_t getBusFrequency(const PeripheralBridges& bridge) const
+    {
+        switch(bridge)
+        {
+            case PeripheralBridges::APB1: return pclk1;
+            case PeripheralBridges::APB2: return pclk2;
+            default: return hclk;
+        }
+    }
+
+    /** @brief Counter clock of the timers attached to bridge */
+    constexpr uint32_t getTimerFrequency(const PeripheralBridges& bridge) const
+    {
+        return bridge == PeripheralBridges::APB1 ? timerClock1 : timerClock2;
+    }
+};
+
+/**
+ * @brief Frequencies produced by solved settings. The timers of an APB bus run at twice its clock when the bus is
+ * divided (RCC_DCKCFGR TIMPRE = 0)
+ */
+constexpr ClockFrequencies getClockFrequencies(const ClockTreeSettings& settings)
+{
+    return ClockFrequencies
+    {
+        .sysclk = settings.sysclk,
+        .hclk = settings.hclk,
+        .pclk1 = settings.pclk1,
+        .pclk2 = settings.pclk2,
+        .timerClock1 = settings.pclk1 == settings.hclk ? settings.pclk1 : 2U * settings.pclk1,
+        .timerClock2 = settings.pclk2 == settings.hclk ? settings.pclk2 : 2U * settings.pclk2,
+    };
+}
+
+template<ClockConfiguration Configuration>
+    requires (clockTreeSettings<Configuration>.isValid)
+constexpr ClockFrequencies clockFrequencies { getClockFrequencies(clockTreeSettings<Configuration>) };
+
+
+/**
+ * @brief PSC/ARR pair of a timer update rate
+ */
+struct TimerTiming
+{
+    bool isValid { false };
+    uint16_t prescaler { 0 };
+    uint32_t autoReload { 0 };
+};
+
+/**
+ * @brief Smallest prescaler (finest resolution) that produces exactly frequency updates per second from timerClock.
+ * maxAutoReload is 0xFFFF for the 16-bit timers and 0xFFFFFFFF for TIM2/TIM5
+ */
+constexpr TimerTiming getTimerTiming(const uint32_t& timerClock, const uint32_t& frequency, const uint32_t& maxAutoReload = 0xFFFFU)
+{
+    if(frequency == 0 || timerClock % frequency)
+        return TimerTiming{};
+    const uint32_t ticks = timerClock / frequency;
+    for(uint32_t divider = 1; divider <= 0x10000U; ++divider)
+    {
+        if(ticks % divider)
+            continue;
+        const uint32_t period = ticks / divider;
+        // The counter is blocked with a null auto-reload value, so a period of at least 2 ticks is needed
+        if(period < 2U)
+            break;
+        if(period - 1U <= maxAutoReload)
+            return TimerTiming{ true, static_cast<uint16_t>(divider - 1U), period - 1U };
+    }
+    return TimerTiming{};
+}
+
+
+/**
+ * @brief BRR value of a USART baud rate
+ */
+struct UsartDivider
+{
+    bool isValid { false };
+    uint16_t brr { 0 };
+    uint32_t baudRate { 0 };     // produced exactly by brr
+    uint32_t errorPpm { 0 };     // of baudRate against the requested one
+};
+
+/**
+ * @brief Divider closest to baudRate from busClock (RM0383 19.3.4). USARTDIV = busClock / (8 * (2 - OVER8) * baud),
+ * in 12.4 fixed point with oversampling by 16 and in 12.3 (BRR[3] kept clear) with oversampling by 8: either way
+ * the rounded busClock / baud in 1/16ths or 1/8ths of the mantissa
+ */
+constexpr UsartDivider getUsartDivider(const uint32_t& busClock, const uint32_t& baudRate, const bool& over8 = false)
+{
+    if(baudRate == 0)
+        return UsartDivider{};
+    const uint32_t fractionBits = over8 ? 3U : 4U;
+    const uint64_t divider = (static_cast<uint64_t>(busClock) + baudRate / 2U) / baudRate;
+    // The mantissa is 12 bits and can not be 0
+    if(divider < (1U << fractionBits) || (divider >> fractionBits) > 0xFFFU)
+        return UsartDivider{};
+
+    const uint64_t produced = divider * baudRate;
+    const uint64_t error = produced > busClock ? produced - busClock : busClock - produced;
+    const uint32_t brr = over8 ? static_cast<uint32_t>(((divider >> 3U) << 4U) | (divider & 0x7U)) : static_cast<uint32_t>(divider);
+    return UsartDivider
+    {
+        .isValid = true,
+        .brr = static_cast<uint16_t>(brr),
+        .baudRate = static_cast<uint32_t>((busClock + divider / 2U) / divider),
+        .errorPpm = static_cast<uint32_t>((error * 1000000U + produced / 2U) / produced),
+    };
+}
+
+
+#endif // __CLOCKFREQUENCIES_H__
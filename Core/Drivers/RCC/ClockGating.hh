@@ -0,0 +1,234 @@
+#ifndef __CLOCKGATING_H__
+#define __CLOCKGATING_H__
+
+/**
+ * @file ClockGating.hh
+ * @brief Batched peripheral clock gating. A set of peripherals of any of the four bridges is folded by the compiler
+ * into one bit mask per RCC register, so enabling N peripherals costs at most one read-modify-write per bridge and a
+ * single read-back, instead of N read-modify-writes each followed by its own delay.
+ */
+
+#include <PeripheralClocks.hh>
+#include <PeripheralBaseTypes.hh>
+
+/** @brief One bit mask per bridge, laid out as the AHB1/AHB2/APB1/APB2 ENR, LPENR and RSTR registers */
+struct PeripheralClockMask
+{
+    uint32_t ahb1 { 0 };
+    uint32_t ahb2 { 0 };
+    uint32_t apb1 { 0 };
+    uint32_t apb2 { 0 };
+
+    constexpr PeripheralClockMask operator|(const PeripheralClockMask& other) const
+    {
+        return PeripheralClockMask{ ahb1 | other.ahb1, ahb2 | other.ahb2, apb1 | other.apb1, apb2 | other.apb2 };
+    }
+    constexpr bool isEmpty() const { return !(ahb1 | ahb2 | apb1 | apb2); }
+    constexpr bool operator==(const PeripheralClockMask&) const = default;
+};
+
+constexpr PeripheralClockMask getPeripheralClockMask(const AHB1BridgePeripherals& peripheral) { return PeripheralClockMask{ .ahb1 = 0x1U << static_cast<uint32_t>(peripheral) }; }
+constexpr PeripheralClockMask getPeripheralClockMask(const AHB2BridgePeripherals& peripheral) { return PeripheralClockMask{ .ahb2 = 0x1U << static_cast<uint32_t>(peripheral) }; }
+constexpr PeripheralClockMask getPeripheralClockMask(const APB1BridgePeripherals& peripheral) { return PeripheralClockMask{ .apb1 = 0x1U << static_cast<uint32_t>(peripheral) }; }
+constexpr PeripheralClockMask getPeripheralClockMask(const APB2BridgePeripherals& peripheral) { return PeripheralClockMask{ .apb2 = 0x1U << static_cast<uint32_t>(peripheral) }; }
+
+template<auto... Peripherals>
+    requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+constexpr PeripheralClockMask peripheralClockMask { (PeripheralClockMask{} | ... | getPeripheralClockMask(Peripherals)) };
+
+/**
+ * @brief Clock gating of sets of peripherals. Registers of a bridge without peripheral in the set are not accessed
+ *
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PeripheralClockGate
+{
+    public:
+
+        template<auto... Peripherals> requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+        static void enable() { enable<peripheralClockMask<Peripherals...>>(); }
+        template<auto... Peripherals> requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+        static void disable() { disable<peripheralClockMask<Peripherals...>>(); }
+        template<auto... Peripherals> requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+        static void enableLowPowerMode() { enableLowPowerMode<peripheralClockMask<Peripherals...>>(); }
+        template<auto... Peripherals> requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+        static void disableLowPowerMode() { disableLowPowerMode<peripheralClockMask<Peripherals...>>(); }
+        template<auto... Peripherals> requires (AnyOfPeripheralsBridge<decltype(Peripherals)> && ...)
+        static void reset() { reset<peripheralClockMask<Peripherals...>>(); }
+
+        template<PeripheralClockMask Mask>
+        static void enable();
+        template<PeripheralClockMask Mask>
+        static void disable();
+        template<PeripheralClockMask Mask>
+        static void enableLowPowerMode();
+        template<PeripheralClockMask Mask>
+        static void disableLowPowerMode();
+        template<PeripheralClockMask Mask>
+        static void reset();
+
+        // Run-time sets: one read-modify-write per bridge with bits in mask
+        static void enable(const PeripheralClockMask& mask);
+        static void disable(const PeripheralClockMask& mask);
+
+        /** @brief True if the clock of every peripheral of mask is enabled */
+        static bool isEnabled(const PeripheralClockMask& mask);
+
+    private:
+
+        enum class RegisterGroup : uint8_t { enable, lowPowerEnable, reset };
+
+        template<PeripheralClockMask Mask, RegisterGroup Group, bool Set>
+        static void write();
+        template<PeripheralBridges Bridge, uint32_t Bits, RegisterGroup Group, bool Set>
+        static void writeBridge();
+        template<PeripheralBridges Bridge, RegisterGroup Group>
+        static auto& getRegister();
+
+        static auto* getRCC() { return Registers<RCC_TypeDef, RCC_BASE>::get(); }
+};
+
+/**
+ * @brief Enables the clocks of Mask. A read-back of the last register written stalls the core until the stores have
+ * reached the RCC, so every clock of the set is running before the next peripheral access (errata ES0287 2.1.6)
+ */
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask>
+inline void PeripheralClockGate<Registers>::enable()
+{
+    static_assert(!Mask.isEmpty(), "[no peripheral to enable]");
+    write<Mask, RegisterGroup::enable, true>();
+    constexpr PeripheralBridges last { Mask.apb2 ? PeripheralBridges::APB2 : Mask.apb1 ? PeripheralBridges::APB1 : Mask.ahb2 ? PeripheralBridges::AHB2 : PeripheralBridges::AHB1 };
+    static_cast<void>(static_cast<uint32_t>(getRegister<last, RegisterGroup::enable>()));
+}
+
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask>
+inline void PeripheralClockGate<Registers>::disable()
+{
+    write<Mask, RegisterGroup::enable, false>();
+}
+
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask>
+inline void PeripheralClockGate<Registers>::enableLowPowerMode()
+{
+    write<Mask, RegisterGroup::lowPowerEnable, true>();
+}
+
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask>
+inline void PeripheralClockGate<Registers>::disableLowPowerMode()
+{
+    write<Mask, RegisterGroup::lowPowerEnable, false>();
+}
+
+/** @brief Pulses the reset lines of Mask: every peripheral of the set is held in reset at the same time */
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask>
+inline void PeripheralClockGate<Registers>::reset()
+{
+    write<Mask, RegisterGroup::reset, true>();
+    write<Mask, RegisterGroup::reset, false>();
+}
+
+/** @brief Enables the clocks of a set only known at run time, followed by a read-back of the last register written */
+template<template<typename, uint32_t> class Registers>
+inline void PeripheralClockGate<Registers>::enable(const PeripheralClockMask& mask)
+{
+    auto* rcc = getRCC();
+    if(mask.ahb1)
+        rcc->AHB1ENR = static_cast<uint32_t>(rcc->AHB1ENR) | mask.ahb1;
+    if(mask.ahb2)
+        rcc->AHB2ENR = static_cast<uint32_t>(rcc->AHB2ENR) | mask.ahb2;
+    if(mask.apb1)
+        rcc->APB1ENR = static_cast<uint32_t>(rcc->APB1ENR) | mask.apb1;
+    if(mask.apb2)
+        rcc->APB2ENR = static_cast<uint32_t>(rcc->APB2ENR) | mask.apb2;
+
+    if(mask.apb2)
+        static_cast<void>(static_cast<uint32_t>(rcc->APB2ENR));
+    else if(mask.apb1)
+        static_cast<void>(static_cast<uint32_t>(rcc->APB1ENR));
+    else if(mask.ahb2)
+        static_cast<void>(static_cast<uint32_t>(rcc->AHB2ENR));
+    else if(mask.ahb1)
+        static_cast<void>(static_cast<uint32_t>(rcc->AHB1ENR));
+}
+
+template<template<typename, uint32_t> class Registers>
+inline void PeripheralClockGate<Registers>::disable(const PeripheralClockMask& mask)
+{
+    auto* rcc = getRCC();
+    if(mask.ahb1)
+        rcc->AHB1ENR = static_cast<uint32_t>(rcc->AHB1ENR) & ~mask.ahb1;
+    if(mask.ahb2)
+        rcc->AHB2ENR = static_cast<uint32_t>(rcc->AHB2ENR) & ~mask.ahb2;
+    if(mask.apb1)
+        rcc->APB1ENR = static_cast<uint32_t>(rcc->APB1ENR) & ~mask.apb1;
+    if(mask.apb2)
+        rcc->APB2ENR = static_cast<uint32_t>(rcc->APB2ENR) & ~mask.apb2;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline bool PeripheralClockGate<Registers>::isEnabled(const PeripheralClockMask& mask)
+{
+    auto* rcc = getRCC();
+    const uint32_t missing = (mask.ahb1 & ~static_cast<uint32_t>(rcc->AHB1ENR)) | (mask.ahb2 & ~static_cast<uint32_t>(rcc->AHB2ENR))
+                           | (mask.apb1 & ~static_cast<uint32_t>(rcc->APB1ENR)) | (mask.apb2 & ~static_cast<uint32_t>(rcc->APB2ENR));
+    return !missing;
+}
+
+template<template<typename, uint32_t> class Registers>
+template<PeripheralClockMask Mask, typename PeripheralClockGate<Registers>::RegisterGroup Group, bool Set>
+inline void PeripheralClockGate<Registers>::write()
+{
+    writeBridge<PeripheralBridges::AHB1, Mask.ahb1, Group, Set>();
+    writeBridge<PeripheralBridges::AHB2, Mask.ahb2, Group, Set>();
+    writeBridge<PeripheralBridges::APB1, Mask.apb1, Group, Set>();
+    writeBridge<PeripheralBridges::APB2, Mask.apb2, Group, Set>();
+}
+
+/** @brief One read-modify-write of the register of a bridge, or nothing if no bit of the bridge is in the set */
+template<template<typename, uint32_t> class Registers>
+template<PeripheralBridges Bridge, uint32_t Bits, typename PeripheralClockGate<Registers>::RegisterGroup Group, bool Set>
+inline void PeripheralClockGate<Registers>::writeBridge()
+{
+    if constexpr(Bits != 0)
+    {
+        auto& reg = getRegister<Bridge, Group>();
+        if constexpr(Set)
+            reg = static_cast<uint32_t>(reg) | Bits;
+        else
+            reg = static_cast<uint32_t>(reg) & ~Bits;
+    }
+}
+
+template<template<typename, uint32_t> class Registers>
+template<PeripheralBridges Bridge, typename PeripheralClockGate<Registers>::RegisterGroup Group>
+inline auto& PeripheralClockGate<Registers>::getRegister()
+{
+    auto* rcc = getRCC();
+    constexpr bool enableRegister { Group == RegisterGroup::enable };
+    constexpr bool lowPowerRegister { Group == RegisterGroup::lowPowerEnable };
+    if constexpr(Bridge == PeripheralBridges::AHB1)
+    {
+        if constexpr(enableRegister) return rcc->AHB1ENR; else if constexpr(lowPowerRegister) return rcc->AHB1LPENR; else return rcc->AHB1RSTR;
+    }
+    else if constexpr(Bridge == PeripheralBridges::AHB2)
+    {
+        if constexpr(enableRegister) return rcc->AHB2ENR; else if constexpr(lowPowerRegister) return rcc->AHB2LPENR; else return rcc->AHB2RSTR;
+    }
+    else if constexpr(Bridge == PeripheralBridges::APB1)
+    {
+        if constexpr(enableRegister) return rcc->APB1ENR; else if constexpr(lowPowerRegister) return rcc->APB1LPENR; else return rcc->APB1RSTR;
+    }
+    else
+    {
+        if constexpr(enableRegister) return rcc->APB2ENR; else if constexpr(lowPowerRegister) return rcc->APB2LPENR; else return rcc->APB2RSTR;
+    }
+}
+
+
+#endif // __CLOCKGATING_H__
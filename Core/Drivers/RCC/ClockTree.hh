@@ -0,0 +1,478 @@
+#ifndef __CLOCKTREE_H__
+#define __CLOCKTREE_H__
+
+/**
+ * @file ClockTree.hh
+ * @brief System clock configuration of the STM32F411.
+ * The requested frequencies are solved at compile time into PLL dividers, bus prescalers, flash wait states and
+ * regulator scale (RM0383 section 6 and table 6, 2.7 V to 3.6 V supply). A request that the hardware can not
+ * produce exactly is a static_assert failure. At run time only the register sequence is left, with every
+ * oscillator, PLL and switch step polled with a timeout. The flash ART accelerator (instruction cache, data cache
+ * and prefetch buffer) is part of every switch: the caches are flushed and re-enabled with the new wait states.
+ */
+
+#include <RCCTypes.hh>
+#include <PeripheralBaseTypes.hh>
+#include <PeripheralClockHandle.hh>
+
+/**
+ * @brief Requested clock tree. The PLL is used whenever sysclk differs from the source frequency or a 48 MHz USB clock is requested
+ */
+struct ClockConfiguration
+{
+    rccClockSource source { rccClockSource::HSI };     // PLL input, HSI or HSE
+    uint32_t sourceFrequency { HSI_FREQUENCY };
+    uint32_t sysclk { HSI_FREQUENCY };
+    uint32_t hclk { HSI_FREQUENCY };
+    uint32_t pclk1 { HSI_FREQUENCY };
+    uint32_t pclk2 { HSI_FREQUENCY };
+    bool hseBypass { false };                           // HSE driven by an external clock instead of a crystal
+    bool usbClock { false };                            // PLL48CLK has to be exactly 48 MHz
+    bool flashAccelerator { true };                     // Flash instruction/data caches and prefetch (FLASH_ACR ICEN, DCEN, PRFTEN)
+};
+
+/**
+ * @brief Register values that produce a ClockConfiguration
+ */
+struct ClockTreeSettings
+{
+    bool isValid { false };
+    bool usesPLL { false };
+    PLL pll { 0, 0, 0, 0 };
+    uint32_t cfgrPrescalers { 0 };      // HPRE, PPRE1 and PPRE2 fields of RCC_CFGR
+    uint32_t flashLatency { 0 };
+    uint32_t flashAccelerator { 0 };    // ICEN, DCEN and PRFTEN bits of FLASH_ACR
+    uint32_t voltageScale { 0 };        // VOS field of PWR_CR
+    uint32_t sysclk { 0 };
+    uint32_t hclk { 0 };
+    uint32_t pclk1 { 0 };
+    uint32_t pclk2 { 0 };
+    uint32_t pll48clk { 0 };
+};
+
+/** @brief Operating limits of the F411 clock tree */
+struct ClockLimits
+{
+    static constexpr uint32_t maxSysclk { 100000000UL };
+    static constexpr uint32_t maxPclk1 { 50000000UL };
+    static constexpr uint32_t maxPclk2 { 100000000UL };
+    static constexpr uint32_t minHse { 4000000UL };
+    static constexpr uint32_t maxHseCrystal { 26000000UL };
+    static constexpr uint32_t maxHseBypass { 50000000UL };
+    static constexpr uint32_t minPllInput { 1000000UL };
+    static constexpr uint32_t maxPllInput { 2000000UL };
+    static constexpr uint32_t minVco { 100000000UL };
+    static constexpr uint32_t maxVco { 432000000UL };
+    static constexpr uint32_t pll48clk { 48000000UL };
+    static constexpr uint32_t minPllM { 2 };
+    static constexpr uint32_t maxPllM { 63 };
+    static constexpr uint32_t minPllN { 50 };
+    static constexpr uint32_t maxPllN { 432 };
+    static constexpr uint32_t minPllQ { 2 };
+    static constexpr uint32_t maxPllQ { 15 };
+};
+
+constexpr uint32_t invalidPrescaler { 0xFFFFFFFFU };
+
+/**
+ * @brief Main PLL dividers for sysclk, or m = 0 if there are none.
+ * Candidates are tried from the highest VCO input (2 MHz, lowest jitter) and the lowest VCO output (lowest power)
+ */
+constexpr PLL solvePLL(const uint32_t& sourceFrequency, const uint32_t& sysclk, const bool& usbClock)
+{
+    for(uint32_t m = ClockLimits::minPllM; m <= ClockLimits::maxPllM; ++m)
+    {
+        if(sourceFrequency % m)
+            continue;
+        const uint32_t vcoInput = sourceFrequency / m;
+        if(vcoInput < ClockLimits::minPllInput || vcoInput > ClockLimits::maxPllInput)
+            continue;
+
+        for(uint32_t p = 2; p <= 8; p += 2)
+        {
+            const uint64_t vco = static_cast<uint64_t>(sysclk) * p;
+            if(vco < ClockLimits::minVco || vco > ClockLimits::maxVco || vco % vcoInput)
+                continue;
+            const uint32_t n = static_cast<uint32_t>(vco / vcoInput);
+            if(n < ClockLimits::minPllN || n > ClockLimits::maxPllN)
+                continue;
+
+            // Without USB, Q only has to keep PLL48CLK at or below 48 MHz
+            uint32_t q = static_cast<uint32_t>((vco + ClockLimits::pll48clk - 1U) / ClockLimits::pll48clk);
+            if(usbClock && vco % ClockLimits::pll48clk)
+                continue;
+            if(q < ClockLimits::minPllQ)
+                q = ClockLimits::minPllQ;
+            if(q > ClockLimits::maxPllQ)
+                continue;
+            return PLL{ m, n, p, q };
+        }
+    }
+    return PLL{ 0, 0, 0, 0 };
+}
+
+/** @brief HPRE field value for an AHB divider */
+constexpr uint32_t getAHBPrescalerBits(const uint32_t& divider)
+{
+    switch(divider)
+    {
+        case 1: return 0x0U;
+        case 2: return 0x8U;
+        case 4: return 0x9U;
+        case 8: return 0xAU;
+        case 16: return 0xBU;
+        case 64: return 0xCU;
+        case 128: return 0xDU;
+        case 256: return 0xEU;
+        case 512: return 0xFU;
+        default: return invalidPrescaler;
+    }
+}
+
+/** @brief PPRE1/PPRE2 field value for an APB divider */
+constexpr uint32_t getAPBPrescalerBits(const uint32_t& divider)
+{
+    switch(divider)
+    {
+        case 1: return 0x0U;
+        case 2: return 0x4U;
+        case 4: return 0x5U;
+        case 8: return 0x6U;
+        case 16: return 0x7U;
+        default: return invalidPrescaler;
+    }
+}
+
+/** @brief Flash wait states for an HCLK frequency, 2.7 V to 3.6 V supply (RM0383 table 6) */
+constexpr uint32_t getFlashLatency(const uint32_t& hclk)
+{
+    if(hclk <= 30000000UL)
+        return 0;
+    if(hclk <= 64000000UL)
+        return 1;
+    if(hclk <= 90000000UL)
+        return 2;
+    return 3;
+}
+
+/** @brief Lowest-power regulator scale that sustains an HCLK frequency, as the VOS field of PWR_CR */
+constexpr uint32_t getVoltageScale(const uint32_t& hclk)
+{
+    if(hclk <= 64000000UL)
+        return 0x1U;
+    if(hclk <= 84000000UL)
+        return 0x2U;
+    return 0x3U;
+}
+
+/** @brief Divider field of sourceFrequency / frequency, or invalidPrescaler if the division is not exact */
+constexpr uint32_t getPrescalerBits(const uint32_t& sourceFrequency, const uint32_t& frequency, uint32_t (*getBits)(const uint32_t&))
+{
+    if(frequency == 0 || sourceFrequency % frequency)
+        return invalidPrescaler;
+    return getBits(sourceFrequency / frequency);
+}
+
+constexpr ClockTreeSettings solveClockTree(const ClockConfiguration& configuration)
+{
+    ClockTreeSettings settings {};
+
+    if(configuration.source == rccClockSource::MainPLL)
+        return settings;
+    if(configuration.source == rccClockSource::HSI && configuration.sourceFrequency != HSI_FREQUENCY)
+        return settings;
+    if(configuration.source == rccClockSource::HSE)
+    {
+        const uint32_t maxHse = configuration.hseBypass ? ClockLimits::maxHseBypass : ClockLimits::maxHseCrystal;
+        if(configuration.sourceFrequency < ClockLimits::minHse || configuration.sourceFrequency > maxHse)
+            return settings;
+    }
+    if(configuration.sysclk == 0 || configuration.sysclk > ClockLimits::maxSysclk)
+        return settings;
+    if(configuration.pclk1 > ClockLimits::maxPclk1 || configuration.pclk2 > ClockLimits::maxPclk2)
+        return settings;
+
+    settings.usesPLL = configuration.sysclk != configuration.sourceFrequency || configuration.usbClock;
+    if(settings.usesPLL)
+    {
+        settings.pll = solvePLL(configuration.sourceFrequency, configuration.sysclk, configuration.usbClock);
+        if(settings.pll.m == 0)
+            return settings;
+        settings.pll48clk = configuration.sourceFrequency / settings.pll.m * settings.pll.n / settings.pll.q;
+    }
+
+    const uint32_t ahb = getPrescalerBits(configuration.sysclk, configuration.hclk, getAHBPrescalerBits);
+    const uint32_t apb1 = getPrescalerBits(configuration.hclk, configuration.pclk1, getAPBPrescalerBits);
+    const uint32_t apb2 = getPrescalerBits(configuration.hclk, configuration.pclk2, getAPBPrescalerBits);
+    if(ahb == invalidPrescaler || apb1 == invalidPrescaler || apb2 == invalidPrescaler)
+        return settings;
+
+    settings.cfgrPrescalers = (ahb << RCC_CFGR_HPRE_Pos) | (apb1 << RCC_CFGR_PPRE1_Pos) | (apb2 << RCC_CFGR_PPRE2_Pos);
+    settings.flashLatency = getFlashLatency(configuration.hclk);
+    settings.flashAccelerator = configuration.flashAccelerator ? (FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN) : 0U;
+    settings.voltageScale = getVoltageScale(configuration.hclk);
+    settings.sysclk = configuration.sysclk;
+    settings.hclk = configuration.hclk;
+    settings.pclk1 = configuration.pclk1;
+    settings.pclk2 = configuration.pclk2;
+    settings.isValid = true;
+    return settings;
+}
+
+/** @brief Settings of a configuration, solved at compile time */
+template<ClockConfiguration Configuration>
+constexpr ClockTreeSettings clockTreeSettings { solveClockTree(Configuration) };
+
+
+/**
+ * @brief Applies clock tree settings to the RCC, FLASH and PWR registers
+ *
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+class ClockTree
+{
+    public:
+
+        template<ClockConfiguration Configuration>
+        static RCCStatusCodes apply();
+        static RCCStatusCodes apply(const ClockTreeSettings& settings, const ClockConfiguration& configuration);
+
+        static RCCStatusCodes switchSystemClock(const rccClockSource& source);
+        static rccClockSource getSystemClockSource();
+
+    private:
+
+        static constexpr uint32_t readyTimeout { 0x10000U };
+
+        static constexpr uint32_t flashAcceleratorBits { FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN };
+
+        static RCCStatusCodes switchClockTree(const ClockTreeSettings& settings, const ClockConfiguration& configuration);
+        static RCCStatusCodes enableOscillator(const rccClockSource& source, const bool& hseBypass = false);
+        static RCCStatusCodes configurePLL(const PLL& pll, const rccClockSource& source, const uint32_t& voltageScale);
+        static void setVoltageScale(const uint32_t& voltageScale);
+        static bool setFlashLatency(const uint32_t& latency);
+        static uint32_t getCurrentFlashLatency();
+        static void resetFlashCaches();
+
+        template<typename Condition>
+        static bool waitFor(const Condition& condition);
+
+        static auto* getRCC() { return Registers<RCC_TypeDef, RCC_BASE>::get(); }
+        static auto* getFLASH() { return Registers<FLASH_TypeDef, FLASH_R_BASE>::get(); }
+        static auto* getPWR() { return Registers<PWR_TypeDef, PWR_BASE>::get(); }
+};
+
+template<template<typename, uint32_t> class Registers>
+template<ClockConfiguration Configuration>
+inline RCCStatusCodes ClockTree<Registers>::apply()
+{
+    static_assert(clockTreeSettings<Configuration>.isValid, "[the requested clock tree can not be produced by the F411]");
+    return apply(clockTreeSettings<Configuration>, Configuration);
+}
+
+/**
+ * @brief Switches the clock tree with the flash caches disabled, then flushes them and enables the accelerator of the
+ * new settings. Lines cached before the switch are never served with the new wait states. If the switch fails, the
+ * accelerator is restored as it was
+ */
+template<template<typename, uint32_t> class Registers>
+inline RCCStatusCodes ClockTree<Registers>::apply(const ClockTreeSettings& settings, const ClockConfiguration& configuration)
+{
+    if(!settings.isValid)
+        return RCCStatusCodes::invalidConfiguration;
+
+    auto* flash = getFLASH();
+    const uint32_t previousAccelerator = static_cast<uint32_t>(flash->ACR) & flashAcceleratorBits;
+    flash->ACR = static_cast<uint32_t>(flash->ACR) & ~(FLASH_ACR_ICEN | FLASH_ACR_DCEN);
+
+    const RCCStatusCodes status = switchClockTree(settings, configuration);
+
+    resetFlashCaches();
+    const uint32_t accelerator = status == RCCStatusCodes::Ready ? settings.flashAccelerator : previousAccelerator;
+    flash->ACR = (static_cast<uint32_t>(flash->ACR) & ~flashAcceleratorBits) | accelerator;
+    return status;
+}
+
+/**
+ * @brief Switching sequence. Flash wait states are raised before and lowered after the switch, and both APB buses run
+ * divided by 16 during it, so no bus or memory is ever clocked above its limit, whether the frequency goes up or down.
+ * VOS is only written while the PLL is off (RM0383 5.4.1). If the switch fails, the prescalers and wait states are put
+ * back as they were: the core keeps running from its previous source or from the HSI, both valid with them
+ */
+template<template<typename, uint32_t> class Registers>
+inline RCCStatusCodes ClockTree<Registers>::switchClockTree(const ClockTreeSettings& settings, const ClockConfiguration& configuration)
+{
+    auto* rcc = getRCC();
+    constexpr uint32_t prescalerBits { RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2 };
+    const uint32_t previousPrescalers = static_cast<uint32_t>(rcc->CFGR) & prescalerBits;
+    const uint32_t previousLatency = getCurrentFlashLatency();
+    const auto restore = [rcc, previousPrescalers, previousLatency](const RCCStatusCodes& status)
+    {
+        rcc->CFGR = (static_cast<uint32_t>(rcc->CFGR) & ~prescalerBits) | previousPrescalers;
+        setFlashLatency(previousLatency);
+        return status;
+    };
+
+    RCCStatusCodes status = enableOscillator(configuration.source, configuration.hseBypass);
+    if(status != RCCStatusCodes::Ready)
+        return status;
+
+    if(settings.flashLatency > getCurrentFlashLatency() && !setFlashLatency(settings.flashLatency))
+        return restore(RCCStatusCodes::flashLatencyNotApplied);
+
+    rcc->CFGR = static_cast<uint32_t>(rcc->CFGR) | RCC_CFGR_PPRE1_DIV16 | RCC_CFGR_PPRE2_DIV16;
+
+    if(settings.usesPLL)
+    {
+        status = configurePLL(settings.pll, configuration.source, settings.voltageScale);
+        if(status != RCCStatusCodes::Ready)
+            return restore(status);
+    }
+
+    rcc->CFGR = (static_cast<uint32_t>(rcc->CFGR) & ~RCC_CFGR_HPRE) | (settings.cfgrPrescalers & RCC_CFGR_HPRE);
+    const rccClockSource previousSource = getSystemClockSource();
+    status = switchSystemClock(settings.usesPLL ? rccClockSource::MainPLL : configuration.source);
+    if(status != RCCStatusCodes::Ready)
+    {
+        // Cancels the pending switch, so the clock does not change once the prescalers are back
+        rcc->CFGR = (static_cast<uint32_t>(rcc->CFGR) & ~RCC_CFGR_SW) | static_cast<uint32_t>(previousSource);
+        return restore(status);
+    }
+    rcc->CFGR = (static_cast<uint32_t>(rcc->CFGR) & ~(RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) | (settings.cfgrPrescalers & (RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2));
+
+    // The PLL is not needed any more when running straight from the oscillator
+    if(!settings.usesPLL)
+    {
+        rcc->CR = static_cast<uint32_t>(rcc->CR) & ~RCC_CR_PLLON;
+        if(!waitFor([rcc]() { return !(static_cast<uint32_t>(rcc->CR) & RCC_CR_PLLRDY); }))
+            return RCCStatusCodes::pllNotReady;
+        setVoltageScale(settings.voltageScale);
+    }
+
+    // The new clock is already running: a latency that can not be lowered is left higher, which is still safe
+    if(settings.flashLatency < getCurrentFlashLatency() && !setFlashLatency(settings.flashLatency))
+        return RCCStatusCodes::flashLatencyNotApplied;
+    return RCCStatusCodes::Ready;
+}
+
+/** @brief Selects the system clock and waits for SWS to confirm it. The source has to be running already */
+template<template<typename, uint32_t> class Registers>
+inline RCCStatusCodes ClockTree<Registers>::switchSystemClock(const rccClockSource& source)
+{
+    auto* rcc = getRCC();
+    const uint32_t sw = static_cast<uint32_t>(source);
+    rcc->CFGR = (static_cast<uint32_t>(rcc->CFGR) & ~RCC_CFGR_SW) | sw;
+    if(!waitFor([rcc, sw]() { return ((static_cast<uint32_t>(rcc->CFGR) & RCC_CFGR_SWS) >> RCC_CFGR_SWS_Pos) == sw; }))
+        return RCCStatusCodes::clockSwitchFailed;
+    return RCCStatusCodes::Ready;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline rccClockSource ClockTree<Registers>::getSystemClockSource()
+{
+    return static_cast<rccClockSource>((static_cast<uint32_t>(getRCC()->CFGR) & RCC_CFGR_SWS) >> RCC_CFGR_SWS_Pos);
+}
+
+template<template<typename, uint32_t> class Registers>
+inline RCCStatusCodes ClockTree<Registers>::enableOscillator(const rccClockSource& source, const bool& hseBypass)
+{
+    auto* rcc = getRCC();
+    if(source == rccClockSource::HSE)
+    {
+        // HSEBYP can only be changed while the HSE is off, so a running HSE is kept as it is
+        if(static_cast<uint32_t>(rcc->CR) & RCC_CR_HSERDY)
+            return RCCStatusCodes::Ready;
+        rcc->CR = (static_cast<uint32_t>(rcc->CR) & ~RCC_CR_HSEBYP) | (hseBypass ? RCC_CR_HSEBYP : 0U);
+        rcc->CR = static_cast<uint32_t>(rcc->CR) | RCC_CR_HSEON;
+        if(!waitFor([rcc]() { return static_cast<uint32_t>(rcc->CR) & RCC_CR_HSERDY; }))
+            return RCCStatusCodes::hseNotReady;
+        return RCCStatusCodes::Ready;
+    }
+
+    rcc->CR = static_cast<uint32_t>(rcc->CR) | RCC_CR_HSION;
+    if(!waitFor([rcc]() { return static_cast<uint32_t>(rcc->CR) & RCC_CR_HSIRDY; }))
+        return RCCStatusCodes::hsiNotReady;
+    return RCCStatusCodes::Ready;
+}
+
+/**
+ * @brief The PLL can only be reprogrammed while it is off, so a system clock running from it is moved to the HSI first.
+ * The voltage scale is written in the same window
+ */
+template<template<typename, uint32_t> class Registers>
+inline RCCStatusCodes ClockTree<Registers>::configurePLL(const PLL& pll, const rccClockSource& source, const uint32_t& voltageScale)
+{
+    auto* rcc = getRCC();
+    if(getSystemClockSource() == rccClockSource::MainPLL)
+    {
+        RCCStatusCodes status = enableOscillator(rccClockSource::HSI);
+        if(status == RCCStatusCodes::Ready)
+            status = switchSystemClock(rccClockSource::HSI);
+        if(status != RCCStatusCodes::Ready)
+            return status;
+    }
+
+    rcc->CR = static_cast<uint32_t>(rcc->CR) & ~RCC_CR_PLLON;
+    if(!waitFor([rcc]() { return !(static_cast<uint32_t>(rcc->CR) & RCC_CR_PLLRDY); }))
+        return RCCStatusCodes::pllNotReady;
+    setVoltageScale(voltageScale);
+
+    constexpr uint32_t fields { RCC_PLLCFGR_PLLM | RCC_PLLCFGR_PLLN | RCC_PLLCFGR_PLLP | RCC_PLLCFGR_PLLSRC | RCC_PLLCFGR_PLLQ };
+    const uint32_t value = (pll.m << RCC_PLLCFGR_PLLM_Pos) | (pll.n << RCC_PLLCFGR_PLLN_Pos) | ((pll.p / 2U - 1U) << RCC_PLLCFGR_PLLP_Pos)
+                         | (source == rccClockSource::HSE ? RCC_PLLCFGR_PLLSRC_HSE : 0U) | (pll.q << RCC_PLLCFGR_PLLQ_Pos);
+    rcc->PLLCFGR = (static_cast<uint32_t>(rcc->PLLCFGR) & ~fields) | value;
+
+    rcc->CR = static_cast<uint32_t>(rcc->CR) | RCC_CR_PLLON;
+    if(!waitFor([rcc]() { return static_cast<uint32_t>(rcc->CR) & RCC_CR_PLLRDY; }))
+        return RCCStatusCodes::pllNotReady;
+    return RCCStatusCodes::Ready;
+}
+
+/** @brief Writes PWR_CR.VOS. The PLL has to be off. PWR is only clocked for the write: the clock is left as its other users want it */
+template<template<typename, uint32_t> class Registers>
+inline void ClockTree<Registers>::setVoltageScale(const uint32_t& voltageScale)
+{
+    auto* pwr = getPWR();
+    const PeripheralClockHandle<Registers> pwrClock { AvailablePeripherals::_PWR };
+    pwr->CR = (static_cast<uint32_t>(pwr->CR) & ~PWR_CR_VOS) | (voltageScale << PWR_CR_VOS_Pos);
+}
+
+/** @brief Writes the wait states and reads them back: the new value has to be in effect before the clock changes */
+template<template<typename, uint32_t> class Registers>
+inline bool ClockTree<Registers>::setFlashLatency(const uint32_t& latency)
+{
+    auto* flash = getFLASH();
+    flash->ACR = (static_cast<uint32_t>(flash->ACR) & ~FLASH_ACR_LATENCY) | (latency << FLASH_ACR_LATENCY_Pos);
+    return getCurrentFlashLatency() == latency;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline uint32_t ClockTree<Registers>::getCurrentFlashLatency()
+{
+    return (static_cast<uint32_t>(getFLASH()->ACR) & FLASH_ACR_LATENCY) >> FLASH_ACR_LATENCY_Pos;
+}
+
+/** @brief Invalidates both flash caches. ICRST/DCRST only act while the caches are disabled */
+template<template<typename, uint32_t> class Registers>
+inline void ClockTree<Registers>::resetFlashCaches()
+{
+    auto* flash = getFLASH();
+    flash->ACR = static_cast<uint32_t>(flash->ACR) | FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    flash->ACR = static_cast<uint32_t>(flash->ACR) & ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+}
+
+template<template<typename, uint32_t> class Registers>
+template<typename Condition>
+inline bool ClockTree<Registers>::waitFor(const Condition& condition)
+{
+    for(uint32_t i = 0; i < readyTimeout; ++i)
+    {
+        if(condition())
+            return true;
+    }
+    return false;
+}
+
+
+#endif // __CLOCKTREE_H__
@@ -0,0 +1,322 @@
+#ifndef __PERIPHERALCLOCKHANDLE_H__
+#define __PERIPHERALCLOCKHANDLE_H__
+
+/**
+ * @file PeripheralClockHandle.hh
+ * @brief Reference-counted peripheral clocks. Every driver instance holds a handle on the clock of the peripheral it
+ * uses; the clock is enabled when the first handle is taken and gated off when the last one is released, so unused
+ * peripherals do not draw current. Drivers without instances (StaticPin, GpioWaveform, ExternalInterrupt,
+ * PowerManager) hold static handles: a clock enabled without a handle would be gated off under its user by the last
+ * counted one. Peripherals brought up together (a USART with its DMA controller and pin port) take their users
+ * through one group handle, whose clocks are enabled with one access per bridge. The counters are not interrupt safe: handles are taken and dropped by driver
+ * construction and destruction in thread context.
+ */
+
+#include <ClockGating.hh>
+#include <array>
+#include <cstddef>
+#include <optional>
+
+constexpr std::size_t availablePeripheralsCount { static_cast<std::size_t>(AvailablePeripherals::_TIM1) + 1U };
+
+/** @brief Clock of every entry of AvailablePeripherals, in declaration order */
+constexpr std::array<PeripheralClockMask, availablePeripheralsCount> availablePeripheralClocks
+{
+    getPeripheralClockMask(AHB1BridgePeripherals::_DMA2), getPeripheralClockMask(AHB1BridgePeripherals::_DMA1), getPeripheralClockMask(AHB1BridgePeripherals::_CRC),
+    getPeripheralClockMask(AHB1BridgePeripherals::_GPIOH), getPeripheralClockMask(AHB1BridgePeripherals::_GPIOE), getPeripheralClockMask(AHB1BridgePeripherals::_GPIOD),
+    getPeripheralClockMask(AHB1BridgePeripherals::_GPIOC), getPeripheralClockMask(AHB1BridgePeripherals::_GPIOB), getPeripheralClockMask(AHB1BridgePeripherals::_GPIOA),
+    getPeripheralClockMask(AHB2BridgePeripherals::_OTGFS),
+    getPeripheralClockMask(APB1BridgePeripherals::_PWR), getPeripheralClockMask(APB1BridgePeripherals::_I2C3), getPeripheralClockMask(APB1BridgePeripherals::_I2C2),
+    getPeripheralClockMask(APB1BridgePeripherals::_I2C1), getPeripheralClockMask(APB1BridgePeripherals::_USART2), getPeripheralClockMask(APB1BridgePeripherals::_SPI3),
+    getPeripheralClockMask(APB1BridgePeripherals::_SPI2), getPeripheralClockMask(APB1BridgePeripherals::_WWDG), getPeripheralClockMask(APB1BridgePeripherals::_TIM5),
+    getPeripheralClockMask(APB1BridgePeripherals::_TIM4), getPeripheralClockMask(APB1BridgePeripherals::_TIM3), getPeripheralClockMask(APB1BridgePeripherals::_TIM2),
+    getPeripheralClockMask(APB2BridgePeripherals::_SPI5), getPeripheralClockMask(APB2BridgePeripherals::_TIM11), getPeripheralClockMask(APB2BridgePeripherals::_TIM10),
+    getPeripheralClockMask(APB2BridgePeripherals::_TIM9), getPeripheralClockMask(APB2BridgePeripherals::_SYSCGF), getPeripheralClockMask(APB2BridgePeripherals::_SPI4),
+    getPeripheralClockMask(APB2BridgePeripherals::_SPI1), getPeripheralClockMask(APB2BridgePeripherals::_SDIO), getPeripheralClockMask(APB2BridgePeripherals::_ADC1),
+    getPeripheralClockMask(APB2BridgePeripherals::_USART6), getPeripheralClockMask(APB2BridgePeripherals::_USART1), getPeripheralClockMask(APB2BridgePeripherals::_TIM1),
+};
+
+constexpr PeripheralClockMask getPeripheralClockMask(const AvailablePeripherals& peripheral)
+{
+    return availablePeripheralClocks[static_cast<std::size_t>(peripheral)];
+}
+
+/**
+ * @brief Entry of a GPIO port. port is the GpioPort value, i.e. the port bit position in AHB1ENR. Empty for the
+ * positions of ports F and G, which the F411 does not have, and beyond H
+ */
+constexpr std::optional<AvailablePeripherals> getGpioPortPeripheral(const uint32_t& port)
+{
+    switch(port)
+    {
+        case 0: return AvailablePeripherals::_GPIOA;
+        case 1: return AvailablePeripherals::_GPIOB;
+        case 2: return AvailablePeripherals::_GPIOC;
+        case 3: return AvailablePeripherals::_GPIOD;
+        case 4: return AvailablePeripherals::_GPIOE;
+        case 7: return AvailablePeripherals::_GPIOH;
+        default: return std::nullopt;
+    }
+}
+
+/**
+ * @brief User count of every entry of AvailablePeripherals, packed in counterBits-wide fields of 32-bit words
+ *
+ * @tparam Registers Register block resolver. Defaults to the memory mapped registers
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PeripheralClockCounter
+{
+    public:
+
+        // 5 bits: every pin of a port can hold its own handle
+        static constexpr uint32_t counterBits { 5U };
+        static constexpr uint32_t maxUsers { (0x1U << counterBits) - 1U };
+
+        static bool acquire(const AvailablePeripherals& peripheral);
+        static void release(const AvailablePeripherals& peripheral);
+        template<std::size_t N>
+        static bool acquire(const std::array<AvailablePeripherals, N>& peripherals);
+        template<std::size_t N>
+        static void release(const std::array<AvailablePeripherals, N>& peripherals);
+        static uint32_t getUsers(const AvailablePeripherals& peripheral);
+
+    private:
+
+        static constexpr uint32_t countersPerWord { 32U / counterBits };
+        static constexpr uint32_t counterMask { maxUsers };
+
+        static void setUsers(const AvailablePeripherals& peripheral, const uint32_t& users);
+
+        static constinit inline std::array<uint32_t, (availablePeripheralsCount + countersPerWord - 1U) / countersPerWord> counters {};
+};
+
+/**
+ * @brief Takes a user of the clock of peripheral, enabling it for the first one.
+ * Returns false if the peripheral already has maxUsers users
+ */
+template<template<typename, uint32_t> class Registers>
+inline bool PeripheralClockCounter<Registers>::acquire(const AvailablePeripherals& peripheral)
+{
+    const uint32_t users = getUsers(peripheral);
+    if(users == maxUsers)
+        return false;
+    if(users == 0)
+        PeripheralClockGate<Registers>::enable(getPeripheralClockMask(peripheral));
+    setUsers(peripheral, users + 1U);
+    return true;
+}
+
+/** @brief Drops a user of the clock of peripheral, gating the clock off with the last one */
+template<template<typename, uint32_t> class Registers>
+inline void PeripheralClockCounter<Registers>::release(const AvailablePeripherals& peripheral)
+{
+    const uint32_t users = getUsers(peripheral);
+    if(users == 0)
+        return;
+    if(users == 1)
+        PeripheralClockGate<Registers>::disable(getPeripheralClockMask(peripheral));
+    setUsers(peripheral, users - 1U);
+}
+
+/**
+ * @brief Takes a user of every peripheral of the set. The clocks that had no user are enabled together, with one
+ * read-modify-write per bridge and a single read-back, instead of one of each per peripheral. Returns false, with no
+ * user taken, if one of them already has maxUsers users
+ */
+template<template<typename, uint32_t> class Registers>
+template<std::size_t N>
+inline bool PeripheralClockCounter<Registers>::acquire(const std::array<AvailablePeripherals, N>& peripherals)
+{
+    PeripheralClockMask enabled {};
+    for(std::size_t i = 0; i < N; ++i)
+    {
+        const uint32_t users = getUsers(peripherals[i]);
+        if(users == maxUsers)
+        {
+            // Nothing was enabled yet: the users taken are only given back
+            for(std::size_t taken = 0; taken < i; ++taken)
+                setUsers(peripherals[taken], getUsers(peripherals[taken]) - 1U);
+            return false;
+        }
+        if(users == 0)
+            enabled = enabled | getPeripheralClockMask(peripherals[i]);
+        setUsers(peripherals[i], users + 1U);
+    }
+    if(!enabled.isEmpty())
+        PeripheralClockGate<Registers>::enable(enabled);
+    return true;
+}
+
+/** @brief Drops a user of every peripheral of the set, gating the clocks left without user off together */
+template<template<typename, uint32_t> class Registers>
+template<std::size_t N>
+inline void PeripheralClockCounter<Registers>::release(const std::array<AvailablePeripherals, N>& peripherals)
+{
+    PeripheralClockMask disabled {};
+    for(const AvailablePeripherals& peripheral : peripherals)
+    {
+        const uint32_t users = getUsers(peripheral);
+        if(users == 0)
+            continue;
+        if(users == 1)
+            disabled = disabled | getPeripheralClockMask(peripheral);
+        setUsers(peripheral, users - 1U);
+    }
+    if(!disabled.isEmpty())
+        PeripheralClockGate<Registers>::disable(disabled);
+}
+
+template<template<typename, uint32_t> class Registers>
+inline uint32_t PeripheralClockCounter<Registers>::getUsers(const AvailablePeripherals& peripheral)
+{
+    const uint32_t index = static_cast<uint32_t>(peripheral);
+    return (counters[index / countersPerWord] >> ((index % countersPerWord) * counterBits)) & counterMask;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline void PeripheralClockCounter<Registers>::setUsers(const AvailablePeripherals& peripheral, const uint32_t& users)
+{
+    const uint32_t index = static_cast<uint32_t>(peripheral);
+    const uint32_t shift = (index % countersPerWord) * counterBits;
+    uint32_t& word = counters[index / countersPerWord];
+    word = (word & ~(counterMask << shift)) | (users << shift);
+}
+
+
+/**
+ * @brief Ownership of one user of a peripheral clock. Move-only; the user is released when the handle is destroyed or
+ * assigned another one
+ */
+template<template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PeripheralClockHandle
+{
+    public:
+
+        constexpr PeripheralClockHandle() = default;
+        explicit PeripheralClockHandle(const AvailablePeripherals& peripheral);
+        PeripheralClockHandle(PeripheralClockHandle&& other);
+        PeripheralClockHandle& operator=(PeripheralClockHandle&& other);
+        PeripheralClockHandle(const PeripheralClockHandle&) = delete;
+        PeripheralClockHandle& operator=(const PeripheralClockHandle&) = delete;
+        ~PeripheralClockHandle() { release(); }
+
+        /** @brief False for an empty or moved-from handle, or if the peripheral had too many users */
+        bool isValid() const { return valid; }
+        AvailablePeripherals getPeripheral() const { return peripheral; }
+        void release();
+
+    private:
+
+        AvailablePeripherals peripheral { AvailablePeripherals::_DMA2 };
+        bool valid { false };
+};
+
+template<template<typename, uint32_t> class Registers>
+inline PeripheralClockHandle<Registers>::PeripheralClockHandle(const AvailablePeripherals& peripheral)
+    : peripheral(peripheral), valid(PeripheralClockCounter<Registers>::acquire(peripheral))
+{
+}
+
+template<template<typename, uint32_t> class Registers>
+inline PeripheralClockHandle<Registers>::PeripheralClockHandle(PeripheralClockHandle&& other)
+    : peripheral(other.peripheral), valid(other.valid)
+{
+    other.valid = false;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline PeripheralClockHandle<Registers>& PeripheralClockHandle<Registers>::operator=(PeripheralClockHandle&& other)
+{
+    if(this != &other)
+    {
+        release();
+        peripheral = other.peripheral;
+        valid = other.valid;
+        other.valid = false;
+    }
+    return *this;
+}
+
+template<template<typename, uint32_t> class Registers>
+inline void PeripheralClockHandle<Registers>::release()
+{
+    if(valid)
+        PeripheralClockCounter<Registers>::release(peripheral);
+    valid = false;
+}
+
+/**
+ * @brief Ownership of one user of each clock of a set of peripherals brought up together, e.g. a USART with its DMA
+ * controller and pin port. Move-only, like PeripheralClockHandle; the users are released together
+ */
+template<std::size_t N, template<typename, uint32_t> class Registers = PeripheralRegisters>
+class PeripheralClockGroupHandle
+{
+    public:
+
+        constexpr PeripheralClockGroupHandle() = default;
+        explicit PeripheralClockGroupHandle(const std::array<AvailablePeripherals, N>& peripherals);
+        PeripheralClockGroupHandle(PeripheralClockGroupHandle&& other);
+        PeripheralClockGroupHandle& operator=(PeripheralClockGroupHandle&& other);
+        PeripheralClockGroupHandle(const PeripheralClockGroupHandle&) = delete;
+        PeripheralClockGroupHandle& operator=(const PeripheralClockGroupHandle&) = delete;
+        ~PeripheralClockGroupHandle() { release(); }
+
+        /** @brief False for an empty or moved-from handle, or if one of the peripherals had too many users */
+        bool isValid() const { return valid; }
+        const std::array<AvailablePeripherals, N>& getPeripherals() const { return peripherals; }
+        PeripheralClockMask getClockMask() const;
+        void release();
+
+    private:
+
+        std::array<AvailablePeripherals, N> peripherals {};
+        bool valid { false };
+};
+
+template<std::size_t N, template<typename, uint32_t> class Registers>
+inline PeripheralClockGroupHandle<N, Registers>::PeripheralClockGroupHandle(const std::array<AvailablePeripherals, N>& peripherals)
+    : peripherals(peripherals), valid(PeripheralClockCounter<Registers>::acquire(peripherals))
+{
+}
+
+template<std::size_t N, template<typename, uint32_t> class Registers>
+inline PeripheralClockGroupHandle<N, Registers>::PeripheralClockGroupHandle(PeripheralClockGroupHandle&& other)
+    : peripherals(other.peripherals), valid(other.valid)
+{
+    other.valid = false;
+}
+
+template<std::size_t N, template<typename, uint32_t> class Registers>
+inline PeripheralClockGroupHandle<N, Registers>& PeripheralClockGroupHandle<N, Registers>::operator=(PeripheralClockGroupHandle&& other)
+{
+    if(this != &other)
+    {
+        release();
+        peripherals = other.peripherals;
+        valid = other.valid;
+        other.valid = false;
+    }
+    return *this;
+}
+
+template<std::size_t N, template<typename, uint32_t> class Registers>
+inline PeripheralClockMask PeripheralClockGroupHandle<N, Registers>::getClockMask() const
+{
+    PeripheralClockMask mask {};
+    for(const AvailablePeripherals& peripheral : peripherals)
+        mask = mask | getPeripheralClockMask(peripheral);
+    return mask;
+}
+
+template<std::size_t N, template<typename, uint32_t> class Registers>
+inline void PeripheralClockGroupHandle<N, Registers>::release()
+{
+    if(valid)
+        PeripheralClockCounter<Registers>::release(peripherals);
+    valid = false;
+}
+
+
+#endif // __PERIPHERALCLOCKHANDLE_H__
@@ -0,0 +1,32 @@
+#ifndef __RCCTYPES_H__
+#define __RCCTYPES_H__
+
+#include <stdint.h>
+
+#define HSI_FREQUENCY 16000000UL
+
+// Values match the SW/SWS encoding of RCC_CFGR
+enum class rccClockSource : uint8_t { HSI = 0x0, HSE = 0x1, MainPLL = 0x2 };
+
+enum class RCCStatusCodes : uint8_t
+{
+    Reset,
+    Ready,
+    invalidConfiguration,
+    hsiNotReady,
+    hseNotReady,
+    pllNotReady,
+    clockSwitchFailed,
+    flashLatencyNotApplied,
+};
+
+/* Main PLL dividers: VCO input = source / m, VCO output = VCO input * n, SYSCLK = VCO output / p, USB/SDIO = VCO output / q */
+struct PLL
+{
+    uint32_t m;
+    uint32_t n;
+    uint32_t p;
+    uint32_t q;
+};
+
+#endif // __RCCTYPES_H__
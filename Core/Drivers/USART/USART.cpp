@@ -0,0 +1,324 @@
+#include <USART.hh>
+
+
+std::array<USART*, 3> USART::drivers{};
+
+USART::USART(const USARTInstance &instance, const USARTBaudRate &baudRate)
+    : USARTParent(USARTInstance::null, USARTBaudRate{})
+{
+    this->setAllParametersValue(instance, baudRate);
+}
+
+USART::~USART()
+{
+    stopReceiving();
+    transmitStream.stop();
+    transmitting = false;
+    updatePowerConstraint();
+    if(this->instance != nullptr)
+        this->instance->CR1 = 0x0U;
+    for(USART*& driver : drivers)
+    {
+        if(driver == this)
+            driver = nullptr;
+    }
+}
+
+/**
+ * @brief Runs the config function of every parameter changed since the last init, with the USART disabled as BRR
+ * requires, then enables the transmitter, the receiver and their DMA requests. EIE raises the USART interrupt on
+ * overrun, framing and noise errors, which the DMA requests would otherwise hide
+ */
+USARTStatusCodes USART::init()
+{
+    if(!this->areMandatoryParametersSet())
+        return USARTStatusCodes::notReadyNotReset;
+    if(this->getDirtyParameters().none() && isReady())
+        return USARTStatusCodes::Ready;
+
+    if(this->instance != nullptr)
+        this->instance->CR1 = static_cast<uint32_t>(this->instance->CR1) & ~USART_CR1_UE;
+    for(const USARTStatusCodes& status : USARTParent::init())
+    {
+        if(status != USARTStatusCodes::Ready)
+        {
+            this->setStatus(status);
+            return status;
+        }
+    }
+
+    this->instance->CR2 = 0x0U;
+    this->instance->CR3 = USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_EIE;
+    this->instance->CR1 = (static_cast<uint32_t>(this->instance->CR1) & USART_CR1_OVER8) | USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE;
+    enableIRQ(getRoute().irq);
+    this->setStatus(USARTStatusCodes::Ready);
+    return USARTStatusCodes::Ready;
+}
+
+/** @brief Applied right away once the USART is initialized; before that, by the first init (Reset is returned) */
+USARTStatusCodes USART::setBaudRate(const USARTBaudRate &baudRate)
+{
+    this->template setParameterValue<USARTProperties::baudRate>(baudRate);
+    return isReady() ? init() : USARTStatusCodes::Reset;
+}
+
+USARTStatusCodes USART::transmit(const uint8_t *data, const uint16_t &length, const USARTTransmitCallback &callback, void *context)
+{
+    if(data == nullptr || length == 0)
+        return USARTStatusCodes::invalidBuffer;
+    if(!isReady())
+        return USARTStatusCodes::notReadyNotReset;
+    if(transmitting)
+        return USARTStatusCodes::busy;
+
+    transmitCallback = callback;
+    transmitContext = context;
+    transmitting = true;
+    // TC is rc_w0: writing the other bits as 1 leaves them untouched
+    this->instance->SR = static_cast<uint32_t>(~USART_SR_TC);
+    const DMATransfer transfer
+    {
+        .direction = DMADirection::memoryToPeripheral,
+        .peripheral = &this->instance->DR,
+        .memory = data,
+        .length = length,
+        .priority = DMAPriority::medium,
+        .callback = &USART::handleTransmitStreamEvents,
+        .context = this,
+    };
+    if(transmitStream.start(transfer) != DMAStatusCodes::Ready)
+    {
+        transmitting = false;
+        return USARTStatusCodes::streamBusy;
+    }
+    updatePowerConstraint();
+    return USARTStatusCodes::Ready;
+}
+
+USARTStatusCodes USART::startReceiving(uint8_t *buffer, const uint16_t &size, const USARTReceiveCallback &callback, void *context)
+{
+    if(buffer == nullptr || size < 2U || callback == nullptr)
+        return USARTStatusCodes::invalidBuffer;
+    if(!isReady())
+        return USARTStatusCodes::notReadyNotReset;
+    stopReceiving();
+
+    receiveBuffer = buffer;
+    receiveSize = size;
+    receiveCallback = callback;
+    receiveContext = context;
+    if(startReceiveStream() != DMAStatusCodes::Ready)
+    {
+        receiveBuffer = nullptr;
+        return USARTStatusCodes::streamBusy;
+    }
+    updatePowerConstraint();
+    return USARTStatusCodes::Ready;
+}
+
+/** @brief Fills the receive buffer circularly from its start. Reception is not paced by the CPU: it gets the higher priority */
+DMAStatusCodes USART::startReceiveStream()
+{
+    receivePosition = 0;
+    const DMATransfer transfer
+    {
+        .direction = DMADirection::peripheralToMemory,
+        .peripheral = &this->instance->DR,
+        .memory = receiveBuffer,
+        .length = receiveSize,
+        .circular = true,
+        .priority = DMAPriority::high,
+        .callback = &USART::handleReceiveStreamEvents,
+        .context = this,
+        .events = dmaHalfTransferEvent | dmaTransferCompleteEvent | dmaTransferErrorEvent,
+    };
+    return receiveStream.start(transfer);
+}
+
+/** @brief Stops the stream and hands the bytes received so far to the callback */
+void USART::stopReceiving()
+{
+    if(receiveBuffer == nullptr)
+        return;
+    receiveStream.stop();
+    deliverReceivedData();
+    receiveBuffer = nullptr;
+    updatePowerConstraint();
+}
+
+/**
+ * @brief USART interrupt: the line went idle, so a burst shorter than half the buffer is delivered without waiting.
+ * A line error is counted; left set, ORE would raise the interrupt again as soon as it returns
+ */
+void USART::handleInterrupt()
+{
+    constexpr uint32_t lineErrors { USART_SR_ORE | USART_SR_FE | USART_SR_NE };
+    const uint32_t status = this->instance->SR;
+    if(!(status & (USART_SR_IDLE | lineErrors)))
+        return;
+    // IDLE and the error flags are cleared by the read of SR followed by a read of DR
+    static_cast<void>(static_cast<uint32_t>(this->instance->DR));
+    if(status & lineErrors)
+        receiveErrors = receiveErrors + 1;
+    deliverReceivedData();
+}
+
+/**
+ * @brief A transfer error disables the stream: the bytes written before it are delivered, then the stream starts over
+ * from the start of the buffer, so reception goes on
+ */
+void USART::handleReceiveStreamEvents(const uint32_t &events, void *context)
+{
+    USART& usart = *static_cast<USART*>(context);
+    if(events & (dmaHalfTransferEvent | dmaTransferCompleteEvent))
+        usart.deliverReceivedData();
+    if(!(events & dmaTransferErrorEvent) || usart.receiveBuffer == nullptr)
+        return;
+    usart.receiveErrors = usart.receiveErrors + 1;
+    usart.receiveStream.stop();
+    usart.deliverReceivedData();
+    if(usart.startReceiveStream() != DMAStatusCodes::Ready)
+    {
+        usart.receiveBuffer = nullptr;
+        usart.updatePowerConstraint();
+    }
+}
+
+/** @brief The last byte has been read from the buffer: it is the caller's again */
+void USART::handleTransmitStreamEvents(const uint32_t &, void *context)
+{
+    USART& usart = *static_cast<USART*>(context);
+    if(!usart.transmitting)
+        return;
+    usart.transmitting = false;
+    if(usart.transmitCallback != nullptr)
+        usart.transmitCallback(usart.transmitContext);
+    usart.updatePowerConstraint();
+}
+
+USART* USART::getDriver(const USARTInstance &instance)
+{
+    return instance == USARTInstance::null ? nullptr : drivers[static_cast<std::size_t>(instance)];
+}
+
+/**
+ * @brief Takes the clocks of the USART, its DMA controller and its pin port, the streams of its requests and its
+ * pins, and registers the driver for the IRQ handlers
+ */
+USARTStatusCodes USART::configInstance(const USARTInstance &instance, USART &usart)
+{
+    if(instance == USARTInstance::null)
+        return USARTStatusCodes::notReadyNotReset;
+    const std::size_t index = static_cast<std::size_t>(instance);
+    if(drivers[index] != nullptr && drivers[index] != &usart)
+        return USARTStatusCodes::instanceInUse;
+
+    const USARTRoute& route = usartRoutes[index];
+    if(!usart.setInstancePtr(getPeripheralInstance<USART_TypeDef>(route.baseAddress)))
+        return USARTStatusCodes::notReadyNotReset;
+    // One read-modify-write per bridge: the streams and the pins then find their clocks running and only count a user
+    usart.clocks = PeripheralClockGroupHandle<3>({ route.peripheral, getDMARequestPeripheral(route.receive), *getGpioPortPeripheral(static_cast<uint32_t>(route.receivePin.port)) });
+    usart.receiveStream.setRequest(route.receive);
+    usart.transmitStream.setRequest(route.transmit);
+    if(usart.receiveStream.init() != DMAStatusCodes::Ready || usart.transmitStream.init() != DMAStatusCodes::Ready)
+        return USARTStatusCodes::streamBusy;
+    if(!configPin(usart.transmitPin, route.transmitPin) || !configPin(usart.receivePin, route.receivePin))
+        return USARTStatusCodes::pinInUse;
+    // The line idles high: a floating RX would read noise as start bits
+    usart.receivePin.setPullup();
+    for(USART*& driver : drivers)
+    {
+        if(driver == &usart)
+            driver = nullptr;
+    }
+    drivers[index] = &usart;
+    return USARTStatusCodes::Ready;
+}
+
+/**
+ * @brief BRR was computed by the compiler (usartBaudRate): it only has to have been computed for the clock of the bus
+ * the instance is on
+ */
+USARTStatusCodes USART::configBaudRate(const USARTBaudRate &baudRate, USART &usart)
+{
+    if(usart.instance == nullptr)
+        return USARTStatusCodes::notReadyNotReset;
+    if(baudRate.brr == 0 || baudRate.busClock != boardClockFrequencies.getBusFrequency(usart.getRoute().bridge))
+        return USARTStatusCodes::invalidBaudRate;
+    usart.instance->BRR = baudRate.brr;
+    usart.instance->CR1 = baudRate.over8 ? static_cast<uint32_t>(usart.instance->CR1) | USART_CR1_OVER8 : static_cast<uint32_t>(usart.instance->CR1) & ~static_cast<uint32_t>(USART_CR1_OVER8);
+    return USARTStatusCodes::Ready;
+}
+
+/** @brief Routes the signal to its pin. False if another IOPin holds the pin */
+bool USART::configPin(IOPin &pin, const USARTPin &route)
+{
+    return pin.setPort(route.port) == IOPinStatusCodes::Ready && pin.setPin(route.pin) == IOPinStatusCodes::Ready
+        && pin.setAlternateFunction(route.signal) == IOPinStatusCodes::Ready;
+}
+
+/**
+ * @brief The USART, its DMA controller and its pins stay clocked in sleep, and the idle path out of stop, while a
+ * reception or a transmission is in flight
+ */
+void USART::updatePowerConstraint()
+{
+    const bool active = transmitting || receiveBuffer != nullptr;
+    if(active && powerConstraint == PowerConstraints::invalidConstraint)
+        powerConstraint = PowerConstraints::addWakeLatencyConstraint(PowerConstraints::sleepOnly, clocks.getClockMask());
+    else if(!active && powerConstraint != PowerConstraints::invalidConstraint)
+    {
+        PowerConstraints::removeWakeLatencyConstraint(powerConstraint);
+        powerConstraint = PowerConstraints::invalidConstraint;
+    }
+}
+
+void USART::enableIRQ(const IRQn_Type &irq)
+{
+    PeripheralRegisters<NVIC_Type, NVIC_BASE>::get()->ISER[static_cast<uint32_t>(irq) >> 5U] = 0x1U << (static_cast<uint32_t>(irq) & 0x1FU);
+}
+
+/**
+ * @brief Hands the bytes written by the DMA since the last call to the callback, in place: in two calls when they
+ * wrap around the end of the buffer
+ */
+void USART::deliverReceivedData()
+{
+    if(receiveBuffer == nullptr)
+        return;
+    const uint16_t remaining = receiveStream.getRemaining();
+    const uint16_t end = static_cast<uint16_t>((receiveSize - remaining) % receiveSize);
+    if(end < receivePosition)
+    {
+        receiveCallback(receiveBuffer + receivePosition, static_cast<uint16_t>(receiveSize - receivePosition), receiveContext);
+        receivePosition = 0;
+    }
+    if(end > receivePosition)
+        receiveCallback(receiveBuffer + receivePosition, static_cast<uint16_t>(end - receivePosition), receiveContext);
+    receivePosition = end;
+}
+
+
+// USART interrupt handlers. They override the weak aliases of startup_stm32f411retx.s
+
+template<USARTInstance Instance, void (USART::*Handler)()>
+static void dispatchInterrupt()
+{
+    if(USART* driver = USART::getDriver(Instance))
+        (driver->*Handler)();
+}
+
+extern "C" void USART1_IRQHandler()
+{
+    dispatchInterrupt<USARTInstance::_1, &USART::handleInterrupt>();
+}
+
+extern "C" void USART2_IRQHandler()
+{
+    dispatchInterrupt<USARTInstance::_2, &USART::handleInterrupt>();
+}
+
+extern "C" void USART6_IRQHandler()
+{
+    dispatchInterrupt<USARTInstance::_6, &USART::handleInterrupt>();
+}
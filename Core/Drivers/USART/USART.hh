@@ -0,0 +1,215 @@
+#ifndef __USART_H__
+#define __USART_H__
+
+/**
+ * @file USART.hh
+ * @brief USART1/2/6 driver moving both directions through DMA, so a link runs without one interrupt per byte.
+ * Transmission reads the caller's buffer in place: no copy, the buffer is the caller's until the completion callback.
+ * Reception runs continuously into a circular buffer; the half-transfer and transfer-complete interrupts of the stream
+ * and the IDLE line interrupt of the USART hand the bytes received since the last call to the receive callback, as
+ * views into the buffer. While the callback reads one half of the buffer the DMA fills the other one, so it has half
+ * the buffer of line time to return.
+ *
+ * The streams are taken from DMAStream by request (USARTx_RX/USARTx_TX) when the instance is configured, along with
+ * the TX/RX pins of the instance, switched to their alternate function. A reception stopped by a DMA error is
+ * restarted after the bytes before the error are delivered; those errors and the line errors (overrun, framing,
+ * noise) are counted by getReceiveErrors. While it receives or transmits, the driver holds a sleepOnly power
+ * constraint with the clocks of the USART, its DMA controller and its pins.
+ *
+ * Baud rates are given as a USARTBaudRate, whose BRR value is computed by the compiler from the board clock tree:
+ *
+ *     USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+ */
+
+#include <STM32PeripheralBase.hh>
+#include <FlatContainer.hh>
+#include <DMA.hh>
+#include <PeripheralClockHandle.hh>
+#include <BoardClockConfiguration.hh>
+#include <IOPin.hh>
+#include <PowerConstraints.hh>
+#include <algorithm>
+#include <array>
+
+
+enum class USARTStatusCodes
+{
+    Reset,
+    Ready,
+    busy,
+    instanceInUse,
+    invalidBaudRate,
+    invalidBuffer,
+    notReadyNotReset,
+    pinInUse,
+    streamBusy,
+};
+
+enum class USARTInstance : uint8_t { _1, _2, _6, null };
+
+/** @brief BRR and oversampling of a baud rate, for the bus clock they were computed from */
+struct USARTBaudRate
+{
+    uint32_t busClock { 0 };
+    uint16_t brr { 0 };
+    bool over8 { false };
+
+    constexpr bool operator==(const USARTBaudRate&) const = default;
+};
+
+enum class USARTProperties : uint8_t { instance, baudRate, __length };
+constexpr std::size_t USARTMandatoryParameters = 1 << static_cast<std::size_t>(USARTProperties::instance) | 1 << static_cast<std::size_t>(USARTProperties::baudRate);
+class USART;
+using USARTPropertiesContainer = FlatContainer<USARTProperties, USARTInstance, USARTBaudRate>;
+using USARTPeripheralBase = PeripheralBase<USART, USARTStatusCodes, USARTMandatoryParameters, USARTPropertiesContainer>;
+using USARTParent = STM32PeripheralBase<USART_TypeDef, USARTPeripheralBase>;
+using USARTFunctionsContainer = USARTPeripheralBase::ConfigFunctionsType;
+
+using USARTTransmitCallback = void(*)(void* context);
+// data points into the receive buffer: it is only valid until the callback returns
+using USARTReceiveCallback = void(*)(const uint8_t* data, const uint16_t& length, void* context);
+
+/** @brief Pin a USART signal is routed to */
+struct USARTPin
+{
+    GpioPort port;
+    GpioPin pin;
+    GpioSignal signal;
+};
+
+/** @brief Peripheral, clock, DMA requests and pins of a USART instance */
+struct USARTRoute
+{
+    uint32_t baseAddress;
+    AvailablePeripherals peripheral;
+    PeripheralBridges bridge;
+    IRQn_Type irq;
+    DMARequest receive;
+    DMARequest transmit;
+    USARTPin transmitPin;
+    USARTPin receivePin;
+};
+
+// USART2 is wired to the ST-LINK virtual COM port of the NUCLEO-F411RE (BoardPinMap.hh)
+constexpr std::array<USARTRoute, 3> usartRoutes
+{{
+    { USART1_BASE, AvailablePeripherals::_USART1, PeripheralBridges::APB2, USART1_IRQn, DMARequest::USART1_RX, DMARequest::USART1_TX,
+      { GpioPort::A, GpioPin::_9, GpioSignal::usart1Tx }, { GpioPort::A, GpioPin::_10, GpioSignal::usart1Rx } },
+    { USART2_BASE, AvailablePeripherals::_USART2, PeripheralBridges::APB1, USART2_IRQn, DMARequest::USART2_RX, DMARequest::USART2_TX,
+      { GpioPort::A, GpioPin::_2, GpioSignal::usart2Tx }, { GpioPort::A, GpioPin::_3, GpioSignal::usart2Rx } },
+    { USART6_BASE, AvailablePeripherals::_USART6, PeripheralBridges::APB2, USART6_IRQn, DMARequest::USART6_RX, DMARequest::USART6_TX,
+      { GpioPort::A, GpioPin::_11, GpioSignal::usart6Tx }, { GpioPort::A, GpioPin::_12, GpioSignal::usart6Rx } },
+}};
+
+static_assert(std::ranges::all_of(usartRoutes, [](const USARTRoute& route)
+{
+    return isAlternateFunctionAvailable(route.transmitPin.port, route.transmitPin.pin, route.transmitPin.signal)
+        && isAlternateFunctionAvailable(route.receivePin.port, route.receivePin.pin, route.receivePin.signal);
+}), "[a USART pin can not carry its signal]");
+
+// The clock group of an instance holds one DMA controller and one GPIO port
+static_assert(std::ranges::all_of(usartRoutes, [](const USARTRoute& route)
+{
+    return getDMARequestPeripheral(route.receive) == getDMARequestPeripheral(route.transmit) && route.receivePin.port == route.transmitPin.port;
+}), "[the streams or the pins of a USART are spread over several clocks]");
+
+// Largest baud rate error accepted by default: the receiver samples each bit 16 (or 8) times and tolerates a few
+// percent in total between both ends (RM0383 19.3.5), so 1 % is left for each
+constexpr uint32_t usartDefaultBaudTolerancePpm { 10000U };
+
+/**
+ * @brief Baud rate of Instance from the bus clock of Clocks. A rate BRR can not produce, or only with an error above
+ * TolerancePpm, is a static_assert failure
+ */
+template<USARTInstance Instance, uint32_t BaudRate, bool Over8 = false, uint32_t TolerancePpm = usartDefaultBaudTolerancePpm, ClockFrequencies Clocks = boardClockFrequencies>
+consteval USARTBaudRate getUSARTBaudRate()
+{
+    static_assert(Instance != USARTInstance::null, "[a baud rate is computed for a USART instance]");
+    constexpr uint32_t busClock { Clocks.getBusFrequency(usartRoutes[static_cast<std::size_t>(Instance)].bridge) };
+    constexpr UsartDivider divider { getUsartDivider(busClock, BaudRate, Over8) };
+    static_assert(divider.isValid, "[the baud rate is out of the BRR range for this bus clock and oversampling]");
+    static_assert(divider.errorPpm <= TolerancePpm, "[the bus clock can not produce the baud rate within the tolerance]");
+    return USARTBaudRate{ busClock, divider.brr, Over8 };
+}
+
+template<USARTInstance Instance, uint32_t BaudRate, bool Over8 = false, uint32_t TolerancePpm = usartDefaultBaudTolerancePpm, ClockFrequencies Clocks = boardClockFrequencies>
+constexpr USARTBaudRate usartBaudRate { getUSARTBaudRate<Instance, BaudRate, Over8, TolerancePpm, Clocks>() };
+
+
+class USART : public USARTParent
+{
+    public:
+
+        // Constructors & Destructor
+        explicit USART(const USARTInstance &instance, const USARTBaudRate &baudRate);
+        ~USART();
+        USART(const USART &) = delete;
+        USART &operator=(const USART &) = delete;
+
+        // Configures what changed since the last call (8N1) and enables the USART
+        USARTStatusCodes init();
+        USARTStatusCodes setBaudRate(const USARTBaudRate &baudRate);
+        bool isReady() const { return getStatus() == USARTStatusCodes::Ready; }
+
+        /**
+         * @brief Sends length bytes of data by DMA, straight from data. data must stay valid and unchanged until the
+         * callback runs, or isTransmitting() is false
+         */
+        USARTStatusCodes transmit(const uint8_t *data, const uint16_t &length, const USARTTransmitCallback &callback = nullptr, void *context = nullptr);
+        bool isTransmitting() const { return transmitting; }
+
+        // Receives into buffer, circularly, until stopReceiving. The buffer belongs to the driver meanwhile
+        USARTStatusCodes startReceiving(uint8_t *buffer, const uint16_t &size, const USARTReceiveCallback &callback, void *context = nullptr);
+        void stopReceiving();
+        // Receive stream errors and line errors (overrun, framing, noise) since the driver was created
+        uint32_t getReceiveErrors() const { return receiveErrors; }
+
+        // Dispatch from the IRQ handlers
+        void handleInterrupt();
+        static USART *getDriver(const USARTInstance &instance);
+
+    private:
+
+        // The config functions are bound at compile time: PeripheralBase::init calls them directly
+        friend USARTPeripheralBase;
+        static constexpr USARTFunctionsContainer getConfigFunctions() { return { &USART::configInstance, &USART::configBaudRate }; }
+
+        static USARTStatusCodes configInstance(const USARTInstance &instance, USART &usart);
+        static USARTStatusCodes configBaudRate(const USARTBaudRate &baudRate, USART &usart);
+        static bool configPin(IOPin &pin, const USARTPin &route);
+
+        const USARTRoute &getRoute() const { return usartRoutes[static_cast<std::size_t>(getParameterValue<USARTProperties::instance>())]; }
+        static void enableIRQ(const IRQn_Type &irq);
+
+        // Stream callbacks, context being the driver
+        static void handleReceiveStreamEvents(const uint32_t &events, void *context);
+        static void handleTransmitStreamEvents(const uint32_t &events, void *context);
+        void deliverReceivedData();
+        DMAStatusCodes startReceiveStream();
+        void updatePowerConstraint();
+
+        uint8_t *receiveBuffer { nullptr };
+        uint16_t receiveSize { 0 };
+        // Next byte of receiveBuffer to hand to the callback
+        uint16_t receivePosition { 0 };
+        USARTReceiveCallback receiveCallback { nullptr };
+        void *receiveContext { nullptr };
+        USARTTransmitCallback transmitCallback { nullptr };
+        void *transmitContext { nullptr };
+        volatile bool transmitting { false };
+        volatile uint32_t receiveErrors { 0 };
+        uint8_t powerConstraint { PowerConstraints::invalidConstraint };
+
+        // USART, DMA controller and pin port clocks, enabled together before the streams and the pins take theirs
+        PeripheralClockGroupHandle<3> clocks;
+        IOPin transmitPin;
+        IOPin receivePin;
+        DMAStream receiveStream;
+        DMAStream transmitStream;
+
+        // Driver of every instance, for the IRQ handlers
+        static std::array<USART *, 3> drivers;
+};
+
+
+#endif // __USART_H__
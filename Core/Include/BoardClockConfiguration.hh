@@ -0,0 +1,26 @@
+#ifndef __BOARDCLOCKCONFIGURATION_H__
+#define __BOARDCLOCKCONFIGURATION_H__
+
+/**
+ * @file BoardClockConfiguration.hh
+ * @brief Clock tree applied by SystemInit on the NUCLEO-F411RE. The board has no HSE crystal fitted, so the
+ * 16 MHz HSI feeds the PLL: SYSCLK = HCLK = PCLK2 = 100 MHz, PCLK1 = 50 MHz.
+ */
+
+#include <ClockTree.hh>
+#include <ClockFrequencies.hh>
+
+constexpr ClockConfiguration boardClockConfiguration
+{
+    .source = rccClockSource::HSI,
+    .sourceFrequency = HSI_FREQUENCY,
+    .sysclk = 100000000UL,
+    .hclk = 100000000UL,
+    .pclk1 = 50000000UL,
+    .pclk2 = 100000000UL,
+};
+
+// Frequencies drivers are built against: timer clocks are 100 MHz on both APB buses
+constexpr ClockFrequencies boardClockFrequencies { clockFrequencies<boardClockConfiguration> };
+
+#endif // __BOARDCLOCKCONFIGURATION_H__
@@ -0,0 +1,21 @@
+#ifndef __BOARDPINMAP_H__
+#define __BOARDPINMAP_H__
+
+/**
+ * @file BoardPinMap.hh
+ * @brief Pins used by the firmware on the NUCLEO-F411RE board. Every pin the firmware touches has to be
+ * declared here exactly once; a duplicated entry stops the build.
+ */
+
+#include <PinMap.hh>
+
+using BoardPinMap = PinMap<
+    alternateFunctionPin(GpioPort::A, GpioPin::_2, GpioSignal::usart2Tx),         // ST-LINK virtual COM port
+    alternateFunctionPin(GpioPort::A, GpioPin::_3, GpioSignal::usart2Rx),         // ST-LINK virtual COM port
+    PinAssignment{ GpioPort::A, GpioPin::_5, GpioMode::output },                  // LD2 user LED
+    alternateFunctionPin(GpioPort::A, GpioPin::_13, GpioSignal::swdio),
+    alternateFunctionPin(GpioPort::A, GpioPin::_14, GpioSignal::swclk),
+    PinAssignment{ GpioPort::C, GpioPin::_13, GpioMode::input }                   // B1 user button
+>;
+
+#endif // __BOARDPINMAP_H__
@@ -0,0 +1,593 @@
+#ifndef __HOSTSIMULATION_H__
+#define __HOSTSIMULATION_H__
+
+/**
+ * @file HostSimulation.hh
+ * @brief Register backend of the HOST_SIMULATION builds (the Tests target). Every peripheral instance is remapped from
+ * its address in stm32f411xe.h to a register block in host memory with the CMSIS layout, so the drivers run unchanged
+ * on Linux: GPIOA, RCC, USART2... and PeripheralRegisters<Peripheral, BaseAddress> all resolve to these blocks.
+ *
+ * Host memory does not react to stores. The side effects of the hardware (ready flags, BSRR, write-1-to-clear bits...)
+ * are applied by the hook of each instance, run by stepHostPeripherals() wherever the hardware would have reacted. A
+ * hook gets the registers and their values at the previous step, so it can tell which ones were written since.
+ *
+ * The DMA controllers move data at each step too: between memory and the serial line of a USART (HostSerialLine), in
+ * one step for a whole transmission and as many bytes as the line holds for a reception, and from memory to memory,
+ * a whole block per step. Host pointers do not fit in
+ * the 32-bit address registers of the streams; getBusAddress (PeripheralBaseTypes.hh) maps them through
+ * HostBusAddresses.
+ *
+ * Tests/SimulatedRegisters.hh is the other register backend of the tests. It is a Registers policy, not a remapping:
+ * its blocks are made of counting registers, so a test can assert how many bus accesses an operation costs, which
+ * the plain volatile words here can not record. The drivers that take a Registers parameter are checked there for
+ * their access counts; the ones that reach the CMSIS instances, and the application code, run here.
+ */
+
+#ifdef HOST_SIMULATION
+
+#include <stm32f411xe.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief 32-bit stand-ins for host pointers. Every 16 MiB region of host memory that is mapped gets its own top byte;
+ * 0 stays the null address. Regions start on a 1 KB boundary, so a stand-in has the alignment of its pointer within
+ * a DMA burst boundary (RM0383 9.3.11)
+ */
+struct HostBusAddresses
+{
+    static constexpr uintptr_t regionSize { 0x1000000U };
+    static constexpr uintptr_t regionAlignment { 0x400U };
+
+    static uint32_t map(const volatile void* address)
+    {
+        if(address == nullptr)
+            return 0;
+        const uintptr_t host = reinterpret_cast<uintptr_t>(address);
+        for(std::size_t i = 0; i < numberOfRegions; ++i)
+        {
+            if(host >= regions[i] && host - regions[i] < regionSize)
+                return static_cast<uint32_t>(((i + 1U) << 24U) | (host - regions[i]));
+        }
+        regions[numberOfRegions] = host & ~(regionAlignment - 1U);
+        return static_cast<uint32_t>((++numberOfRegions << 24U) | (host & (regionAlignment - 1U)));
+    }
+    static void* resolve(const uint32_t& busAddress)
+    {
+        const std::size_t region = busAddress >> 24U;
+        if(region == 0 || region > numberOfRegions)
+            return nullptr;
+        return reinterpret_cast<void*>(regions[region - 1U] + (busAddress & (regionSize - 1U)));
+    }
+
+    static inline std::array<uintptr_t, 255> regions {};
+    static inline std::size_t numberOfRegions { 0 };
+};
+
+/** @brief Far end of the wires of a USART: what it transmitted, and the bytes it is still to receive */
+struct HostSerialLine
+{
+    std::vector<uint8_t> transmitted {};
+    std::deque<uint8_t> pending {};
+
+    template<typename Bytes>
+    void send(const Bytes& bytes) { pending.insert(pending.end(), std::begin(bytes), std::end(bytes)); }
+    void clear() { transmitted.clear(); pending.clear(); }
+};
+
+inline HostSerialLine* getHostSerialLine(const USART_TypeDef* usart);
+
+/**
+ * @brief Reset values and default side effects of a peripheral type. Types without a model start zeroed and have no
+ * side effect
+ */
+template<typename Peripheral>
+struct HostPeripheralModel
+{
+    static void reset(Peripheral&, const uint32_t&) { }
+    static void hook(Peripheral&, const Peripheral&) { }
+};
+
+/** @brief BSRR sets/resets ODR and reads back as 0. IDR follows ODR on output pins; tests drive the input pins */
+template<>
+struct HostPeripheralModel<GPIO_TypeDef>
+{
+    static void reset(GPIO_TypeDef& registers, const uint32_t& baseAddress)
+    {
+        registers.MODER = baseAddress == GPIOA_BASE ? 0xA8000000U : (baseAddress == GPIOB_BASE ? 0x00000280U : 0x0U);
+        registers.OSPEEDR = baseAddress == GPIOA_BASE ? 0x0C000000U : (baseAddress == GPIOB_BASE ? 0x000000C0U : 0x0U);
+        registers.PUPDR = baseAddress == GPIOA_BASE ? 0x64000000U : (baseAddress == GPIOB_BASE ? 0x00000100U : 0x0U);
+    }
+    static void hook(GPIO_TypeDef& registers, const GPIO_TypeDef&)
+    {
+        const uint32_t bsrr = registers.BSRR;
+        registers.ODR = (static_cast<uint32_t>(registers.ODR) & ~(bsrr >> 16U)) | (bsrr & 0xFFFFU);
+        registers.BSRR = 0x0U;
+
+        uint32_t outputs { 0 };
+        for(uint32_t pin = 0; pin < 16U; ++pin)
+        {
+            if(((static_cast<uint32_t>(registers.MODER) >> (pin * 2U)) & 0x3U) == 0x1U)
+                outputs |= 0x1U << pin;
+        }
+        registers.IDR = (static_cast<uint32_t>(registers.IDR) & ~outputs) | (static_cast<uint32_t>(registers.ODR) & outputs);
+    }
+};
+
+/** @brief Oscillators and PLLs are ready as soon as they are enabled, and SWS follows SW */
+template<>
+struct HostPeripheralModel<RCC_TypeDef>
+{
+    static void reset(RCC_TypeDef& registers, const uint32_t&)
+    {
+        registers.CR = RCC_CR_HSION | RCC_CR_HSIRDY | (0x10U << RCC_CR_HSITRIM_Pos);
+        registers.PLLCFGR = 0x24003010U;
+        registers.AHB1LPENR = 0x0061900FU;
+        registers.AHB2LPENR = 0x00000080U;
+        registers.APB1LPENR = 0x10E2C80FU;
+        registers.APB2LPENR = 0x00077930U;
+        registers.CSR = 0x0E000000U;
+        registers.PLLI2SCFGR = 0x24003000U;
+    }
+    static void hook(RCC_TypeDef& registers, const RCC_TypeDef&)
+    {
+        // Every ready flag is the bit above its enable bit
+        constexpr uint32_t crEnables { RCC_CR_HSION | RCC_CR_HSEON | RCC_CR_PLLON | RCC_CR_PLLI2SON };
+        const uint32_t cr = registers.CR;
+        registers.CR = (cr & ~(crEnables << 1U)) | ((cr & crEnables) << 1U);
+        const uint32_t cfgr = registers.CFGR;
+        registers.CFGR = (cfgr & ~RCC_CFGR_SWS) | ((cfgr & RCC_CFGR_SW) << RCC_CFGR_SWS_Pos);
+        const uint32_t bdcr = registers.BDCR;
+        registers.BDCR = (bdcr & ~RCC_BDCR_LSERDY) | ((bdcr & RCC_BDCR_LSEON) << 1U);
+        const uint32_t csr = registers.CSR;
+        registers.CSR = (csr & ~RCC_CSR_LSIRDY) | ((csr & RCC_CSR_LSION) << 1U);
+    }
+};
+
+/**
+ * @brief An enabled transmitter sends every byte right away: TXE and TC stay set. Without DMA, the receiver takes the
+ * next byte of its line whenever RXNE is clear. IDLE only lasts one step: it stands for the SR then DR reads of the
+ * interrupt handler
+ */
+template<>
+struct HostPeripheralModel<USART_TypeDef>
+{
+    static void reset(USART_TypeDef& registers, const uint32_t&)
+    {
+        registers.SR = USART_SR_TXE | USART_SR_TC;
+        if(HostSerialLine* line = getHostSerialLine(&registers))
+            line->clear();
+    }
+    static void hook(USART_TypeDef& registers, const USART_TypeDef&)
+    {
+        uint32_t sr = static_cast<uint32_t>(registers.SR) & ~USART_SR_IDLE;
+        if(registers.CR1 & USART_CR1_UE)
+            sr |= USART_SR_TXE | USART_SR_TC;
+        HostSerialLine* line = getHostSerialLine(&registers);
+        const bool receiving = (registers.CR1 & (USART_CR1_UE | USART_CR1_RE)) == (USART_CR1_UE | USART_CR1_RE) && !(registers.CR3 & USART_CR3_DMAR);
+        if(receiving && line != nullptr && !line->pending.empty() && !(sr & USART_SR_RXNE))
+        {
+            registers.DR = line->pending.front();
+            line->pending.pop_front();
+            sr |= USART_SR_RXNE | (line->pending.empty() ? USART_SR_IDLE : 0U);
+        }
+        registers.SR = sr;
+    }
+};
+
+/** @brief VOS resets to scale 2. CWUF and CSBF only clear the CSR flags and read back as 0 */
+template<>
+struct HostPeripheralModel<PWR_TypeDef>
+{
+    static void reset(PWR_TypeDef& registers, const uint32_t&) { registers.CR = 0x00008000U; }
+    static void hook(PWR_TypeDef& registers, const PWR_TypeDef&)
+    {
+        const uint32_t cr = registers.CR;
+        if(cr & PWR_CR_CWUF)
+            registers.CSR = static_cast<uint32_t>(registers.CSR) & ~PWR_CSR_WUF;
+        if(cr & PWR_CR_CSBF)
+            registers.CSR = static_cast<uint32_t>(registers.CSR) & ~PWR_CSR_SBF;
+        registers.CR = cr & ~(PWR_CR_CWUF | PWR_CR_CSBF);
+    }
+};
+
+/** @brief Option bytes at their factory values. ACR is plain memory: the latency reads back as soon as it is written */
+template<>
+struct HostPeripheralModel<FLASH_TypeDef>
+{
+    static void reset(FLASH_TypeDef& registers, const uint32_t&)
+    {
+        registers.SR = 0x0U;
+        registers.CR = FLASH_CR_LOCK;
+        registers.OPTCR = 0x0FFFAAEDU;
+    }
+    static void hook(FLASH_TypeDef&, const FLASH_TypeDef&) { }
+};
+
+/** @brief Stream transfers and interrupt flags of a DMA controller. IFCR bits clear their ISR flags (write 1 to clear) */
+template<>
+struct HostPeripheralModel<DMA_TypeDef>
+{
+    static void reset(DMA_TypeDef& registers, const uint32_t& baseAddress);
+    static void hook(DMA_TypeDef& registers, const DMA_TypeDef& previous);
+};
+
+/**
+ * @brief Host register block of the instance at BaseAddress. Starts at the reset values of its model
+ */
+template<typename Peripheral, uint32_t BaseAddress>
+class HostPeripheral
+{
+    public:
+
+        using HookType = void(*)(Peripheral& registers, const Peripheral& previous);
+
+        static constexpr uint32_t baseAddress { BaseAddress };
+
+        static Peripheral* get();
+
+        // Runs the hook on the registers, then records them as the previous values of the next step
+        static void step();
+        // Back to the reset values, with the default hook
+        static void reset();
+        static void setHook(const HookType& newHook) { hook = newHook; }
+
+    private:
+
+        static_assert(sizeof(Peripheral) % sizeof(uint32_t) == 0, "[register block made of 32-bit registers]");
+
+        static void copyRegisters(Peripheral& destination, const Peripheral& source);
+
+        static inline Peripheral registers {};
+        static inline Peripheral previous {};
+        static inline HookType hook { &HostPeripheralModel<Peripheral>::hook };
+        static inline bool initialized { false };
+};
+
+template<typename Peripheral, uint32_t BaseAddress>
+inline Peripheral* HostPeripheral<Peripheral, BaseAddress>::get()
+{
+    if(!initialized)
+        reset();
+    return &registers;
+}
+
+template<typename Peripheral, uint32_t BaseAddress>
+inline void HostPeripheral<Peripheral, BaseAddress>::step()
+{
+    get();
+    if(hook != nullptr)
+        hook(registers, previous);
+    copyRegisters(previous, registers);
+}
+
+template<typename Peripheral, uint32_t BaseAddress>
+inline void HostPeripheral<Peripheral, BaseAddress>::reset()
+{
+    // Set first: a model may look the instance up while it resets it
+    initialized = true;
+    copyRegisters(registers, Peripheral{});
+    HostPeripheralModel<Peripheral>::reset(registers, BaseAddress);
+    copyRegisters(previous, registers);
+    hook = &HostPeripheralModel<Peripheral>::hook;
+}
+
+/** @brief Word by word: the CMSIS structs only have volatile members */
+template<typename Peripheral, uint32_t BaseAddress>
+inline void HostPeripheral<Peripheral, BaseAddress>::copyRegisters(Peripheral& destination, const Peripheral& source)
+{
+    volatile uint32_t* const to = reinterpret_cast<volatile uint32_t*>(&destination);
+    const volatile uint32_t* const from = reinterpret_cast<const volatile uint32_t*>(&source);
+    for(std::size_t i = 0; i < sizeof(Peripheral) / sizeof(uint32_t); ++i)
+        to[i] = from[i];
+}
+
+/** @brief Instances, or nested lists of instances, stepped and reset together */
+template<typename... Instances>
+struct HostPeripheralList
+{
+    static void step() { (Instances::step(), ...); }
+    static void reset() { (Instances::reset(), ...); }
+
+    template<typename Peripheral>
+    static Peripheral* find(const uintptr_t& baseAddress)
+    {
+        Peripheral* found { nullptr };
+        ([&]()
+        {
+            if constexpr(requires { Instances::template find<Peripheral>(baseAddress); })
+            {
+                if(found == nullptr)
+                    found = Instances::template find<Peripheral>(baseAddress);
+            }
+            else if constexpr(std::is_same_v<decltype(Instances::get()), Peripheral*>)
+            {
+                if(Instances::baseAddress == baseAddress)
+                    found = Instances::get();
+            }
+        }(), ...);
+        return found;
+    }
+};
+
+template<uint32_t BaseAddress, std::size_t... Streams>
+using HostDmaStreams = HostPeripheralList<HostPeripheral<DMA_Stream_TypeDef, BaseAddress + 0x10U + 0x18U * Streams>...>;
+
+/**
+ * @brief Transfers of the streams of the DMA controller at BaseAddress. Only the USART data registers are modelled as
+ * peripherals; a peripheral stream addressing anything else does not move
+ */
+template<uint32_t BaseAddress>
+class HostDmaController
+{
+    public:
+
+        static constexpr std::size_t numberOfStreams { 8 };
+        static constexpr uint32_t halfTransferFlag { DMA_LISR_HTIF0 };
+        static constexpr uint32_t transferCompleteFlag { DMA_LISR_TCIF0 };
+
+        static DMA_Stream_TypeDef* getStream(const std::size_t& stream);
+        static void step(DMA_TypeDef& registers);
+        static void reset() { enabledStreams = 0; }
+
+    private:
+
+        static constexpr std::array<uint32_t, 4> flagShifts { 0U, 6U, 16U, 22U };
+
+        static void stepStream(DMA_TypeDef& registers, const std::size_t& stream);
+        static void copyBlock(DMA_Stream_TypeDef& channel);
+        static void setFlags(DMA_TypeDef& registers, const std::size_t& stream, const uint32_t& flags);
+
+        // NDTR of every stream when it was enabled, reloaded in circular and double buffer modes
+        static inline std::array<uint32_t, numberOfStreams> programmedLengths {};
+        static inline uint32_t enabledStreams { 0 };
+};
+
+/**
+ * @brief Instances remapped below, i.e. the ones the drivers reach through the CMSIS macros, and the ones they only
+ * reach through PeripheralRegisters (EXTI, SYSCFG, PWR, FLASH, TIM1 and the NVIC/SCB core blocks). An instance missing
+ * here would keep the state of the previous test across resetHostPeripherals()
+ */
+using HostPeripherals = HostPeripheralList<HostPeripheral<GPIO_TypeDef, GPIOA_BASE>, HostPeripheral<GPIO_TypeDef, GPIOB_BASE>,
+                                           HostPeripheral<GPIO_TypeDef, GPIOC_BASE>, HostPeripheral<GPIO_TypeDef, GPIOD_BASE>,
+                                           HostPeripheral<GPIO_TypeDef, GPIOE_BASE>, HostPeripheral<GPIO_TypeDef, GPIOH_BASE>,
+                                           HostPeripheral<RCC_TypeDef, RCC_BASE>, HostPeripheral<USART_TypeDef, USART1_BASE>,
+                                           HostPeripheral<USART_TypeDef, USART2_BASE>, HostPeripheral<USART_TypeDef, USART6_BASE>,
+                                           HostDmaStreams<DMA1_BASE, 0, 1, 2, 3, 4, 5, 6, 7>, HostDmaStreams<DMA2_BASE, 0, 1, 2, 3, 4, 5, 6, 7>,
+                                           HostPeripheral<DMA_TypeDef, DMA1_BASE>, HostPeripheral<DMA_TypeDef, DMA2_BASE>,
+                                           HostPeripheral<EXTI_TypeDef, EXTI_BASE>, HostPeripheral<SYSCFG_TypeDef, SYSCFG_BASE>,
+                                           HostPeripheral<PWR_TypeDef, PWR_BASE>, HostPeripheral<FLASH_TypeDef, FLASH_R_BASE>,
+                                           HostPeripheral<TIM_TypeDef, TIM1_BASE>, HostPeripheral<NVIC_Type, NVIC_BASE>,
+                                           HostPeripheral<SCB_Type, SCB_BASE>>;
+
+inline HostSerialLine* getHostSerialLine(const USART_TypeDef* usart)
+{
+    static std::array<HostSerialLine, 3> lines {};
+    if(usart == HostPeripheral<USART_TypeDef, USART1_BASE>::get())
+        return &lines[0];
+    if(usart == HostPeripheral<USART_TypeDef, USART2_BASE>::get())
+        return &lines[1];
+    if(usart == HostPeripheral<USART_TypeDef, USART6_BASE>::get())
+        return &lines[2];
+    return nullptr;
+}
+
+template<uint32_t BaseAddress>
+inline DMA_Stream_TypeDef* HostDmaController<BaseAddress>::getStream(const std::size_t& stream)
+{
+    return HostPeripherals::find<DMA_Stream_TypeDef>(BaseAddress + 0x10U + 0x18U * stream);
+}
+
+template<uint32_t BaseAddress>
+inline void HostDmaController<BaseAddress>::step(DMA_TypeDef& registers)
+{
+    registers.LISR = static_cast<uint32_t>(registers.LISR) & ~static_cast<uint32_t>(registers.LIFCR);
+    registers.HISR = static_cast<uint32_t>(registers.HISR) & ~static_cast<uint32_t>(registers.HIFCR);
+    registers.LIFCR = 0x0U;
+    registers.HIFCR = 0x0U;
+    for(std::size_t stream = 0; stream < numberOfStreams; ++stream)
+        stepStream(registers, stream);
+}
+
+/**
+ * @brief Memory to USART: the whole block is sent. USART to memory: the pending bytes of the line are received, up to
+ * the end of the block, then IDLE is raised on the USART once the line is empty. Memory to memory: the whole block
+ * is copied
+ */
+template<uint32_t BaseAddress>
+inline void HostDmaController<BaseAddress>::stepStream(DMA_TypeDef& registers, const std::size_t& stream)
+{
+    DMA_Stream_TypeDef& channel = *getStream(stream);
+    const uint32_t bit = 0x1U << stream;
+    if(!(channel.CR & DMA_SxCR_EN))
+    {
+        enabledStreams &= ~bit;
+        return;
+    }
+    if(!(enabledStreams & bit))
+    {
+        programmedLengths[stream] = channel.NDTR;
+        enabledStreams |= bit;
+    }
+    if((channel.CR & DMA_SxCR_DIR) == DMA_SxCR_DIR_1)
+    {
+        copyBlock(channel);
+        setFlags(registers, stream, halfTransferFlag | transferCompleteFlag);
+        return;
+    }
+
+    uint8_t* const peripheral = static_cast<uint8_t*>(HostBusAddresses::resolve(static_cast<uint32_t>(channel.PAR)));
+    USART_TypeDef* const usart = peripheral == nullptr ? nullptr : reinterpret_cast<USART_TypeDef*>(peripheral - offsetof(USART_TypeDef, DR));
+    HostSerialLine* const line = getHostSerialLine(usart);
+    if(line == nullptr || !(usart->CR1 & USART_CR1_UE))
+        return;
+
+    const uint32_t direction = channel.CR & DMA_SxCR_DIR;
+    const uint32_t length = programmedLengths[stream];
+    const bool reload = channel.CR & (DMA_SxCR_CIRC | DMA_SxCR_DBM);
+    uint32_t flags { 0 };
+    auto endOfBlock = [&]()
+    {
+        flags |= transferCompleteFlag;
+        if(!reload)
+        {
+            channel.CR = static_cast<uint32_t>(channel.CR) & ~DMA_SxCR_EN;
+            return;
+        }
+        channel.NDTR = length;
+        if(channel.CR & DMA_SxCR_DBM)
+            channel.CR = static_cast<uint32_t>(channel.CR) ^ DMA_SxCR_CT;
+    };
+    auto memory = [&]() { return static_cast<uint8_t*>(HostBusAddresses::resolve(static_cast<uint32_t>((channel.CR & DMA_SxCR_CT) ? channel.M1AR : channel.M0AR))); };
+
+    if(direction == DMA_SxCR_DIR_0 && (usart->CR3 & USART_CR3_DMAT) && (usart->CR1 & USART_CR1_TE))
+    {
+        const uint8_t* const source = memory();
+        for(uint32_t i = 0; i < channel.NDTR; ++i)
+            line->transmitted.push_back(source[(channel.CR & DMA_SxCR_MINC) ? i : 0U]);
+        channel.NDTR = 0;
+        flags |= halfTransferFlag;
+        endOfBlock();
+    }
+    else if(direction == 0x0U && (usart->CR3 & USART_CR3_DMAR) && (usart->CR1 & USART_CR1_RE))
+    {
+        bool received { false };
+        while((channel.CR & DMA_SxCR_EN) && !line->pending.empty())
+        {
+            const uint32_t position = (channel.CR & DMA_SxCR_MINC) ? length - channel.NDTR : 0U;
+            memory()[position] = line->pending.front();
+            line->pending.pop_front();
+            usart->DR = memory()[position];
+            received = true;
+            channel.NDTR = channel.NDTR - 1U;
+            if(channel.NDTR == length / 2U)
+                flags |= halfTransferFlag;
+            if(channel.NDTR == 0)
+                endOfBlock();
+        }
+        if(received && line->pending.empty())
+            usart->SR = static_cast<uint32_t>(usart->SR) | USART_SR_IDLE;
+    }
+    setFlags(registers, stream, flags);
+}
+
+/**
+ * @brief NDTR items of PSIZE from PAR to M0AR, packed or unpacked to MSIZE as the FIFO does. A source without PINC
+ * repeats its first item (fills)
+ */
+template<uint32_t BaseAddress>
+inline void HostDmaController<BaseAddress>::copyBlock(DMA_Stream_TypeDef& channel)
+{
+    const uint8_t* const source = static_cast<const uint8_t*>(HostBusAddresses::resolve(static_cast<uint32_t>(channel.PAR)));
+    uint8_t* const destination = static_cast<uint8_t*>(HostBusAddresses::resolve(static_cast<uint32_t>(channel.M0AR)));
+    const uint32_t sourceItem = 0x1U << ((channel.CR & DMA_SxCR_PSIZE) >> DMA_SxCR_PSIZE_Pos);
+    const uint32_t destinationItem = 0x1U << ((channel.CR & DMA_SxCR_MSIZE) >> DMA_SxCR_MSIZE_Pos);
+    const uint32_t bytes = channel.NDTR * sourceItem;
+    const bool sourceIncrement = channel.CR & DMA_SxCR_PINC;
+    const bool destinationIncrement = channel.CR & DMA_SxCR_MINC;
+    for(uint32_t i = 0; i < bytes; ++i)
+        destination[destinationIncrement ? i : i % destinationItem] = source[sourceIncrement ? i : i % sourceItem];
+    channel.NDTR = 0;
+    channel.CR = static_cast<uint32_t>(channel.CR) & ~DMA_SxCR_EN;
+}
+
+template<uint32_t BaseAddress>
+inline void HostDmaController<BaseAddress>::setFlags(DMA_TypeDef& registers, const std::size_t& stream, const uint32_t& flags)
+{
+    volatile uint32_t& isr = stream < 4U ? registers.LISR : registers.HISR;
+    isr = static_cast<uint32_t>(isr) | (flags << flagShifts[stream % 4U]);
+}
+
+inline void HostPeripheralModel<DMA_TypeDef>::reset(DMA_TypeDef&, const uint32_t& baseAddress)
+{
+    if(baseAddress == DMA1_BASE)
+        HostDmaController<DMA1_BASE>::reset();
+    else
+        HostDmaController<DMA2_BASE>::reset();
+}
+
+inline void HostPeripheralModel<DMA_TypeDef>::hook(DMA_TypeDef& registers, const DMA_TypeDef&)
+{
+    if(&registers == HostPeripheral<DMA_TypeDef, DMA1_BASE>::get())
+        HostDmaController<DMA1_BASE>::step(registers);
+    else
+        HostDmaController<DMA2_BASE>::step(registers);
+}
+
+inline void stepHostPeripherals() { HostPeripherals::step(); }
+inline void resetHostPeripherals() { HostPeripherals::reset(); }
+
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef GPIOE
+#undef GPIOH
+#undef RCC
+#undef USART1
+#undef USART2
+#undef USART6
+#undef DMA1
+#undef DMA2
+#undef EXTI
+#undef SYSCFG
+#undef PWR
+#undef FLASH
+#undef TIM1
+#undef DMA1_Stream0
+#undef DMA1_Stream1
+#undef DMA1_Stream2
+#undef DMA1_Stream3
+#undef DMA1_Stream4
+#undef DMA1_Stream5
+#undef DMA1_Stream6
+#undef DMA1_Stream7
+#undef DMA2_Stream0
+#undef DMA2_Stream1
+#undef DMA2_Stream2
+#undef DMA2_Stream3
+#undef DMA2_Stream4
+#undef DMA2_Stream5
+#undef DMA2_Stream6
+#undef DMA2_Stream7
+#define GPIOA (HostPeripheral<GPIO_TypeDef, GPIOA_BASE>::get())
+#define GPIOB (HostPeripheral<GPIO_TypeDef, GPIOB_BASE>::get())
+#define GPIOC (HostPeripheral<GPIO_TypeDef, GPIOC_BASE>::get())
+#define GPIOD (HostPeripheral<GPIO_TypeDef, GPIOD_BASE>::get())
+#define GPIOE (HostPeripheral<GPIO_TypeDef, GPIOE_BASE>::get())
+#define GPIOH (HostPeripheral<GPIO_TypeDef, GPIOH_BASE>::get())
+#define RCC (HostPeripheral<RCC_TypeDef, RCC_BASE>::get())
+#define USART1 (HostPeripheral<USART_TypeDef, USART1_BASE>::get())
+#define USART2 (HostPeripheral<USART_TypeDef, USART2_BASE>::get())
+#define USART6 (HostPeripheral<USART_TypeDef, USART6_BASE>::get())
+#define DMA1 (HostPeripheral<DMA_TypeDef, DMA1_BASE>::get())
+#define DMA2 (HostPeripheral<DMA_TypeDef, DMA2_BASE>::get())
+#define EXTI (HostPeripheral<EXTI_TypeDef, EXTI_BASE>::get())
+#define SYSCFG (HostPeripheral<SYSCFG_TypeDef, SYSCFG_BASE>::get())
+#define PWR (HostPeripheral<PWR_TypeDef, PWR_BASE>::get())
+#define FLASH (HostPeripheral<FLASH_TypeDef, FLASH_R_BASE>::get())
+#define TIM1 (HostPeripheral<TIM_TypeDef, TIM1_BASE>::get())
+#define DMA1_Stream0 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream0_BASE>::get())
+#define DMA1_Stream1 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream1_BASE>::get())
+#define DMA1_Stream2 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream2_BASE>::get())
+#define DMA1_Stream3 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream3_BASE>::get())
+#define DMA1_Stream4 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream4_BASE>::get())
+#define DMA1_Stream5 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream5_BASE>::get())
+#define DMA1_Stream6 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream6_BASE>::get())
+#define DMA1_Stream7 (HostPeripheral<DMA_Stream_TypeDef, DMA1_Stream7_BASE>::get())
+#define DMA2_Stream0 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream0_BASE>::get())
+#define DMA2_Stream1 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream1_BASE>::get())
+#define DMA2_Stream2 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream2_BASE>::get())
+#define DMA2_Stream3 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream3_BASE>::get())
+#define DMA2_Stream4 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream4_BASE>::get())
+#define DMA2_Stream5 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream5_BASE>::get())
+#define DMA2_Stream6 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream6_BASE>::get())
+#define DMA2_Stream7 (HostPeripheral<DMA_Stream_TypeDef, DMA2_Stream7_BASE>::get())
+
+#endif // HOST_SIMULATION
+
+#endif // __HOSTSIMULATION_H__
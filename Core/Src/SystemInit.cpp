@@ -0,0 +1,16 @@
+#include <system.h>
+#include <BoardClockConfiguration.hh>
+
+/**
+ * @brief Called from Reset_Handler before the static constructors and main.
+ * Enables the FPU (the firmware is built with -mfloat-abi=hard) and switches to the board clock tree.
+ * If an oscillator or the PLL does not start, the core keeps running from the HSI.
+ */
+extern "C" void SystemInit(void)
+{
+    SCB->CPACR = static_cast<uint32_t>(SCB->CPACR) | (0xFU << 20U);
+    __DSB();
+    __ISB();
+
+    ClockTree<>::apply<boardClockConfiguration>();
+}
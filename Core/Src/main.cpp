@@ -3,10 +3,10 @@
 #include <string>
 #include <system.h>
 #include <PeripheralClocks.hh>
-#include <RCC.hh>
 #include <IOPin.hh>
 #include <PeripheralBaseExceptionHandler.hh>
 #include <PeripheralBase.hh>
+#include <BoardPinMap.hh>
 
 
 using namespace std::string_literals;
@@ -41,12 +41,17 @@ class Container : public ContainerBase<Members...>
         template <Parameters Index>
         auto getMemberValue();
 
+        using MaskType = ContainerMask<sizeof...(Members)>;
+
+        template <typename Type>
+        static constexpr MaskType isTypeIn();
+
         template <typename Type>
-        auto isTypeIn();
+        using TypeIndices = ContainerMaskIndices<containerTypeMask<Type, Members...>>;
 
         //<-----------------------------------------------------------------------------------------------------||----------------------------------------------------------------------------------------------------->
         template<typename Type>
-        constexpr std::vector<uint8_t> isTypeAndValueIn(const Type& arg);
+        constexpr MaskType isTypeAndValueIn(const Type& arg) const;
         
 
         constexpr uint8_t getSize() override;
@@ -199,20 +204,26 @@ auto Container<Parameters, Members...>::getMemberValue()
     return ContainerBase<Members...>::template getMemberValue<index>();
 }
 
+/**
+ * @brief Indices of the members of type Type. Depends only on the types, so it is a constant expression
+ * @tparam Type The type to search for
+ */
 template <EnumType Parameters, typename... Members>
 template <typename Type>
-auto Container<Parameters, Members...>::isTypeIn()
+constexpr typename Container<Parameters, Members...>::MaskType Container<Parameters, Members...>::isTypeIn()
 {
-    std::vector<uint8_t> result;
-    ContainerBase<Members...>::template isTypeIn<0, Type>(result);
-    return result;
+    return ContainerBase<Members...>::template isTypeIn<Type>();
 }
 
+/**
+ * @brief Indices of the members of the type of arg holding its value. Evaluated at compile time on a constexpr container
+ * @param arg The value to search for
+ */
 template <EnumType Parameters, typename... Members>
 template <typename Type>
-constexpr std::vector<uint8_t> Container<Parameters, Members...>::isTypeAndValueIn(const Type &arg)
+constexpr typename Container<Parameters, Members...>::MaskType Container<Parameters, Members...>::isTypeAndValueIn(const Type &arg) const
 {
-    std::vector<uint8_t> result;
+    MaskType result {};
     ContainerBase<Members...>::template isTypeAndValueIn<0, Type>(arg, result);
     return result;
 }
@@ -2,6 +2,7 @@
 #define __CONTAINERBASE_H__
 
 #include <GeneralConcepts.hh>
+#include <ContainerMask.hh>
 #include <tuple>
 #include <type_traits>
 #include <concepts>
@@ -46,11 +47,11 @@ class ContainerBase
         template <std::size_t Index>
         auto getMemberValue();
 
-        template<std::size_t I = 0, typename Arg>
-        constexpr void isTypeIn(std::vector<uint8_t>& vect);
+        template<typename Arg>
+        static constexpr ContainerMask<sizeof...(Members)> isTypeIn();
 
         template<std::size_t I = 0, typename Arg>
-        constexpr void isTypeAndValueIn(const Arg& arg, std::vector<uint8_t>& vect);
+        constexpr void isTypeAndValueIn(const Arg& arg, ContainerMask<sizeof...(Members)>& mask) const;
 
         /**
         * @brief Pure virtual function to get the size of the container.
@@ -307,23 +308,14 @@ void ContainerBase<Members...>::setMemberValue(T &&param)
 /**
  * @brief Checks if a type is in the container.
  * 
- * @tparam I The index to start the search from.
  * @tparam Arg The type to search for.
- * @param vect A vector to store the indices where the type is found.
+ * @return The indices where the type is found, known at compile time.
  */
 template<typename... Members>
-template<std::size_t I, typename Arg>
-constexpr void ContainerBase<Members...>::isTypeIn(std::vector<uint8_t>& vect)
+template<typename Arg>
+constexpr ContainerMask<sizeof...(Members)> ContainerBase<Members...>::isTypeIn()
 {
-    if constexpr(I < sizeof...(Members))            
-    {
-        //auto&& member = std::get<I>(std::move(members));
-        auto&& member = std::get<I>(members);
-        using MemberType = std::decay_t<decltype(member)>;
-        if constexpr (std::is_same_v<MemberType, Arg>)
-            vect.push_back(static_cast<uint8_t>(I));
-        isTypeIn<I+1, Arg>(vect); 
-    }
+    return containerTypeMask<Arg, Members...>;
 }
 
 
@@ -334,15 +326,14 @@ constexpr void ContainerBase<Members...>::isTypeIn(std::vector<uint8_t>& vect)
  * @tparam I The index to start the search from.
  * @tparam Arg The type and value to search for.
  * @param arg The value to search for.
- * @param vect A vector to store the indices where the type and value is found.
+ * @param mask A mask to store the indices where the type and value is found.
  */
 template<typename... Members>
 template<std::size_t I, typename Arg>
-constexpr void ContainerBase<Members...>::isTypeAndValueIn(const Arg& arg, std::vector<uint8_t>& vect)
+constexpr void ContainerBase<Members...>::isTypeAndValueIn(const Arg& arg, ContainerMask<sizeof...(Members)>& mask) const
 {
     if constexpr(I < sizeof...(Members))            
     {
-        //auto&& member = std::get<I>(std::move(members));
         auto&& member = std::get<I>(members);
         using MemberType = std::decay_t<decltype(member)>;
         using ArgType = std::decay_t<decltype(arg)>;
@@ -350,10 +341,10 @@ constexpr void ContainerBase<Members...>::isTypeAndValueIn(const Arg& arg, std::
         {
             if (arg == member)
             {
-                vect.push_back(static_cast<uint8_t>(I));
+                mask.set(I);
             }
         }
-        isTypeAndValueIn<I+1, Arg>(arg, vect); 
+        isTypeAndValueIn<I+1, Arg>(arg, mask); 
     }
 }
 
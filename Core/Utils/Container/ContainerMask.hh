@@ -0,0 +1,72 @@
+#ifndef __CONTAINERMASK_H__
+#define __CONTAINERMASK_H__
+
+#include <bit>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @brief Fixed-capacity set of member indices of a container, one bit per member. Result of the type and value queries
+ * of Container and FlatContainer: it lives in a register, so a query costs no allocation and can be evaluated at
+ * compile time
+ * @tparam Size Number of members of the container
+ */
+template <std::size_t Size>
+struct ContainerMask
+{
+    static_assert(Size <= 32, "[a container mask holds up to 32 members]");
+
+    uint32_t bits { 0 };
+
+    constexpr bool test(const std::size_t& index) const { return (bits >> index) & 0x1U; }
+    constexpr bool any() const { return bits != 0; }
+    constexpr bool none() const { return bits == 0; }
+    constexpr uint8_t count() const { return static_cast<uint8_t>(std::popcount(bits)); }
+    /** @brief Lowest index in the set, or Size if it is empty */
+    constexpr uint8_t first() const { return bits ? static_cast<uint8_t>(std::countr_zero(bits)) : static_cast<uint8_t>(Size); }
+    constexpr void set(const std::size_t& index) { bits |= 0x1U << index; }
+    static constexpr std::size_t size() { return Size; }
+
+    constexpr bool operator==(const ContainerMask& other) const = default;
+    constexpr ContainerMask operator&(const ContainerMask& other) const { return ContainerMask{ bits & other.bits }; }
+    constexpr ContainerMask operator|(const ContainerMask& other) const { return ContainerMask{ bits | other.bits }; }
+};
+
+/** @brief Indices of the members of type Type */
+template <typename Type, typename... Members>
+constexpr ContainerMask<sizeof...(Members)> containerTypeMask = []<std::size_t... Indices>(std::index_sequence<Indices...>)
+{
+    ContainerMask<sizeof...(Members)> mask {};
+    ((std::is_same_v<std::decay_t<Members>, std::decay_t<Type>> ? mask.set(Indices) : void()), ...);
+    return mask;
+}(std::index_sequence_for<Members...>{});
+
+/** @brief Indices in Mask, in increasing order */
+template <auto Mask>
+constexpr std::array<uint8_t, Mask.count()> containerMaskIndexArray = []()
+{
+    std::array<uint8_t, Mask.count()> indices {};
+    std::size_t position { 0 };
+    for(std::size_t i = 0; i < Mask.size(); ++i)
+    {
+        if(Mask.test(i))
+            indices[position++] = static_cast<uint8_t>(i);
+    }
+    return indices;
+}();
+
+template <auto Mask, std::size_t... Positions>
+constexpr auto makeContainerMaskIndices(std::index_sequence<Positions...>)
+{
+    return std::index_sequence<containerMaskIndexArray<Mask>[Positions]...>{};
+}
+
+/** @brief std::index_sequence of the indices in Mask, to unroll an operation over them at compile time */
+template <auto Mask>
+using ContainerMaskIndices = decltype(makeContainerMaskIndices<Mask>(std::make_index_sequence<Mask.count()>{}));
+
+
+#endif // __CONTAINERMASK_H__
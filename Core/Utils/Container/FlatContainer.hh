@@ -0,0 +1,195 @@
+#ifndef __FLATCONTAINER_H__
+#define __FLATCONTAINER_H__
+
+#include <GeneralConcepts.hh>
+#include <ContainerMask.hh>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @brief One member of a FlatContainer. The index keeps leaves of the same type distinct
+ * @tparam Index Position of the member in the container
+ * @tparam Member Type of the member
+ */
+template <std::size_t Index, typename Member>
+struct FlatContainerLeaf
+{
+    Member value;
+};
+
+template <typename Indices, typename... Members>
+struct FlatContainerStorage;
+
+/** @brief Every member as a base class, laid out in declaration order exactly as the fields of a plain struct */
+template <std::size_t... Indices, typename... Members>
+struct FlatContainerStorage<std::index_sequence<Indices...>, Members...> : FlatContainerLeaf<Indices, Members>... { };
+
+/**
+ * @brief Non-polymorphic replacement of Container: an aggregate labelled tuple, without vptr, that is trivially copyable
+ * whenever its members are. It can be constant-initialized and placed in .rodata:
+ *
+ *     constexpr FlatContainer<uartProperties, uint32_t, uartParity> uartSettings { 115200, uartParity::none };
+ *
+ * @tparam Parameters: is an enum class that contains the labels for all the members in the container, plus, one extra mandatory member __length
+ * @tparam Members: types of the members, in the order of the labels
+ */
+template <EnumType Parameters, typename... Members>
+struct FlatContainer : FlatContainerStorage<std::index_sequence_for<Members...>, Members...>
+{
+    static_assert(
+        sizeof...(Members) == static_cast<std::size_t>(Parameters::__length),
+        "[number of parameters in the enum doesn't match the class's arguments]"
+    );
+
+    template <Parameters Index>
+    using MemberType = std::tuple_element_t<static_cast<std::size_t>(Index), std::tuple<Members...>>;
+
+    using MaskType = ContainerMask<sizeof...(Members)>;
+
+    template <typename Type>
+    using TypeIndices = ContainerMaskIndices<containerTypeMask<Type, Members...>>;
+
+    static constexpr uint8_t getSize() { return sizeof...(Members); }
+
+    template <typename Type>
+    static constexpr MaskType isTypeIn() { return containerTypeMask<Type, Members...>; }
+
+    template <typename Type>
+    constexpr MaskType isTypeAndValueIn(const Type& arg) const;
+
+    template <Parameters Index>
+    constexpr auto& getMemberValue();
+
+    template <Parameters Index>
+    constexpr const auto& getMemberValue() const;
+
+    template <Parameters Index, typename T>
+    constexpr void setMemberValue(T&& param);
+
+    template <typename... Args>
+    constexpr void setAllMemberValues(Args&&... args);
+
+    template <typename... Args>
+    constexpr void setMembersValues(Args&&... args);
+
+    template <typename Action, typename... ActionArgs>
+    constexpr void applyToAll(const Action& action, ActionArgs&&... actionArguments);
+
+    template <typename Action, typename... ActionArgs>
+    constexpr void applyToEach(const Action& action, ActionArgs&&... arguments);
+
+    private:
+
+        template <std::size_t Index>
+        constexpr auto& getLeaf() { return static_cast<FlatContainerLeaf<Index, std::tuple_element_t<Index, std::tuple<Members...>>>&>(*this).value; }
+
+        template <std::size_t Index>
+        constexpr const auto& getLeaf() const { return static_cast<const FlatContainerLeaf<Index, std::tuple_element_t<Index, std::tuple<Members...>>>&>(*this).value; }
+
+        template <typename Arg, std::size_t... Indices>
+        constexpr void setMatchingMembers(const Arg& arg, std::index_sequence<Indices...>);
+};
+
+/** @brief Reference to the member labelled Index */
+template <EnumType Parameters, typename... Members>
+template <Parameters Index>
+constexpr auto& FlatContainer<Parameters, Members...>::getMemberValue()
+{
+    static_assert(Index < Parameters::__length, "out of bounds");
+    return getLeaf<static_cast<std::size_t>(Index)>();
+}
+
+template <EnumType Parameters, typename... Members>
+template <Parameters Index>
+constexpr const auto& FlatContainer<Parameters, Members...>::getMemberValue() const
+{
+    static_assert(Index < Parameters::__length, "out of bounds");
+    return getLeaf<static_cast<std::size_t>(Index)>();
+}
+
+template <EnumType Parameters, typename... Members>
+template <Parameters Index, typename T>
+constexpr void FlatContainer<Parameters, Members...>::setMemberValue(T&& param)
+{
+    static_assert(Index < Parameters::__length, "out of bounds");
+    getLeaf<static_cast<std::size_t>(Index)>() = std::forward<T>(param);
+}
+
+/** @brief Assigns every member, in label order */
+template <EnumType Parameters, typename... Members>
+template <typename... Args>
+constexpr void FlatContainer<Parameters, Members...>::setAllMemberValues(Args&&... args)
+{
+    static_assert((sizeof...(Args) == sizeof...(Members)),
+                "The number of parameters should be equal to the number of members in the container");
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        ((getLeaf<Indices>() = std::forward<Args>(args)), ...);
+    }(std::index_sequence_for<Members...>{});
+}
+
+/** @brief Assigns each argument to every member of the same type, as Container::setMembersValues */
+template <EnumType Parameters, typename... Members>
+template <typename... Args>
+constexpr void FlatContainer<Parameters, Members...>::setMembersValues(Args&&... args)
+{
+    static_assert(sizeof...(args) <= sizeof...(Members), "out of bounds");
+    (setMatchingMembers(args, std::index_sequence_for<Members...>{}), ...);
+}
+
+/**
+ * @brief Applies action(member, actionArguments...) to every member, in label order
+ */
+template <EnumType Parameters, typename... Members>
+template <typename Action, typename... ActionArgs>
+constexpr void FlatContainer<Parameters, Members...>::applyToAll(const Action& action, ActionArgs&&... actionArguments)
+{
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        (action(getLeaf<Indices>(), actionArguments...), ...);
+    }(std::index_sequence_for<Members...>{});
+}
+
+/**
+ * @brief Applies action(member_i, argument_i) to every member, one argument per member
+ */
+template <EnumType Parameters, typename... Members>
+template <typename Action, typename... ActionArgs>
+constexpr void FlatContainer<Parameters, Members...>::applyToEach(const Action& action, ActionArgs&&... arguments)
+{
+    static_assert(sizeof...(Members) == sizeof...(arguments), "Number of arguments must match the number of elements in the container");
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        (action(getLeaf<Indices>(), std::forward<ActionArgs>(arguments)), ...);
+    }(std::index_sequence_for<Members...>{});
+}
+
+/** @brief Indices of the members of the type of arg holding its value. A constant expression on a constexpr container */
+template <EnumType Parameters, typename... Members>
+template <typename Type>
+constexpr typename FlatContainer<Parameters, Members...>::MaskType FlatContainer<Parameters, Members...>::isTypeAndValueIn(const Type& arg) const
+{
+    MaskType mask {};
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        ((getLeaf<Indices>() == arg ? mask.set(Indices) : void()), ...);
+    }(TypeIndices<Type>{});
+    return mask;
+}
+
+template <EnumType Parameters, typename... Members>
+template <typename Arg, std::size_t... Indices>
+constexpr void FlatContainer<Parameters, Members...>::setMatchingMembers(const Arg& arg, std::index_sequence<Indices...>)
+{
+    ([&]()
+    {
+        if constexpr (std::is_same_v<std::decay_t<decltype(getLeaf<Indices>())>, std::decay_t<Arg>>)
+            getLeaf<Indices>() = arg;
+    }(), ...);
+}
+
+
+#endif // __FLATCONTAINER_H__
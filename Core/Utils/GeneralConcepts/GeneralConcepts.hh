@@ -19,7 +19,8 @@ concept STM32Peripheral =
 (
     std::is_same_v<T, GPIO_TypeDef> ||
     std::is_same_v<T, USART_TypeDef> ||
-    std::is_same_v<T, RCC_TypeDef>
+    std::is_same_v<T, RCC_TypeDef> ||
+    std::is_same_v<T, DMA_Stream_TypeDef>
 );
 
 
@@ -0,0 +1,158 @@
+#ifndef __RINGBUFFER_H__
+#define __RINGBUFFER_H__
+
+/**
+ * @file RingBuffer.hh
+ * @brief Lock-free single-producer/single-consumer queue, for byte streams between an ISR and thread context (either
+ * way). Each index is written by one side only, with a single aligned 32-bit store: on the Cortex-M4 that is atomic
+ * without LDREX/STREX, so no interrupt is ever masked. The release store of an index, paired with the acquire load on
+ * the other side, makes the slots written before it visible first (a DMB on the M4).
+ *
+ * The indices run freely and wrap at 2^32; the slot of an index is its low bits, hence the power-of-two capacity and
+ * no slot kept empty to tell full from empty. The span accessors expose the contiguous free or filled slots in place,
+ * so a DMA transfer can fill or drain the queue directly and commit the count afterwards.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+/**
+ * @brief Fixed-capacity SPSC queue
+ *
+ * @tparam T Element type, copied with memcpy semantics
+ * @tparam Capacity Number of elements, a power of two
+ */
+template<typename T, std::size_t Capacity>
+class RingBuffer
+{
+    public:
+
+        static constexpr std::size_t capacity { Capacity };
+
+        //<---------------------------------------------- Producer side ---------------------------------------------->//
+        bool push(const T& value);
+        // As many of values as fit. Returns how many were queued
+        std::size_t push(std::span<const T> values);
+        // Free slots up to the end of the storage: fill some of them, then commitWrite
+        std::span<T> getWriteSpan();
+        void commitWrite(const std::size_t& count);
+        //<---------------------------------------------------------------------------------------------------------->//
+
+        //<---------------------------------------------- Consumer side ---------------------------------------------->//
+        bool pop(T& value);
+        // Up to values.size() elements. Returns how many were taken
+        std::size_t pop(std::span<T> values);
+        // Queued elements up to the end of the storage: read some of them, then commitRead
+        std::span<const T> getReadSpan() const;
+        void commitRead(const std::size_t& count);
+        //<---------------------------------------------------------------------------------------------------------->//
+
+        // Snapshots, exact only from a side that is not being run concurrently by the other
+        std::size_t getSize() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+        bool isEmpty() const { return getSize() == 0; }
+        bool isFull() const { return getSize() == Capacity; }
+
+    private:
+
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1U)) == 0, "[capacity has to be a power of two]");
+        static_assert(Capacity <= (std::size_t{ 0x1U } << 31U), "[the free-running 32-bit indices need capacity <= 2^31]");
+        static_assert(std::is_trivially_copyable_v<T>, "[elements are copied as plain memory]");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free, "[indices have to be single loads and stores]");
+
+        static constexpr uint32_t indexMask { static_cast<uint32_t>(Capacity - 1U) };
+
+        std::array<T, Capacity> slots {};
+        // Next slot to write. Only stored by the producer
+        std::atomic<uint32_t> head { 0 };
+        // Next slot to read. Only stored by the consumer
+        std::atomic<uint32_t> tail { 0 };
+};
+
+template<typename T, std::size_t Capacity>
+inline bool RingBuffer<T, Capacity>::push(const T& value)
+{
+    const uint32_t writeIndex = head.load(std::memory_order_relaxed);
+    if(writeIndex - tail.load(std::memory_order_acquire) == Capacity)
+        return false;
+    slots[writeIndex & indexMask] = value;
+    head.store(writeIndex + 1U, std::memory_order_release);
+    return true;
+}
+
+/** @brief Copies in at most two blocks (before and after the wrap) and publishes them with a single index store */
+template<typename T, std::size_t Capacity>
+inline std::size_t RingBuffer<T, Capacity>::push(std::span<const T> values)
+{
+    const uint32_t writeIndex = head.load(std::memory_order_relaxed);
+    const std::size_t count = std::min<std::size_t>(values.size(), Capacity - (writeIndex - tail.load(std::memory_order_acquire)));
+    const std::size_t start = writeIndex & indexMask;
+    const std::size_t first = std::min(count, Capacity - start);
+    std::copy_n(values.begin(), first, slots.begin() + start);
+    std::copy_n(values.begin() + first, count - first, slots.begin());
+    head.store(writeIndex + static_cast<uint32_t>(count), std::memory_order_release);
+    return count;
+}
+
+template<typename T, std::size_t Capacity>
+inline std::span<T> RingBuffer<T, Capacity>::getWriteSpan()
+{
+    const uint32_t writeIndex = head.load(std::memory_order_relaxed);
+    const std::size_t free = Capacity - (writeIndex - tail.load(std::memory_order_acquire));
+    const std::size_t start = writeIndex & indexMask;
+    return std::span<T>(slots.data() + start, std::min(free, Capacity - start));
+}
+
+/** @brief count has to be at most the size of the last getWriteSpan */
+template<typename T, std::size_t Capacity>
+inline void RingBuffer<T, Capacity>::commitWrite(const std::size_t& count)
+{
+    head.store(head.load(std::memory_order_relaxed) + static_cast<uint32_t>(count), std::memory_order_release);
+}
+
+template<typename T, std::size_t Capacity>
+inline bool RingBuffer<T, Capacity>::pop(T& value)
+{
+    const uint32_t readIndex = tail.load(std::memory_order_relaxed);
+    if(head.load(std::memory_order_acquire) == readIndex)
+        return false;
+    value = slots[readIndex & indexMask];
+    tail.store(readIndex + 1U, std::memory_order_release);
+    return true;
+}
+
+template<typename T, std::size_t Capacity>
+inline std::size_t RingBuffer<T, Capacity>::pop(std::span<T> values)
+{
+    const uint32_t readIndex = tail.load(std::memory_order_relaxed);
+    const std::size_t count = std::min<std::size_t>(values.size(), head.load(std::memory_order_acquire) - readIndex);
+    const std::size_t start = readIndex & indexMask;
+    const std::size_t first = std::min(count, Capacity - start);
+    std::copy_n(slots.begin() + start, first, values.begin());
+    std::copy_n(slots.begin(), count - first, values.begin() + first);
+    tail.store(readIndex + static_cast<uint32_t>(count), std::memory_order_release);
+    return count;
+}
+
+template<typename T, std::size_t Capacity>
+inline std::span<const T> RingBuffer<T, Capacity>::getReadSpan() const
+{
+    const uint32_t readIndex = tail.load(std::memory_order_relaxed);
+    const std::size_t queued = head.load(std::memory_order_acquire) - readIndex;
+    const std::size_t start = readIndex & indexMask;
+    return std::span<const T>(slots.data() + start, std::min(queued, Capacity - start));
+}
+
+/** @brief count has to be at most the size of the last getReadSpan */
+template<typename T, std::size_t Capacity>
+inline void RingBuffer<T, Capacity>::commitRead(const std::size_t& count)
+{
+    tail.store(tail.load(std::memory_order_relaxed) + static_cast<uint32_t>(count), std::memory_order_release);
+}
+
+
+#endif // __RINGBUFFER_H__
@@ -0,0 +1,67 @@
+#include <AlternateFunctionMap.hh>
+#include <StaticPin.hh>
+#include <PinMap.hh>
+#include <BoardPinMap.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+static_assert(getAlternateFunction(GpioPort::A, GpioPin::_2, GpioSignal::usart2Tx) == 7);
+static_assert(getAlternateFunction(GpioPort::A, GpioPin::_11, GpioSignal::usart6Tx) == 8);
+static_assert(getAlternateFunction(GpioPort::A, GpioPin::_11, GpioSignal::otgFsDm) == 10);
+static_assert(getAlternateFunction(GpioPort::B, GpioPin::_3, GpioSignal::spi1Sck) == 5);
+static_assert(getAlternateFunction(GpioPort::B, GpioPin::_3, GpioSignal::spi3Sck) == 6);
+static_assert(getAlternateFunction(GpioPort::B, GpioPin::_3, GpioSignal::i2c2Sda) == 9);
+static_assert(!isAlternateFunctionAvailable(GpioPort::A, GpioPin::_2, GpioSignal::usart1Tx));
+static_assert(!isAlternateFunctionAvailable(GpioPort::H, GpioPin::_0, GpioSignal::spi1Sck));
+
+static_assert(alternateFunctionPin(GpioPort::B, GpioPin::_7, GpioSignal::i2c1Sda).alternateFunction == 4);
+static_assert(alternateFunctionPin(GpioPort::B, GpioPin::_7, GpioSignal::i2c1Sda).mode == GpioMode::alternateFunction);
+static_assert(BoardPinMap::getAssignment(GpioPort::A, GpioPin::_3).alternateFunction == 7);
+static_assert(BoardPinMap::getAssignment(GpioPort::A, GpioPin::_13).alternateFunction == 0);
+
+template<typename Pin, GpioSignal Signal>
+concept RoutableSignal = requires { Pin::template setAlternateFunction<Signal>(); };
+
+using SpiClock = StaticPin<GpioPort::A, GpioPin::_5, SimulatedRegisters>;
+using UsartRx = StaticPin<GpioPort::A, GpioPin::_10, SimulatedRegisters>;
+
+static_assert(RoutableSignal<SpiClock, GpioSignal::spi1Sck>);
+static_assert(RoutableSignal<SpiClock, GpioSignal::tim2Ch1>);
+static_assert(!RoutableSignal<SpiClock, GpioSignal::usart2Tx>);
+static_assert(!RoutableSignal<UsartRx, GpioSignal::usart2Rx>);
+
+static void routingWritesOneAfrField()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    gpio->AFR[0].value = 0xFFFFFFFFU;
+    gpio->AFR[1].value = 0xFFFFFFFFU;
+    gpio->MODER.value = 0x0U;
+    gpio->resetCounters();
+
+    SpiClock::setAlternateFunction<GpioSignal::spi1Sck>();
+    TEST_ASSERT(gpio->AFR[0].value == 0xFF5FFFFFU);
+    TEST_ASSERT(gpio->AFR[0].reads == 1 && gpio->AFR[0].writes == 1);
+    TEST_ASSERT(gpio->MODER.value == 0x00000800U);
+    TEST_ASSERT(gpio->getAccesses() == 4);
+
+    // Pins 8..15 live in AFR[1]
+    gpio->resetCounters();
+    UsartRx::setAlternateFunction<GpioSignal::usart1Rx>();
+    TEST_ASSERT(gpio->AFR[1].value == 0xFFFFF7FFU);
+    TEST_ASSERT(gpio->AFR[0].reads == 0 && gpio->AFR[0].writes == 0);
+    TEST_ASSERT(gpio->MODER.value == 0x00200800U);
+}
+
+static void runtimeLookupMatchesTheTable()
+{
+    for(const AlternateFunctionEntry& entry : alternateFunctionTable)
+        TEST_ASSERT(getAlternateFunction(entry.port, entry.pin, entry.signal) == entry.alternateFunction);
+    TEST_ASSERT(getAlternateFunction(GpioPort::C, GpioPin::_13, GpioSignal::usart2Tx) == invalidAlternateFunction);
+}
+
+void runAlternateFunctionMapTests()
+{
+    routingWritesOneAfrField();
+    runtimeLookupMatchesTheTable();
+}
@@ -0,0 +1,66 @@
+#include <ClockFrequencies.hh>
+#include <BoardClockConfiguration.hh>
+#include <GpioWaveform.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+static_assert(boardClockFrequencies.sysclk == 100000000UL);
+static_assert(boardClockFrequencies.pclk1 == 50000000UL && boardClockFrequencies.pclk2 == 100000000UL);
+// APB1 is divided, so its timers run at twice PCLK1
+static_assert(boardClockFrequencies.timerClock1 == 100000000UL && boardClockFrequencies.timerClock2 == 100000000UL);
+static_assert(boardClockFrequencies.getBusFrequency(PeripheralBridges::APB1) == 50000000UL);
+static_assert(boardClockFrequencies.getBusFrequency(PeripheralBridges::AHB1) == 100000000UL);
+
+constexpr ClockConfiguration quarterBuses { .sysclk = 64000000UL, .hclk = 32000000UL, .pclk1 = 8000000UL, .pclk2 = 32000000UL };
+static_assert(clockFrequencies<quarterBuses>.timerClock1 == 16000000UL && clockFrequencies<quarterBuses>.timerClock2 == 32000000UL);
+
+template<ClockConfiguration Configuration>
+concept ProducibleClockTree = requires { clockFrequencies<Configuration>; };
+static_assert(ProducibleClockTree<quarterBuses>);
+static_assert(!ProducibleClockTree<ClockConfiguration{ .sysclk = 100000000UL, .hclk = 100000000UL, .pclk1 = 100000000UL, .pclk2 = 100000000UL }>);
+
+// 1 kHz from 100 MHz: 100000 ticks do not fit a 16-bit ARR, so the prescaler divides by 2; a 32-bit timer needs none
+static_assert(getTimerTiming(100000000UL, 1000).isValid);
+static_assert(getTimerTiming(100000000UL, 1000).prescaler == 1 && getTimerTiming(100000000UL, 1000).autoReload == 49999);
+static_assert(getTimerTiming(100000000UL, 1000, 0xFFFFFFFFU).prescaler == 0 && getTimerTiming(100000000UL, 1000, 0xFFFFFFFFU).autoReload == 99999);
+static_assert(getTimerTiming(100000000UL, 10000000UL).autoReload == 9);
+// 1 Hz: 1600 is the smallest divisor of 100e6 that fits the period in 16 bits
+static_assert(getTimerTiming(100000000UL, 1).prescaler == 1599 && getTimerTiming(100000000UL, 1).autoReload == 62499);
+// Rates that do not divide the timer clock are rejected
+static_assert(!getTimerTiming(100000000UL, 3).isValid);
+static_assert(!getTimerTiming(100000000UL, 0).isValid);
+static_assert(!getTimerTiming(100000000UL, 100000000UL).isValid);
+
+// 115200 baud from 50 MHz: USARTDIV = 27.13, BRR 27.125 -> 115207 baud, 64 ppm off
+static_assert(getUsartDivider(50000000UL, 115200U).brr == 434U && getUsartDivider(50000000UL, 115200U).errorPpm == 64U);
+static_assert(getUsartDivider(50000000UL, 115200U).baudRate == 115207U);
+// Oversampling by 8 keeps 3 fraction bits in BRR[2:0]: USARTDIV = 54.25 -> mantissa 54, fraction 2
+static_assert(getUsartDivider(50000000UL, 115200U, true).brr == ((54U << 4U) | 2U));
+// 3 Mbaud from 100 MHz: 33.33 rounds to 33, 1 % fast
+static_assert(getUsartDivider(100000000UL, 3000000U).errorPpm == 10101U);
+// Out of range: mantissa below 1, or above 12 bits
+static_assert(!getUsartDivider(50000000UL, 5000000U).isValid && getUsartDivider(50000000UL, 5000000U, true).isValid);
+static_assert(!getUsartDivider(100000000UL, 1000U).isValid && getUsartDivider(100000000UL, 2000U).isValid);
+static_assert(!getUsartDivider(50000000UL, 0).isValid);
+
+static void waveformRateIsComputedByTheCompiler()
+{
+    using Bus = GpioWaveform<GpioPort::A, 0x000FU, SimulatedRegisters>;
+    static constexpr std::array<uint32_t, 2> words { Bus::makeWord(0x000FU), Bus::makeWord(0x0000U) };
+    TIM_TypeDef* timer = SimulatedRegisters<TIM_TypeDef, TIM1_BASE>::get();
+
+    TEST_ASSERT((Bus::start<boardClockFrequencies, 2000000UL>(words.data(), words.size(), true)) == GpioWaveformStatusCodes::Ready);
+    TEST_ASSERT(timer->PSC == 0 && timer->ARR == 49);
+    Bus::stop();
+
+    TEST_ASSERT((Bus::start<boardClockFrequencies, 100UL>(words.data(), words.size())) == GpioWaveformStatusCodes::Ready);
+    TEST_ASSERT((timer->PSC + 1U) * (timer->ARR + 1U) == 1000000UL);
+    TEST_ASSERT(timer->ARR <= 0xFFFFU);
+    Bus::stop();
+}
+
+void runClockFrequenciesTests()
+{
+    waveformRateIsComputedByTheCompiler();
+}
@@ -0,0 +1,192 @@
+#include <ClockGating.hh>
+#include <PeripheralClockHandle.hh>
+#include <IOPinTypes.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using ClockGate = PeripheralClockGate<SimulatedRegisters>;
+using ClockHandle = PeripheralClockHandle<SimulatedRegisters>;
+using ClockCounter = PeripheralClockCounter<SimulatedRegisters>;
+
+static_assert(peripheralClockMask<AHB1BridgePeripherals::_GPIOA, AHB1BridgePeripherals::_GPIOC>.ahb1 == (RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOCEN));
+static_assert(peripheralClockMask<APB1BridgePeripherals::_USART2, APB2BridgePeripherals::_SYSCGF>.apb1 == RCC_APB1ENR_USART2EN);
+static_assert(peripheralClockMask<APB1BridgePeripherals::_USART2, APB2BridgePeripherals::_SYSCGF>.apb2 == RCC_APB2ENR_SYSCFGEN);
+static_assert(peripheralClockMask<AHB2BridgePeripherals::_OTGFS>.ahb2 == RCC_AHB2ENR_OTGFSEN && peripheralClockMask<AHB2BridgePeripherals::_OTGFS>.ahb1 == 0);
+static_assert(peripheralClockMask<>.isEmpty());
+
+static_assert(getPeripheralClockMask(AvailablePeripherals::_GPIOD).ahb1 == RCC_AHB1ENR_GPIODEN);
+static_assert(getPeripheralClockMask(AvailablePeripherals::_OTGFS).ahb2 == RCC_AHB2ENR_OTGFSEN);
+static_assert(getPeripheralClockMask(AvailablePeripherals::_USART2).apb1 == RCC_APB1ENR_USART2EN);
+static_assert(getPeripheralClockMask(AvailablePeripherals::_SYSCGF).apb2 == RCC_APB2ENR_SYSCFGEN);
+static_assert(getPeripheralClockMask(AvailablePeripherals::_TIM1).apb2 == RCC_APB2ENR_TIM1EN);
+static_assert(getGpioPortPeripheral(static_cast<uint32_t>(GpioPort::H)) == AvailablePeripherals::_GPIOH);
+// Ports F and G do not exist on the F411
+static_assert(!getGpioPortPeripheral(5U).has_value() && !getGpioPortPeripheral(6U).has_value() && !getGpioPortPeripheral(8U).has_value());
+
+static void batchTouchesEachRegisterOnce()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+
+    ClockGate::enable<AHB1BridgePeripherals::_GPIOA, AHB1BridgePeripherals::_GPIOB, AHB1BridgePeripherals::_GPIOD, AHB1BridgePeripherals::_DMA1,
+                      APB1BridgePeripherals::_USART2, APB1BridgePeripherals::_TIM2, APB2BridgePeripherals::_SYSCGF, APB2BridgePeripherals::_SPI1>();
+    TEST_ASSERT(rcc->AHB1ENR.value == (RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOBEN | RCC_AHB1ENR_GPIODEN | RCC_AHB1ENR_DMA1EN));
+    TEST_ASSERT(rcc->APB1ENR.value == (RCC_APB1ENR_USART2EN | RCC_APB1ENR_TIM2EN));
+    TEST_ASSERT(rcc->APB2ENR.value == (RCC_APB2ENR_SYSCFGEN | RCC_APB2ENR_SPI1EN));
+    // One read-modify-write per bridge, one read-back, nothing on AHB2
+    TEST_ASSERT(rcc->AHB1ENR.writes == 1 && rcc->APB1ENR.writes == 1 && rcc->APB2ENR.writes == 1);
+    TEST_ASSERT(rcc->APB2ENR.reads == 2);
+    TEST_ASSERT(rcc->AHB2ENR.reads == 0 && rcc->AHB2ENR.writes == 0);
+    TEST_ASSERT(rcc->getAccesses() == 7);
+    TEST_ASSERT(ClockGate::isEnabled(peripheralClockMask<AHB1BridgePeripherals::_GPIOD, APB2BridgePeripherals::_SPI1>));
+    TEST_ASSERT(!ClockGate::isEnabled(peripheralClockMask<AHB1BridgePeripherals::_GPIOD, APB2BridgePeripherals::_SPI4>));
+
+    // Other bits of the registers are kept
+    ClockGate::disable<AHB1BridgePeripherals::_GPIOB, APB2BridgePeripherals::_SPI1>();
+    TEST_ASSERT(rcc->AHB1ENR.value == (RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIODEN | RCC_AHB1ENR_DMA1EN));
+    TEST_ASSERT(rcc->APB2ENR.value == RCC_APB2ENR_SYSCFGEN);
+    TEST_ASSERT(rcc->APB1ENR.value == (RCC_APB1ENR_USART2EN | RCC_APB1ENR_TIM2EN));
+
+    ClockGate::enableLowPowerMode<AHB2BridgePeripherals::_OTGFS, APB1BridgePeripherals::_PWR>();
+    TEST_ASSERT(rcc->AHB2LPENR.value == RCC_AHB2LPENR_OTGFSLPEN && rcc->APB1LPENR.value == RCC_APB1LPENR_PWRLPEN);
+    ClockGate::disableLowPowerMode<AHB2BridgePeripherals::_OTGFS>();
+    TEST_ASSERT(rcc->AHB2LPENR.value == 0 && rcc->APB1LPENR.value == RCC_APB1LPENR_PWRLPEN);
+
+    // The reset lines are pulsed and released
+    rcc->APB1RSTR.resetCounters();
+    ClockGate::reset<APB1BridgePeripherals::_I2C1, APB1BridgePeripherals::_I2C2>();
+    TEST_ASSERT(rcc->APB1RSTR.writes == 2 && rcc->APB1RSTR.value == 0);
+}
+
+static void batchIsCheaperThanOneCallPerPeripheral()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+
+    // What one handle per peripheral does: one read-modify-write and read-back each
+    const auto enableOne = [rcc](CountingRegister& reg, const uint32_t& bit) {
+        reg = static_cast<uint32_t>(reg) | bit;
+        static_cast<void>(static_cast<uint32_t>(reg));
+    };
+    const auto oneByOne = [&]() {
+        enableOne(rcc->AHB1ENR, RCC_AHB1ENR_GPIOAEN);
+        enableOne(rcc->AHB1ENR, RCC_AHB1ENR_GPIOBEN);
+        enableOne(rcc->AHB1ENR, RCC_AHB1ENR_GPIOCEN);
+        enableOne(rcc->AHB1ENR, RCC_AHB1ENR_DMA2EN);
+        enableOne(rcc->APB1ENR, RCC_APB1ENR_USART2EN);
+        enableOne(rcc->APB1ENR, RCC_APB1ENR_PWREN);
+        enableOne(rcc->APB2ENR, RCC_APB2ENR_SYSCFGEN);
+        enableOne(rcc->APB2ENR, RCC_APB2ENR_TIM1EN);
+    };
+    const auto batched = []() {
+        ClockGate::enable<AHB1BridgePeripherals::_GPIOA, AHB1BridgePeripherals::_GPIOB, AHB1BridgePeripherals::_GPIOC, AHB1BridgePeripherals::_DMA2,
+                          APB1BridgePeripherals::_USART2, APB1BridgePeripherals::_PWR, APB2BridgePeripherals::_SYSCGF, APB2BridgePeripherals::_TIM1>();
+    };
+
+    oneByOne();
+    const uint32_t oneByOneAccesses = rcc->getAccesses();
+    const uint32_t ahb1 = rcc->AHB1ENR.value, apb1 = rcc->APB1ENR.value, apb2 = rcc->APB2ENR.value;
+    rcc->reset();
+    batched();
+    const uint32_t batchedAccesses = rcc->getAccesses();
+    TEST_ASSERT(rcc->AHB1ENR.value == ahb1 && rcc->APB1ENR.value == apb1 && rcc->APB2ENR.value == apb2);
+    TEST_ASSERT(oneByOneAccesses == 24 && batchedAccesses == 7);
+
+    const std::size_t iterations { 1000000 };
+    const double oneByOneTime = benchmarkNanoseconds(iterations, [&](const std::size_t&) { oneByOne(); });
+    const double batchedTime = benchmarkNanoseconds(iterations, [&](const std::size_t&) { batched(); });
+    printBenchmark("enabling 8 peripheral clocks one by one", oneByOneTime, oneByOneAccesses);
+    printBenchmark("enabling 8 peripheral clocks batched", batchedTime, batchedAccesses);
+}
+
+static void lastUserGatesTheClockOff()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+
+    // Ports A and B are held by the GpioWaveform types of other tests for the whole run
+    {
+        // Two pins of port D and a USART: one enable per peripheral, whatever the number of users
+        ClockHandle led { AvailablePeripherals::_GPIOD };
+        ClockHandle button { AvailablePeripherals::_GPIOD };
+        ClockHandle serial { AvailablePeripherals::_USART2 };
+        TEST_ASSERT(led.isValid() && button.isValid() && serial.isValid());
+        TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_GPIOD) == 2);
+        TEST_ASSERT(rcc->AHB1ENR.value == RCC_AHB1ENR_GPIODEN && rcc->AHB1ENR.writes == 1);
+        TEST_ASSERT(rcc->APB1ENR.value == RCC_APB1ENR_USART2EN && rcc->APB1ENR.writes == 1);
+
+        {
+            ClockHandle portE { AvailablePeripherals::_GPIOE };
+            TEST_ASSERT(rcc->AHB1ENR.value == (RCC_AHB1ENR_GPIODEN | RCC_AHB1ENR_GPIOEEN));
+        }
+        // Port E had a single user
+        TEST_ASSERT(rcc->AHB1ENR.value == RCC_AHB1ENR_GPIODEN && rcc->AHB1ENR.writes == 3);
+
+        // One pin of port D goes away: the other still needs the clock
+        button.release();
+        TEST_ASSERT(!button.isValid());
+        TEST_ASSERT(rcc->AHB1ENR.value == RCC_AHB1ENR_GPIODEN && rcc->AHB1ENR.writes == 3);
+
+        // Moving a handle transfers the user without touching the registers
+        ClockHandle moved { std::move(led) };
+        TEST_ASSERT(!led.isValid() && moved.isValid());
+        TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_GPIOD) == 1 && rcc->AHB1ENR.writes == 3);
+    }
+    TEST_ASSERT(rcc->AHB1ENR.value == 0 && rcc->APB1ENR.value == 0);
+    TEST_ASSERT(rcc->AHB1ENR.writes == 4 && rcc->APB1ENR.writes == 2);
+    TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_GPIOD) == 0 && ClockCounter::getUsers(AvailablePeripherals::_USART2) == 0);
+
+    // Neighbouring counters in the packed table are independent, and saturate instead of wrapping
+    ClockHandle handles[ClockCounter::maxUsers + 1U];
+    for(ClockHandle& handle : handles)
+        handle = ClockHandle{ AvailablePeripherals::_GPIOC };
+    ClockHandle neighbour { AvailablePeripherals::_OTGFS };
+    TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_GPIOC) == ClockCounter::maxUsers);
+    TEST_ASSERT(!handles[ClockCounter::maxUsers].isValid());
+    TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_OTGFS) == 1 && ClockCounter::getUsers(AvailablePeripherals::_GPIOD) == 0);
+    for(ClockHandle& handle : handles)
+        handle.release();
+    TEST_ASSERT(!(rcc->AHB1ENR.value & RCC_AHB1ENR_GPIOCEN));
+    TEST_ASSERT(rcc->AHB2ENR.value & RCC_AHB2ENR_OTGFSEN);
+}
+
+static void groupHandleBringsTheSetUpTogether()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+
+    ClockHandle portD { AvailablePeripherals::_GPIOD };
+    rcc->AHB1ENR.resetCounters();
+    {
+        // A USART with its DMA controller and pin port: port D already runs, only DMA1 is enabled on AHB1
+        PeripheralClockGroupHandle<3, SimulatedRegisters> serial { { AvailablePeripherals::_USART2, AvailablePeripherals::_DMA1, AvailablePeripherals::_GPIOD } };
+        TEST_ASSERT(serial.isValid());
+        TEST_ASSERT(rcc->AHB1ENR.value == (RCC_AHB1ENR_GPIODEN | RCC_AHB1ENR_DMA1EN) && rcc->AHB1ENR.writes == 1);
+        TEST_ASSERT(rcc->APB1ENR.value == RCC_APB1ENR_USART2EN && rcc->APB1ENR.writes == 1);
+        TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_GPIOD) == 2);
+
+        // A driver of the set then only counts a user
+        ClockHandle stream { AvailablePeripherals::_DMA1 };
+        TEST_ASSERT(rcc->AHB1ENR.writes == 1);
+    }
+    // Released together: the clocks left without user are gated off in one write per bridge
+    TEST_ASSERT(rcc->AHB1ENR.value == RCC_AHB1ENR_GPIODEN && rcc->AHB1ENR.writes == 2);
+    TEST_ASSERT(rcc->APB1ENR.value == 0 && rcc->APB1ENR.writes == 2);
+
+    // A saturated peripheral fails the whole group, which takes no user
+    ClockHandle handles[ClockCounter::maxUsers - 1U];
+    for(ClockHandle& handle : handles)
+        handle = ClockHandle{ AvailablePeripherals::_GPIOD };
+    PeripheralClockGroupHandle<2, SimulatedRegisters> full { { AvailablePeripherals::_SPI1, AvailablePeripherals::_GPIOD } };
+    TEST_ASSERT(!full.isValid());
+    TEST_ASSERT(ClockCounter::getUsers(AvailablePeripherals::_SPI1) == 0 && !(rcc->APB2ENR.value & RCC_APB2ENR_SPI1EN));
+}
+
+void runClockGatingTests()
+{
+    batchTouchesEachRegisterOnce();
+    batchIsCheaperThanOneCallPerPeripheral();
+    lastUserGatesTheClockOff();
+    groupHandleBringsTheSetUpTogether();
+}
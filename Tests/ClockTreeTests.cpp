@@ -0,0 +1,135 @@
+#include <ClockTree.hh>
+#include <BoardClockConfiguration.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using SimulatedClockTree = ClockTree<SimulatedRegisters>;
+
+constexpr ClockConfiguration hsiOnly {};
+constexpr ClockConfiguration hse8MHzUsb { .source = rccClockSource::HSE, .sourceFrequency = 8000000UL, .sysclk = 96000000UL, .hclk = 96000000UL, .pclk1 = 48000000UL, .pclk2 = 96000000UL, .hseBypass = true, .usbClock = true };
+constexpr ClockConfiguration hse25MHz { .source = rccClockSource::HSE, .sourceFrequency = 25000000UL, .sysclk = 100000000UL, .hclk = 100000000UL, .pclk1 = 50000000UL, .pclk2 = 100000000UL };
+constexpr ClockConfiguration hsi84MHz { .sysclk = 84000000UL, .hclk = 84000000UL, .pclk1 = 42000000UL, .pclk2 = 84000000UL };
+
+// NUCLEO-F411RE default: HSI / 8 * 100 / 2 = 100 MHz, APB1 / 2
+constexpr ClockTreeSettings board { clockTreeSettings<boardClockConfiguration> };
+static_assert(board.isValid && board.usesPLL);
+static_assert(board.pll.m == 8 && board.pll.n == 100 && board.pll.p == 2 && board.pll.q == 5);
+static_assert(board.cfgrPrescalers == RCC_CFGR_PPRE1_DIV2);
+static_assert(board.flashLatency == 3 && board.voltageScale == 0x3U);
+
+static_assert(!clockTreeSettings<hsiOnly>.usesPLL && clockTreeSettings<hsiOnly>.flashLatency == 0 && clockTreeSettings<hsiOnly>.voltageScale == 0x1U);
+static_assert(clockTreeSettings<hse8MHzUsb>.pll.m == 4 && clockTreeSettings<hse8MHzUsb>.pll.n == 96 && clockTreeSettings<hse8MHzUsb>.pll.q == 4);
+static_assert(clockTreeSettings<hse8MHzUsb>.pll48clk == 48000000UL);
+static_assert(clockTreeSettings<hse25MHz>.pll.m == 16 && clockTreeSettings<hse25MHz>.pll.n == 128);
+static_assert(clockTreeSettings<hsi84MHz>.flashLatency == 2 && clockTreeSettings<hsi84MHz>.voltageScale == 0x2U);
+
+// Requests the hardware can not produce exactly
+static_assert(!solveClockTree(ClockConfiguration{ .sysclk = 120000000UL, .hclk = 120000000UL, .pclk1 = 30000000UL, .pclk2 = 60000000UL }).isValid);
+static_assert(!solveClockTree(ClockConfiguration{ .sysclk = 100000000UL, .hclk = 100000000UL, .pclk1 = 100000000UL, .pclk2 = 100000000UL }).isValid);
+static_assert(!solveClockTree(ClockConfiguration{ .sysclk = 100000000UL, .hclk = 33333333UL, .pclk1 = 33333333UL, .pclk2 = 33333333UL }).isValid);
+static_assert(!solveClockTree(ClockConfiguration{ .source = rccClockSource::HSE, .sourceFrequency = 30000000UL, .sysclk = 30000000UL, .hclk = 30000000UL, .pclk1 = 30000000UL, .pclk2 = 30000000UL }).isValid);
+static_assert(!solveClockTree(ClockConfiguration{ .sysclk = 100000000UL, .hclk = 100000000UL, .pclk1 = 50000000UL, .pclk2 = 100000000UL, .usbClock = true }).isValid);
+
+static void resetClockRegisters()
+{
+    SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->reset();
+    SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get()->reset();
+    SimulatedRegisters<PWR_TypeDef, PWR_BASE>::get()->reset();
+}
+
+static void boardConfigurationRunsFromThePLL()
+{
+    resetClockRegisters();
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+    SimulatedPwr* pwr = SimulatedRegisters<PWR_TypeDef, PWR_BASE>::get();
+
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::MainPLL);
+    TEST_ASSERT((rcc->PLLCFGR.value & RCC_PLLCFGR_PLLM) == 8U);
+    TEST_ASSERT(((rcc->PLLCFGR.value & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos) == 100U);
+    TEST_ASSERT((rcc->PLLCFGR.value & RCC_PLLCFGR_PLLP) == 0);
+    TEST_ASSERT(((rcc->PLLCFGR.value & RCC_PLLCFGR_PLLQ) >> RCC_PLLCFGR_PLLQ_Pos) == 5U);
+    TEST_ASSERT(!(rcc->PLLCFGR.value & RCC_PLLCFGR_PLLSRC_HSE));
+    TEST_ASSERT(rcc->PLLCFGR.value & 0x20000000U);
+    TEST_ASSERT((rcc->CFGR.value & (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) == RCC_CFGR_PPRE1_DIV2);
+    TEST_ASSERT((flash->ACR & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_3WS);
+    TEST_ASSERT((pwr->CR & PWR_CR_VOS) == PWR_CR_VOS && pwr->CR.voltageScaleWritesWithPllOn == 0);
+    // PWR was only clocked for the VOS write: nothing else holds it
+    TEST_ASSERT(!(rcc->APB1ENR.value & RCC_APB1ENR_PWREN) && rcc->APB1ENR.writes == 2);
+}
+
+static void reconfiguringGoesThroughTheHSI()
+{
+    resetClockRegisters();
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+
+    SimulatedClockTree::apply<boardClockConfiguration>();
+    TEST_ASSERT(SimulatedClockTree::apply<hsi84MHz>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::MainPLL);
+    TEST_ASSERT(((rcc->PLLCFGR.value & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos) == 84U);
+    TEST_ASSERT((flash->ACR & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_2WS);
+
+    // Back to the bare HSI: PLL off and no wait states
+    TEST_ASSERT(SimulatedClockTree::apply<hsiOnly>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::HSI);
+    TEST_ASSERT(!(rcc->CR.value & RCC_CR_PLLON));
+    TEST_ASSERT((flash->ACR & FLASH_ACR_LATENCY) == 0);
+    TEST_ASSERT((rcc->CFGR.value & (RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2)) == 0);
+    // Every scale change, 3 -> 2 -> 1, was made with the PLL off
+    SimulatedPwr* pwr = SimulatedRegisters<PWR_TypeDef, PWR_BASE>::get();
+    TEST_ASSERT((pwr->CR & PWR_CR_VOS) == PWR_CR_VOS_0 && pwr->CR.voltageScaleWritesWithPllOn == 0);
+}
+
+static void externalOscillatorIsPolled()
+{
+    resetClockRegisters();
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+
+    TEST_ASSERT(SimulatedClockTree::apply<hse8MHzUsb>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(rcc->CR.value & RCC_CR_HSEBYP);
+    TEST_ASSERT(rcc->PLLCFGR.value & RCC_PLLCFGR_PLLSRC_HSE);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::MainPLL);
+
+    // A missing crystal times out and leaves the core on the HSI
+    resetClockRegisters();
+    rcc->CR.hseOscillatorPresent = false;
+    TEST_ASSERT(SimulatedClockTree::apply<hse25MHz>() == RCCStatusCodes::hseNotReady);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::HSI);
+    rcc->CR.hseOscillatorPresent = true;
+
+    TEST_ASSERT(SimulatedClockTree::apply(ClockTreeSettings{}, hsiOnly) == RCCStatusCodes::invalidConfiguration);
+}
+
+static void failedSwitchRestoresTheBuses()
+{
+    resetClockRegisters();
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+    constexpr uint32_t prescalers { RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2 };
+
+    // A PLL that never locks: the core stays on the HSI, with the buses and wait states it had
+    rcc->CR.pllLocks = false;
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::pllNotReady);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::HSI);
+    TEST_ASSERT((rcc->CFGR.value & prescalers) == 0 && (flash->ACR & FLASH_ACR_LATENCY) == 0);
+
+    // Leaving a running PLL for a new one: back on the HSI, with the prescalers and wait states of the old PLL
+    rcc->CR.pllLocks = true;
+    SimulatedClockTree::apply<hsi84MHz>();
+    rcc->CR.pllLocks = false;
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::pllNotReady);
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::HSI);
+    TEST_ASSERT((rcc->CFGR.value & prescalers) == RCC_CFGR_PPRE1_DIV2 && (flash->ACR & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_2WS);
+    rcc->CR.pllLocks = true;
+}
+
+void runClockTreeTests()
+{
+    boardConfigurationRunsFromThePLL();
+    reconfiguringGoesThroughTheHSI();
+    externalOscillatorIsPolled();
+    failedSwitchRestoresTheBuses();
+}
@@ -0,0 +1,108 @@
+#include <Container.hh>
+#include <FlatContainer.hh>
+#include <vector>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+enum class channelMode : uint8_t { off, input, output };
+enum class channelProperties : uint8_t { first, second, third, rate, __length };
+
+using ChannelContainer = Container<channelProperties, channelMode, channelMode, channelMode, uint32_t>;
+using FlatChannels = FlatContainer<channelProperties, channelMode, channelMode, channelMode, uint32_t>;
+
+// Type queries only depend on the types
+static_assert(ChannelContainer::isTypeIn<channelMode>() == ContainerMask<4>{ 0b0111U });
+static_assert(ChannelContainer::isTypeIn<uint32_t>().first() == 3);
+static_assert(ChannelContainer::isTypeIn<bool>().none());
+static_assert(std::is_same_v<ChannelContainer::TypeIndices<channelMode>, std::index_sequence<0, 1, 2>>);
+static_assert(std::is_same_v<FlatChannels::TypeIndices<uint32_t>, std::index_sequence<3>>);
+static_assert(sizeof(ChannelContainer::MaskType) == sizeof(uint32_t));
+
+// Value queries on a constant container are constant expressions
+constexpr FlatChannels channels { channelMode::output, channelMode::off, channelMode::output, 1000U };
+static_assert(channels.isTypeAndValueIn(channelMode::output) == ContainerMask<4>{ 0b0101U });
+static_assert(channels.isTypeAndValueIn(channelMode::input).none());
+static_assert(channels.isTypeAndValueIn(1000U).count() == 1);
+
+/** @brief Counts the heap bytes requested through it */
+template<typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+    static inline std::size_t allocatedBytes { 0 };
+
+    CountingAllocator() = default;
+    template<typename U> CountingAllocator(const CountingAllocator<U>&) { }
+    T* allocate(const std::size_t& n) { allocatedBytes += n * sizeof(T); return std::allocator<T>{}.allocate(n); }
+    void deallocate(T* pointer, const std::size_t& n) { std::allocator<T>{}.deallocate(pointer, n); }
+    bool operator==(const CountingAllocator&) const = default;
+};
+
+/** @brief The query as it was written before: one push_back per matching member */
+template<typename Type, typename... Members>
+static std::vector<uint8_t, CountingAllocator<uint8_t>> vectorTypeAndValueIn(const std::tuple<Members...>& members, const Type& value)
+{
+    std::vector<uint8_t, CountingAllocator<uint8_t>> result;
+    [&]<std::size_t... Indices>(std::index_sequence<Indices...>)
+    {
+        ([&]()
+        {
+            if constexpr (std::is_same_v<std::decay_t<Members>, Type>)
+            {
+                if (std::get<Indices>(members) == value)
+                    result.push_back(static_cast<uint8_t>(Indices));
+            }
+        }(), ...);
+    }(std::index_sequence_for<Members...>{});
+    return result;
+}
+
+static void containerQueriesReturnMasks()
+{
+    ChannelContainer container { channelMode::input, channelMode::output, channelMode::input, 9600U };
+    const auto inputs = container.isTypeAndValueIn(channelMode::input);
+    TEST_ASSERT(inputs.test(0) && !inputs.test(1) && inputs.test(2) && !inputs.test(3));
+    TEST_ASSERT(inputs.count() == 2 && inputs.first() == 0);
+    TEST_ASSERT(container.isTypeAndValueIn(channelMode::off).none());
+    TEST_ASSERT(container.isTypeAndValueIn(9600U) == ContainerMask<4>{ 0b1000U });
+    TEST_ASSERT(container.isTypeIn<channelMode>().count() == 3);
+
+    FlatChannels flat { channelMode::off, channelMode::off, channelMode::input, 0U };
+    TEST_ASSERT(flat.isTypeAndValueIn(channelMode::off) == ContainerMask<4>{ 0b0011U });
+    flat.setMemberValue<channelProperties::first>(channelMode::input);
+    TEST_ASSERT(flat.isTypeAndValueIn(channelMode::input) == ContainerMask<4>{ 0b0101U });
+}
+
+static void masksAvoidTheHeap()
+{
+    constexpr std::size_t iterations { 1000000 };
+    const std::tuple<channelMode, channelMode, channelMode, uint32_t> members { channelMode::input, channelMode::output, channelMode::input, 9600U };
+    ChannelContainer container { channelMode::input, channelMode::output, channelMode::input, 9600U };
+
+    volatile uint32_t sink { 0 };
+    CountingAllocator<uint8_t>::allocatedBytes = 0;
+    const double vectorNs = benchmarkNanoseconds(iterations, [&](const std::size_t& i)
+    {
+        const channelMode value = (i & 0x1U) ? channelMode::input : channelMode::output;
+        sink = sink + static_cast<uint32_t>(vectorTypeAndValueIn(members, value).size());
+    });
+    const std::size_t vectorBytes = CountingAllocator<uint8_t>::allocatedBytes / iterations + sizeof(std::vector<uint8_t>);
+
+    const double maskNs = benchmarkNanoseconds(iterations, [&](const std::size_t& i)
+    {
+        const channelMode value = (i & 0x1U) ? channelMode::input : channelMode::output;
+        sink = sink + container.isTypeAndValueIn(value).count();
+    });
+
+    TEST_ASSERT(vectorBytes > sizeof(ChannelContainer::MaskType));
+    TEST_ASSERT(sink == 3U * iterations);
+
+    std::cout << "[bench] isTypeAndValueIn (host): std::vector " << vectorNs << " ns, " << vectorBytes << " bytes per result (heap included); "
+              << "ContainerMask " << maskNs << " ns, " << sizeof(ChannelContainer::MaskType) << " bytes, no allocation" << std::endl;
+}
+
+void runContainerQueryTests()
+{
+    containerQueriesReturnMasks();
+    masksAvoidTheHeap();
+}
@@ -0,0 +1,197 @@
+#include <DMA.hh>
+#include <array>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+extern "C" void DMA2_Stream7_IRQHandler();
+
+// DMA2 stream 7 only serves USART1_TX and USART6_TX; stream 5 serves four requests
+static_assert(getDMAStreamDemand(15) == 2 && getDMAStreamDemand(13) == 4);
+static_assert(getDMABurstBeats(DMABurst::incremental8) == 8 && getDMADataSizeBytes(DMADataSize::word) == 4);
+
+struct StreamEvents
+{
+    uint32_t events { 0 };
+    uint32_t calls { 0 };
+};
+
+static void record(const uint32_t& events, void* context)
+{
+    StreamEvents& recorded = *static_cast<StreamEvents*>(context);
+    recorded.events |= events;
+    ++recorded.calls;
+}
+
+static void streamsFollowTheRequestMap()
+{
+    resetHostPeripherals();
+    {
+        DMAStream first { DMARequest::USART1_RX };
+        DMAStream second { DMARequest::USART1_RX };
+        DMAStream third { DMARequest::USART1_RX };
+        TEST_ASSERT(first.init() == DMAStatusCodes::Ready);
+        // Stream 2 is wanted by three requests, stream 5 by four
+        TEST_ASSERT(first.getRoute()->controller == 1 && first.getRoute()->stream == 2 && first.getRoute()->channel == 4);
+        TEST_ASSERT(DMAStream::getDriver(10) == &first);
+        TEST_ASSERT(second.init() == DMAStatusCodes::Ready);
+        TEST_ASSERT(second.getRoute()->stream == 5);
+        TEST_ASSERT(third.init() == DMAStatusCodes::noStreamAvailable);
+        TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN);
+
+        // Memory to memory takes the least wanted DMA2 stream, starting from the lowest priority one
+        DMAStream copy { DMARequest::memoryToMemory };
+        TEST_ASSERT(copy.init() == DMAStatusCodes::Ready);
+        TEST_ASSERT(copy.getRoute()->controller == 1 && copy.getRoute()->stream == 7);
+
+        // A new request trades the stream
+        TEST_ASSERT(first.setRequest(DMARequest::USART2_RX) == DMAStatusCodes::Ready);
+        TEST_ASSERT(first.getRoute()->controller == 0 && first.getRoute()->stream == 5 && DMAStream::getDriver(10) == nullptr);
+        TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_DMA1EN);
+        TEST_ASSERT(third.init() == DMAStatusCodes::Ready && third.getRoute()->stream == 2);
+    }
+    TEST_ASSERT(!(RCC->AHB1ENR & (RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMA2EN)));
+}
+
+static void transfersProgramTheStream()
+{
+    resetHostPeripherals();
+    DMAStream stream { DMARequest::USART1_TX };
+    static std::array<uint32_t, 16> source {};
+    static std::array<uint32_t, 16> other {};
+    static volatile uint32_t data { 0 };
+    TEST_ASSERT(stream.start(DMATransfer{ .direction = DMADirection::memoryToPeripheral, .peripheral = &data, .memory = source.data(), .length = 4 }) == DMAStatusCodes::notReadyNotReset);
+    stream.init();
+    DMA_Stream_TypeDef* registers = DMA2_Stream7;
+
+    // Words from memory in 4-word bursts, through the FIFO drained once full
+    const DMATransfer burst
+    {
+        .direction = DMADirection::memoryToPeripheral,
+        .peripheral = &data,
+        .memory = source.data(),
+        .length = 64,
+        .memorySize = DMADataSize::word,
+        .priority = DMAPriority::high,
+        .fifoThreshold = DMAFifoThreshold::full,
+        .memoryBurst = DMABurst::incremental4,
+        .events = dmaHalfTransferEvent | dmaTransferCompleteEvent,
+    };
+    TEST_ASSERT(stream.start(burst) == DMAStatusCodes::Ready);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(registers->PAR)) == &data);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(registers->M0AR)) == source.data());
+    TEST_ASSERT(registers->NDTR == 64U && stream.getRemaining() == 64U);
+    const uint32_t control = registers->CR;
+    TEST_ASSERT((control & DMA_SxCR_CHSEL) == (4U << DMA_SxCR_CHSEL_Pos));
+    TEST_ASSERT((control & DMA_SxCR_MBURST) == DMA_SxCR_MBURST_0 && !(control & DMA_SxCR_PBURST));
+    TEST_ASSERT((control & DMA_SxCR_MSIZE) == DMA_SxCR_MSIZE_1 && !(control & DMA_SxCR_PSIZE));
+    TEST_ASSERT((control & DMA_SxCR_DIR) == DMA_SxCR_DIR_0 && (control & DMA_SxCR_PL) == DMA_SxCR_PL_1);
+    TEST_ASSERT((control & (DMA_SxCR_HTIE | DMA_SxCR_TCIE | DMA_SxCR_TEIE)) == (DMA_SxCR_HTIE | DMA_SxCR_TCIE));
+    TEST_ASSERT((control & (DMA_SxCR_MINC | DMA_SxCR_PINC | DMA_SxCR_CIRC | DMA_SxCR_DBM | DMA_SxCR_EN)) == (DMA_SxCR_MINC | DMA_SxCR_EN));
+    TEST_ASSERT(registers->FCR == (DMA_SxFCR_DMDIS | DMA_SxFCR_FTH));
+    TEST_ASSERT(stream.isBusy() && stream.start(burst) == DMAStatusCodes::busy);
+    TEST_ASSERT(stream.stop() && !stream.isBusy());
+
+    // Double buffer mode: the stream circulates over both buffers, the idle one can be replaced
+    DMATransfer pingPong { burst };
+    pingPong.memory1 = other.data();
+    pingPong.fifoThreshold = DMAFifoThreshold::direct;
+    pingPong.memorySize = DMADataSize::byte;
+    pingPong.memoryBurst = DMABurst::single;
+    TEST_ASSERT(stream.start(pingPong) == DMAStatusCodes::Ready);
+    TEST_ASSERT((registers->CR & (DMA_SxCR_DBM | DMA_SxCR_CIRC)) == (DMA_SxCR_DBM | DMA_SxCR_CIRC) && registers->FCR == 0x0U);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(registers->M1AR)) == other.data());
+    stream.setIdleBuffer(source.data() + 8);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(registers->M1AR)) == source.data() + 8);
+    registers->CR = static_cast<uint32_t>(registers->CR) | DMA_SxCR_CT;
+    TEST_ASSERT(stream.isOnMemory1());
+    stream.setIdleBuffer(other.data());
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(registers->M0AR)) == other.data());
+    stream.stop();
+}
+
+static void invalidTransfersAreRejected()
+{
+    static std::array<uint32_t, 16> source {};
+    static std::array<uint32_t, 16> destination {};
+    const DMATransfer copy
+    {
+        .direction = DMADirection::memoryToMemory,
+        .peripheral = source.data(),
+        .memory = destination.data(),
+        .length = 16,
+        .peripheralSize = DMADataSize::word,
+        .memorySize = DMADataSize::word,
+        .peripheralIncrement = true,
+        .fifoThreshold = DMAFifoThreshold::full,
+        .memoryBurst = DMABurst::incremental4,
+    };
+    TEST_ASSERT(validateDMATransfer(copy, DMARequest::memoryToMemory) == DMAStatusCodes::Ready);
+    TEST_ASSERT(validateDMATransfer(copy, DMARequest::SPI1_TX) == DMAStatusCodes::invalidTransfer);
+
+    DMATransfer invalid { copy };
+    invalid.fifoThreshold = DMAFifoThreshold::direct;
+    TEST_ASSERT(validateDMATransfer(invalid, DMARequest::memoryToMemory) == DMAStatusCodes::invalidTransfer);
+    invalid = copy;
+    invalid.circular = true;
+    TEST_ASSERT(validateDMATransfer(invalid, DMARequest::memoryToMemory) == DMAStatusCodes::invalidTransfer);
+    // 8 words do not fit a half-full (8-byte) FIFO threshold
+    invalid = copy;
+    invalid.fifoThreshold = DMAFifoThreshold::half;
+    invalid.memoryBurst = DMABurst::incremental8;
+    TEST_ASSERT(validateDMATransfer(invalid, DMARequest::memoryToMemory) == DMAStatusCodes::invalidTransfer);
+    // 3 bytes are not a whole number of words
+    invalid = copy;
+    invalid.peripheralSize = DMADataSize::byte;
+    invalid.length = 3;
+    TEST_ASSERT(validateDMATransfer(invalid, DMARequest::memoryToMemory) == DMAStatusCodes::invalidTransfer);
+    invalid = copy;
+    invalid.length = 0;
+    TEST_ASSERT(validateDMATransfer(invalid, DMARequest::memoryToMemory) == DMAStatusCodes::invalidTransfer);
+}
+
+static void interruptsReachTheTransferCallback()
+{
+    resetHostPeripherals();
+    DMAStream stream { DMARequest::USART1_TX };
+    stream.init();
+    static volatile uint32_t data { 0 };
+    static std::array<uint8_t, 8> buffer {};
+    StreamEvents recorded {};
+    DMATransfer transfer
+    {
+        .direction = DMADirection::memoryToPeripheral,
+        .peripheral = &data,
+        .memory = buffer.data(),
+        .length = static_cast<uint16_t>(buffer.size()),
+        .callback = &record,
+        .context = &recorded,
+    };
+    stream.start(transfer);
+
+    // Half transfer is not subscribed
+    DMA2->HISR = DMA_HISR_HTIF7;
+    DMA2_Stream7_IRQHandler();
+    TEST_ASSERT(recorded.calls == 0);
+    DMA2->HISR = DMA_HISR_TCIF7;
+    DMA2_Stream7_IRQHandler();
+    TEST_ASSERT(recorded.calls == 1 && recorded.events == dmaTransferCompleteEvent);
+    TEST_ASSERT(DMA2->HIFCR == DMA_HIFCR_CTCIF7);
+
+    const double ns = benchmarkNanoseconds(100000, [&](const std::size_t&)
+    {
+        DMA2->HISR = DMA_HISR_TCIF7;
+        DMA2_Stream7_IRQHandler();
+    });
+    TEST_ASSERT(recorded.calls == 100001U);
+    std::cout << "[bench] DMA2 stream 7 interrupt through the stream table to the transfer callback (host): " << ns << " ns" << std::endl;
+    stream.stop();
+}
+
+void runDMATests()
+{
+    streamsFollowTheRequestMap();
+    transfersProgramTheStream();
+    invalidTransfersAreRejected();
+    interruptsReachTheTransferCallback();
+    resetHostPeripherals();
+}
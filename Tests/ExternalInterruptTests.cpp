@@ -0,0 +1,132 @@
+#include <ExternalInterrupt.hh>
+#include <StaticPin.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using Exti = ExternalInterrupt<SimulatedRegisters>;
+using Button = StaticPin<GpioPort::C, GpioPin::_13, SimulatedRegisters>;
+
+static uint32_t callbackCalls[16] {};
+
+static void countCall(void* context)
+{
+    ++callbackCalls[*static_cast<uint32_t*>(context)];
+}
+
+static uint32_t lineIds[16] { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+static void resetCalls()
+{
+    for(uint32_t& calls : callbackCalls)
+        calls = 0;
+}
+
+static void enableRoutesAndArmsTheLine()
+{
+    SimulatedExti* exti = SimulatedRegisters<EXTI_TypeDef, EXTI_BASE>::get();
+    SYSCFG_TypeDef* syscfg = SimulatedRegisters<SYSCFG_TypeDef, SYSCFG_BASE>::get();
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    NVIC_Type* nvic = SimulatedRegisters<NVIC_Type, NVIC_BASE>::get();
+
+    TEST_ASSERT(Button::enableInterrupt(GpioTrigger::falling, &countCall, &lineIds[13]));
+    TEST_ASSERT(Exti::isEnabled(GpioPin::_13));
+    TEST_ASSERT(rcc->APB2ENR & RCC_APB2ENR_SYSCFGEN);
+    TEST_ASSERT(((syscfg->EXTICR[3] >> 4U) & 0xFU) == static_cast<uint32_t>(GpioPort::C));
+    TEST_ASSERT(exti->IMR.value & (0x1U << 13));
+    TEST_ASSERT(exti->FTSR.value & (0x1U << 13));
+    TEST_ASSERT(!(exti->RTSR.value & (0x1U << 13)));
+    TEST_ASSERT(nvic->ISER[EXTI15_10_IRQn >> 5U] == (0x1U << (EXTI15_10_IRQn & 0x1F)));
+
+    TEST_ASSERT(Exti::enable(GpioPort::A, GpioPin::_0, GpioTrigger::both, &countCall, &lineIds[0]));
+    TEST_ASSERT((syscfg->EXTICR[0] & 0xFU) == static_cast<uint32_t>(GpioPort::A));
+    TEST_ASSERT(exti->RTSR.value & 0x1U);
+    TEST_ASSERT(exti->FTSR.value & 0x1U);
+}
+
+static void linesAreExclusivePerPort()
+{
+    // Line 13 is already used by PC13
+    TEST_ASSERT(!Exti::enable(GpioPort::B, GpioPin::_13, GpioTrigger::rising, &countCall, &lineIds[13]));
+    // Re-arming the same pin is allowed
+    TEST_ASSERT(Exti::enable(GpioPort::C, GpioPin::_13, GpioTrigger::falling, &countCall, &lineIds[13]));
+    // Disabling from another port does not release the line
+    Exti::disable(GpioPort::B, GpioPin::_13);
+    TEST_ASSERT(Exti::isEnabled(GpioPin::_13));
+    TEST_ASSERT(!Exti::enable(GpioPort::A, GpioPin::_1, GpioTrigger::rising, nullptr));
+}
+
+static void dispatchCostDoesNotDependOnLineOrHandlers()
+{
+    SimulatedExti* exti = SimulatedRegisters<EXTI_TypeDef, EXTI_BASE>::get();
+    resetCalls();
+
+    // Dedicated line: one PR store and one call
+    exti->PR.value = 0x1U;
+    exti->resetCounters();
+    Exti::dispatchLine<0>();
+    TEST_ASSERT(exti->getAccesses() == 1);
+    TEST_ASSERT(exti->PR.value == 0);
+    TEST_ASSERT(callbackCalls[0] == 1);
+
+    // Shared line: one PR load and one PR store whatever the line index
+    exti->PR.value = 0x1U << 13;
+    exti->resetCounters();
+    Exti::dispatchLines(Exti::lines15to10);
+    TEST_ASSERT(exti->getAccesses() == 2);
+    TEST_ASSERT(exti->PR.value == 0);
+    TEST_ASSERT(callbackCalls[13] == 1);
+
+    // Registering every other line does not change the cost of dispatching one of them
+    for(uint32_t line = 5; line < 16; ++line)
+    {
+        if(line != 13)
+            Exti::enable(GpioPort::B, static_cast<GpioPin>(line), GpioTrigger::rising, &countCall, &lineIds[line]);
+    }
+    exti->PR.value = 0x1U << 13;
+    exti->resetCounters();
+    Exti::dispatchLines(Exti::lines15to10);
+    TEST_ASSERT(exti->getAccesses() == 2);
+    TEST_ASSERT(callbackCalls[13] == 2);
+
+    // Several pending lines are served in the same pass; lines of the other group are left pending
+    resetCalls();
+    exti->PR.value = (0x1U << 10) | (0x1U << 15) | (0x1U << 7);
+    exti->resetCounters();
+    Exti::dispatchLines(Exti::lines15to10);
+    TEST_ASSERT(exti->getAccesses() == 2);
+    TEST_ASSERT(callbackCalls[10] == 1 && callbackCalls[15] == 1 && callbackCalls[7] == 0);
+    TEST_ASSERT(exti->PR.value == (0x1U << 7));
+    Exti::dispatchLines(Exti::lines9to5);
+    TEST_ASSERT(callbackCalls[7] == 1);
+
+    // A pending line without handler dispatches to the no-op entry
+    Exti::disable(GpioPort::B, GpioPin::_7);
+    TEST_ASSERT(!(exti->IMR.value & (0x1U << 7)));
+    exti->PR.value = 0x1U << 7;
+    Exti::dispatchLines(Exti::lines9to5);
+    TEST_ASSERT(callbackCalls[7] == 1);
+    TEST_ASSERT(exti->PR.value == 0);
+
+    const std::size_t iterations { 1000000 };
+    const double lowLine = benchmarkNanoseconds(iterations, [exti](const std::size_t&) {
+        exti->PR.value = 0x1U << 5;
+        Exti::dispatchLines(Exti::lines9to5);
+    });
+    const double highLine = benchmarkNanoseconds(iterations, [exti](const std::size_t&) {
+        exti->PR.value = 0x1U << 15;
+        Exti::dispatchLines(Exti::lines15to10);
+    });
+    printBenchmark("EXTI dispatch, line 5", lowLine, 2);
+    printBenchmark("EXTI dispatch, line 15", highLine, 2);
+
+    for(uint32_t line = 5; line < 16; ++line)
+        Exti::disable(GpioPort::B, static_cast<GpioPin>(line));
+}
+
+void runExternalInterruptTests()
+{
+    enableRoutesAndArmsTheLine();
+    linesAreExclusivePerPort();
+    dispatchCostDoesNotDependOnLineOrHandlers();
+}
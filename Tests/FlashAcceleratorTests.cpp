@@ -0,0 +1,106 @@
+#include <ClockTree.hh>
+#include <BoardClockConfiguration.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using SimulatedClockTree = ClockTree<SimulatedRegisters>;
+
+constexpr uint32_t acceleratorBits { FLASH_ACR_ICEN | FLASH_ACR_DCEN | FLASH_ACR_PRFTEN };
+
+constexpr ClockConfiguration boardWithoutAccelerator { .sysclk = boardClockConfiguration.sysclk, .hclk = boardClockConfiguration.hclk, .pclk1 = boardClockConfiguration.pclk1,
+                                                       .pclk2 = boardClockConfiguration.pclk2, .flashAccelerator = false };
+constexpr ClockConfiguration missingCrystal { .source = rccClockSource::HSE, .sourceFrequency = 25000000UL, .sysclk = 25000000UL, .hclk = 25000000UL, .pclk1 = 25000000UL, .pclk2 = 25000000UL };
+
+static_assert(clockTreeSettings<boardClockConfiguration>.flashAccelerator == acceleratorBits);
+static_assert(clockTreeSettings<boardWithoutAccelerator>.flashAccelerator == 0);
+
+/**
+ * @brief Flash fetch model of a loop of 16-bit instructions running from flash, in core cycles (RM0383 section 3.4).
+ * A 128-bit flash line holds 8 instructions and takes latency extra cycles to read. The prefetch buffer reads the
+ * next line while the current one executes, so only the branch back to the top of the loop stalls. The instruction
+ * cache (64 lines) holds the whole loop after its first iteration.
+ */
+static uint32_t getLoopCycles(const uint32_t& acr, const uint32_t& instructions, const uint32_t& iterations)
+{
+    const uint32_t latency = (acr & FLASH_ACR_LATENCY) >> FLASH_ACR_LATENCY_Pos;
+    const uint32_t lines = (instructions + 7U) / 8U;
+    const uint32_t missStalls = (acr & FLASH_ACR_PRFTEN) ? latency : lines * latency;
+    const bool loopIsCached = (acr & FLASH_ACR_ICEN) && lines <= 64U;
+
+    uint32_t cycles { 0 };
+    for(uint32_t i = 0; i < iterations; ++i)
+        cycles += instructions + ((loopIsCached && i > 0) ? 0U : missStalls);
+    return cycles;
+}
+
+static void acceleratorIsEnabledWithTheClockTree()
+{
+    SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->reset();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+    flash->reset();
+
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::Ready);
+    TEST_ASSERT((flash->ACR.value & acceleratorBits) == acceleratorBits);
+    TEST_ASSERT((flash->ACR.value & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_3WS);
+    TEST_ASSERT(!(flash->ACR.value & (FLASH_ACR_ICRST | FLASH_ACR_DCRST)));
+    // Both caches were flushed while disabled
+    TEST_ASSERT(flash->ACR.instructionCacheResets == 1 && flash->ACR.dataCacheResets == 1);
+
+    // Every reconfiguration flushes them again, even to the same frequency
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(flash->ACR.instructionCacheResets == 2 && flash->ACR.dataCacheResets == 2);
+    TEST_ASSERT((flash->ACR.value & acceleratorBits) == acceleratorBits);
+
+    TEST_ASSERT(SimulatedClockTree::apply<boardWithoutAccelerator>() == RCCStatusCodes::Ready);
+    TEST_ASSERT(!(flash->ACR.value & acceleratorBits));
+    TEST_ASSERT((flash->ACR.value & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_3WS);
+    TEST_ASSERT(flash->ACR.instructionCacheResets == 3);
+}
+
+static void failedSwitchRestoresTheAccelerator()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+    rcc->reset();
+    flash->reset();
+
+    TEST_ASSERT(SimulatedClockTree::apply<boardClockConfiguration>() == RCCStatusCodes::Ready);
+    rcc->CR.hseOscillatorPresent = false;
+    TEST_ASSERT(SimulatedClockTree::apply<missingCrystal>() == RCCStatusCodes::hseNotReady);
+    rcc->CR.hseOscillatorPresent = true;
+    TEST_ASSERT((flash->ACR.value & acceleratorBits) == acceleratorBits);
+    TEST_ASSERT((flash->ACR.value & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_3WS);
+}
+
+static void acceleratorHidesTheWaitStates()
+{
+    SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->reset();
+    SimulatedFlash* flash = SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get();
+    flash->reset();
+
+    constexpr uint32_t instructions { 32 };
+    constexpr uint32_t iterations { 1000 };
+
+    SimulatedClockTree::apply<boardWithoutAccelerator>();
+    const uint32_t plain = getLoopCycles(flash->ACR.value, instructions, iterations);
+    const uint32_t prefetchOnly = getLoopCycles(flash->ACR.value | FLASH_ACR_PRFTEN, instructions, iterations);
+    SimulatedClockTree::apply<boardClockConfiguration>();
+    const uint32_t accelerated = getLoopCycles(flash->ACR.value, instructions, iterations);
+
+    // 3 wait states: 4 stalled lines per iteration without the accelerator, only the first iteration with it
+    TEST_ASSERT(plain == iterations * (instructions + 4U * 3U));
+    TEST_ASSERT(prefetchOnly == iterations * (instructions + 3U));
+    TEST_ASSERT(accelerated == iterations * instructions + 3U);
+    TEST_ASSERT(accelerated < prefetchOnly && prefetchOnly < plain);
+
+    std::cout << "[bench] " << instructions << "-instruction loop from flash at 100 MHz, " << iterations << " iterations (simulated): "
+              << plain << " cycles without ART, " << prefetchOnly << " with prefetch, " << accelerated << " with prefetch and caches" << std::endl;
+}
+
+void runFlashAcceleratorTests()
+{
+    acceleratorIsEnabledWithTheClockTree();
+    failedSwitchRestoresTheAccelerator();
+    acceleratorHidesTheWaitStates();
+}
@@ -0,0 +1,76 @@
+#include <FlatContainer.hh>
+#include <cstring>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+enum class uartProperties : uint8_t { wordLength, stopBits, baudRate, __length };
+using UartSettings = FlatContainer<uartProperties, uint8_t, uint8_t, uint32_t>;
+
+/** @brief Hand-written equivalent of UartSettings */
+struct PlainUartSettings
+{
+    uint8_t wordLength;
+    uint8_t stopBits;
+    uint32_t baudRate;
+};
+
+static_assert(std::is_trivially_copyable_v<UartSettings>);
+static_assert(std::is_aggregate_v<UartSettings>);
+static_assert(!std::is_polymorphic_v<UartSettings>);
+static_assert(sizeof(UartSettings) == sizeof(PlainUartSettings) && alignof(UartSettings) == alignof(PlainUartSettings));
+static_assert(UartSettings::getSize() == 3);
+
+// Constant-initialized: no constructor runs, the object is emitted in .rodata
+constexpr UartSettings defaultUartSettings { 8, 1, 115200 };
+static_assert(defaultUartSettings.getMemberValue<uartProperties::baudRate>() == 115200);
+static_assert(defaultUartSettings.getMemberValue<uartProperties::stopBits>() == 1);
+
+constexpr UartSettings halfSpeed = []()
+{
+    UartSettings settings { defaultUartSettings };
+    settings.setMemberValue<uartProperties::baudRate>(57600U);
+    return settings;
+}();
+static_assert(halfSpeed.getMemberValue<uartProperties::baudRate>() == 57600 && halfSpeed.getMemberValue<uartProperties::wordLength>() == 8);
+
+static void membersAreLaidOutAsAPlainStruct()
+{
+    const UartSettings settings { 9, 2, 9600 };
+    PlainUartSettings plain {};
+    std::memcpy(&plain, &settings, sizeof(plain));
+    TEST_ASSERT(plain.wordLength == 9 && plain.stopBits == 2 && plain.baudRate == 9600);
+
+    UartSettings copy {};
+    std::memcpy(&copy, &plain, sizeof(copy));
+    TEST_ASSERT(copy.getMemberValue<uartProperties::baudRate>() == 9600);
+}
+
+static void membersAreAccessedByLabel()
+{
+    UartSettings settings {};
+    settings.setAllMemberValues(uint8_t{7}, uint8_t{1}, 19200U);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::wordLength>() == 7);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::baudRate>() == 19200);
+
+    settings.getMemberValue<uartProperties::stopBits>() = 2;
+    TEST_ASSERT(settings.getMemberValue<uartProperties::stopBits>() == 2);
+
+    // Matched by type: both uint8_t members take the value
+    settings.setMembersValues(uint8_t{8}, 38400U);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::wordLength>() == 8 && settings.getMemberValue<uartProperties::stopBits>() == 8);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::baudRate>() == 38400);
+
+    uint32_t sum { 0 };
+    settings.applyToAll([](const auto& member, uint32_t& total) { total += member; }, sum);
+    TEST_ASSERT(sum == 8U + 8U + 38400U);
+
+    settings.applyToEach([](auto& member, const auto& factor) { member *= factor; }, 1, 0, 2);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::wordLength>() == 8 && settings.getMemberValue<uartProperties::stopBits>() == 0);
+    TEST_ASSERT(settings.getMemberValue<uartProperties::baudRate>() == 76800);
+}
+
+void runFlatContainerTests()
+{
+    membersAreLaidOutAsAPlainStruct();
+    membersAreAccessedByLabel();
+}
@@ -0,0 +1,162 @@
+#include <GpioConfigBatch.hh>
+#include <PinMap.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+struct PortSnapshot { uint32_t moder, otyper, ospeedr, pupdr, afrl, afrh; };
+
+static SimulatedGpio* getPort(const std::size_t& index)
+{
+    if(index == 0) return SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    if(index == 1) return SimulatedRegisters<GPIO_TypeDef, GPIOB_BASE>::get();
+    return SimulatedRegisters<GPIO_TypeDef, GPIOC_BASE>::get();
+}
+
+static void resetPorts()
+{
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        SimulatedGpio* gpio = getPort(i);
+        gpio->MODER.value = 0xA8000000U;
+        gpio->OTYPER.value = 0;
+        gpio->OSPEEDR.value = 0x0C000000U;
+        gpio->PUPDR.value = 0x64000000U;
+        gpio->AFR[0].value = 0;
+        gpio->AFR[1].value = 0;
+        gpio->resetCounters();
+    }
+}
+
+static PortSnapshot takeSnapshot(SimulatedGpio* gpio)
+{
+    return PortSnapshot{ gpio->MODER.value, gpio->OTYPER.value, gpio->OSPEEDR.value, gpio->PUPDR.value, gpio->AFR[0].value, gpio->AFR[1].value };
+}
+
+static bool operator==(const PortSnapshot& a, const PortSnapshot& b)
+{
+    return a.moder == b.moder && a.otyper == b.otyper && a.ospeedr == b.ospeedr && a.pupdr == b.pupdr && a.afrl == b.afrl && a.afrh == b.afrh;
+}
+
+/** @brief Configuration of the 42 test pins: all of port A and B except the debug pins, and C0..C14 */
+template<typename Action>
+static void forEachTestPin(const Action& action)
+{
+    constexpr GpioPort ports[] = { GpioPort::A, GpioPort::B, GpioPort::C };
+    for(const GpioPort& port : ports)
+    {
+        for(uint32_t pin = 0; pin < 16U; ++pin)
+        {
+            if((port == GpioPort::A && (pin == 13U || pin == 14U || pin == 15U)) || (port == GpioPort::B && (pin == 3U || pin == 4U)) || (port == GpioPort::C && pin > 14U))
+                continue;
+            action(port, static_cast<GpioPin>(pin), (pin % 2U) ? GpioMode::output : GpioMode::input, static_cast<GpioPUPD>(pin % 3U), static_cast<GpioOutputSpeed>(pin % 4U), static_cast<GpioOutputType>(pin % 2U));
+        }
+    }
+}
+
+template<GpioPort Port, uint32_t Pin = 0>
+static void applyPerPin(const GpioPin& pin, const GpioMode& mode, const GpioPUPD& pupd, const GpioOutputSpeed& speed, const GpioOutputType& type)
+{
+    if constexpr(Pin < 16U)
+    {
+        if(static_cast<uint32_t>(pin) != Pin)
+            return applyPerPin<Port, Pin + 1>(pin, mode, pupd, speed, type);
+        using Pin_t = StaticPin<Port, static_cast<GpioPin>(Pin), SimulatedRegisters>;
+        Pin_t::setMode(mode);
+        Pin_t::setPUPD(pupd);
+        Pin_t::setOutputSpeed(speed);
+        Pin_t::setOutputType(type);
+    }
+}
+
+static void batchMatchesPerPinConfiguration()
+{
+    std::size_t numberOfPins { 0 };
+
+    resetPorts();
+    forEachTestPin([&numberOfPins](const GpioPort& port, const GpioPin& pin, const GpioMode& mode, const GpioPUPD& pupd, const GpioOutputSpeed& speed, const GpioOutputType& type) {
+        ++numberOfPins;
+        if(port == GpioPort::A) applyPerPin<GpioPort::A>(pin, mode, pupd, speed, type);
+        if(port == GpioPort::B) applyPerPin<GpioPort::B>(pin, mode, pupd, speed, type);
+        if(port == GpioPort::C) applyPerPin<GpioPort::C>(pin, mode, pupd, speed, type);
+    });
+    PortSnapshot perPin[3];
+    uint32_t perPinAccesses { 0 };
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        perPin[i] = takeSnapshot(getPort(i));
+        perPinAccesses += getPort(i)->getAccesses();
+    }
+
+    resetPorts();
+    GpioConfigBatch batch;
+    forEachTestPin([&batch](const GpioPort& port, const GpioPin& pin, const GpioMode& mode, const GpioPUPD& pupd, const GpioOutputSpeed& speed, const GpioOutputType& type) {
+        batch.stageMode(port, pin, mode);
+        batch.stagePUPD(port, pin, pupd);
+        batch.stageOutputSpeed(port, pin, speed);
+        batch.stageOutputType(port, pin, type);
+    });
+    batch.commit<SimulatedRegisters>();
+    uint32_t batchAccesses { 0 };
+    for(std::size_t i = 0; i < 3; ++i)
+    {
+        TEST_ASSERT(takeSnapshot(getPort(i)) == perPin[i]);
+        batchAccesses += getPort(i)->getAccesses();
+    }
+
+    TEST_ASSERT(numberOfPins == 42);
+    TEST_ASSERT(perPinAccesses == numberOfPins * 4 * 2);
+    // 3 ports x 4 registers, at most a load and a store each
+    TEST_ASSERT(batchAccesses <= 24);
+    std::cout << "[bench] configuring " << numberOfPins << " pins: " << perPinAccesses << " register accesses pin by pin, " << batchAccesses << " batched" << std::endl;
+
+    batch.clear();
+    TEST_ASSERT(batch.isEmpty());
+}
+
+static void fullyStagedRegisterIsWrittenWithoutReading()
+{
+    resetPorts();
+    GpioConfigBatch batch;
+    for(uint32_t pin = 0; pin < 16U; ++pin)
+        batch.stageMode(GpioPort::B, static_cast<GpioPin>(pin), GpioMode::output);
+    batch.stageOutputType(GpioPort::B, GpioPin::_4, GpioOutputType::openDrain);
+    batch.commit<SimulatedRegisters>();
+
+    SimulatedGpio* gpio = getPort(1);
+    TEST_ASSERT(gpio->MODER.value == 0x55555555U);
+    TEST_ASSERT(gpio->MODER.reads == 0 && gpio->MODER.writes == 1);
+    TEST_ASSERT(gpio->OTYPER.value == 0x0010U);
+    TEST_ASSERT(gpio->OTYPER.reads == 1 && gpio->OTYPER.writes == 1);
+    TEST_ASSERT(getPort(0)->getAccesses() == 0);
+}
+
+static void pinMapConfiguresEveryPin()
+{
+    using TestPinMap = PinMap<
+        PinAssignment{ GpioPort::A, GpioPin::_2, GpioMode::alternateFunction, 7 },
+        PinAssignment{ GpioPort::A, GpioPin::_3, GpioMode::alternateFunction, 7 },
+        PinAssignment{ GpioPort::A, GpioPin::_9, GpioMode::alternateFunction, 7 },
+        PinAssignment{ GpioPort::A, GpioPin::_5, GpioMode::output },
+        PinAssignment{ GpioPort::C, GpioPin::_13, GpioMode::input }
+    >;
+    static_assert(TestPinMap::configuration.getStagedSettings(GpioPort::A).alternateFunctionValue[0] == 0x00007700U);
+
+    resetPorts();
+    TestPinMap::configure<SimulatedRegisters>();
+
+    SimulatedGpio* gpioA = getPort(0);
+    TEST_ASSERT(gpioA->AFR[0].value == 0x00007700U);
+    TEST_ASSERT(gpioA->AFR[1].value == 0x00000070U);
+    TEST_ASSERT(gpioA->MODER.value == 0xA80804A0U);
+    TEST_ASSERT(gpioA->getAccesses() == 6);
+    TEST_ASSERT(getPort(2)->MODER.value == 0xA0000000U);
+    TEST_ASSERT(getPort(1)->getAccesses() == 0);
+}
+
+void runGpioConfigBatchTests()
+{
+    batchMatchesPerPinConfiguration();
+    fullyStagedRegisterIsWrittenWithoutReading();
+    pinMapConfiguresEveryPin();
+}
@@ -0,0 +1,134 @@
+#include <GpioWaveform.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using Bus = GpioWaveform<GpioPort::B, 0x00F0U, SimulatedRegisters>;
+
+static_assert(Bus::bsrrAddress == GPIOB_BASE + 0x18U);
+static_assert(Bus::makeWord(0x00A0U) == 0x005000A0U);
+static_assert(Bus::makeWord(0xFF0FU) == 0x00F00000U);
+static_assert(Bus::makeWaveform(std::array<AllocatedPin_t, 2>{ 0x0010U, 0x0080U })[1] == 0x00700080U);
+
+static constexpr std::array<uint32_t, 4> squareWave { Bus::makeWaveform(std::array<AllocatedPin_t, 4>{ 0x00F0U, 0x0000U, 0x00F0U, 0x0000U }) };
+
+static void startConfiguresTimerAndStream()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOB_BASE>::get();
+    // The stream comes from DMAStream, which always uses the memory mapped registers
+    const DMA_Stream_TypeDef* stream = DMA2_Stream5;
+    TIM_TypeDef* timer = SimulatedRegisters<TIM_TypeDef, TIM1_BASE>::get();
+
+    TEST_ASSERT(Bus::start(squareWave.data(), squareWave.size(), 0, 99, true) == GpioWaveformStatusCodes::Ready);
+    TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN);
+    TEST_ASSERT(rcc->AHB1ENR & RCC_AHB1ENR_GPIOBEN);
+    TEST_ASSERT(rcc->APB2ENR & RCC_APB2ENR_TIM1EN);
+
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(stream->PAR)) == &gpio->BSRR);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(stream->M0AR)) == squareWave.data());
+    TEST_ASSERT(stream->NDTR == 4);
+    TEST_ASSERT(((stream->CR & DMA_SxCR_CHSEL) >> DMA_SxCR_CHSEL_Pos) == 6U);
+    TEST_ASSERT((stream->CR & DMA_SxCR_DIR) == DMA_SxCR_DIR_0);
+    TEST_ASSERT((stream->CR & (DMA_SxCR_MSIZE | DMA_SxCR_PSIZE)) == (DMA_SxCR_MSIZE_1 | DMA_SxCR_PSIZE_1));
+    TEST_ASSERT(stream->CR & DMA_SxCR_MINC);
+    TEST_ASSERT(!(stream->CR & DMA_SxCR_PINC));
+    TEST_ASSERT(stream->CR & DMA_SxCR_CIRC);
+    TEST_ASSERT(Bus::isRunning());
+
+    TEST_ASSERT(timer->PSC == 0 && timer->ARR == 99);
+    TEST_ASSERT(timer->DIER == TIM_DIER_UDE);
+    TEST_ASSERT(timer->CR1 & TIM_CR1_CEN);
+
+    Bus::stop();
+    TEST_ASSERT(!Bus::isRunning());
+    TEST_ASSERT(!(timer->CR1 & TIM_CR1_CEN));
+    TEST_ASSERT(!(timer->DIER & TIM_DIER_UDE));
+
+    TEST_ASSERT(Bus::start(squareWave.data(), 2, 0, 99) == GpioWaveformStatusCodes::Ready);
+    TEST_ASSERT(!(stream->CR & DMA_SxCR_CIRC));
+    TEST_ASSERT(Bus::getRemainingSamples() == 2);
+    Bus::stop();
+}
+
+static void invalidArgumentsAreRejected()
+{
+    TEST_ASSERT(Bus::start(nullptr, 4, 0, 99) == GpioWaveformStatusCodes::invalidBuffer);
+    TEST_ASSERT(Bus::start(squareWave.data(), 0, 0, 99) == GpioWaveformStatusCodes::invalidBuffer);
+    TEST_ASSERT(Bus::start(squareWave.data(), 4, 0, 0) == GpioWaveformStatusCodes::invalidTiming);
+}
+
+static void cpuCostDoesNotDependOnWaveformLength()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOB_BASE>::get();
+    gpio->resetCounters();
+
+    // Bit-banging: the CPU writes every sample
+    for(const uint32_t& word : squareWave)
+        gpio->BSRR = word;
+    TEST_ASSERT(gpio->getAccesses() == squareWave.size());
+    TEST_ASSERT((gpio->ODR.value & 0x00F0U) == 0);
+
+    // Waveform player: the CPU only configures the DMA and the timer, the port is written by the DMA
+    gpio->resetCounters();
+    Bus::start(squareWave.data(), squareWave.size(), 0, 99, true);
+    TEST_ASSERT(gpio->getAccesses() == 0);
+    Bus::stop();
+
+    std::cout << "[bench] " << squareWave.size() << "-sample waveform: " << squareWave.size() << " CPU BSRR stores bit-banging, 0 with DMA" << std::endl;
+}
+
+/** @brief Stream5 is the waveform's from start to stop: the DMA manager hands the other requests it can serve elsewhere */
+static void streamIsClaimedFromTheDMAManager()
+{
+    TEST_ASSERT(Bus::start(squareWave.data(), squareWave.size(), 0, 99, true) == GpioWaveformStatusCodes::Ready);
+    {
+        DMAStream spi { DMARequest::SPI1_TX };
+        DMAStream timer { DMARequest::TIM1_UP };
+        TEST_ASSERT(spi.init() == DMAStatusCodes::Ready && spi.getRoute()->stream == 3U);
+        TEST_ASSERT(timer.init() == DMAStatusCodes::noStreamAvailable);
+    }
+    Bus::stop();
+    TEST_ASSERT(DMAStream::getDriver(13) == nullptr);
+
+    // Held by another driver: the waveform does not start
+    {
+        DMAStream spi { DMARequest::SPI1_TX };
+        TEST_ASSERT(spi.init() == DMAStatusCodes::Ready);
+        DMAStream other { DMARequest::SPI1_TX };
+        TEST_ASSERT(other.init() == DMAStatusCodes::Ready && other.getRoute()->stream == 5U);
+        TEST_ASSERT(Bus::start(squareWave.data(), squareWave.size(), 0, 99, true) == GpioWaveformStatusCodes::streamBusy);
+        TEST_ASSERT(!Bus::isRunning());
+    }
+    TEST_ASSERT(Bus::start(squareWave.data(), squareWave.size(), 0, 99, true) == GpioWaveformStatusCodes::Ready);
+    Bus::stop();
+}
+
+/** @brief The waveform counts as a user of its clocks: the last driver handle of DMA2 or of the port does not gate them off */
+static void clocksOutliveTheOtherUsers()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    Bus::configurePins();
+    TEST_ASSERT(Bus::start(squareWave.data(), squareWave.size(), 0, 99, true) == GpioWaveformStatusCodes::Ready);
+    {
+        PeripheralClockHandle<> stream { AvailablePeripherals::_DMA2 };
+        PeripheralClockHandle<SimulatedRegisters> pin { AvailablePeripherals::_GPIOB };
+    }
+    TEST_ASSERT((RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN) && (rcc->AHB1ENR & RCC_AHB1ENR_GPIOBEN));
+    TEST_ASSERT(rcc->APB2ENR & RCC_APB2ENR_TIM1EN);
+
+    // Stopped: the stream and TIM1 are released, the port keeps driving the last level
+    Bus::stop();
+    TEST_ASSERT(PeripheralClockCounter<>::getUsers(AvailablePeripherals::_DMA2) == 0);
+    TEST_ASSERT(PeripheralClockCounter<SimulatedRegisters>::getUsers(AvailablePeripherals::_TIM1) == 0);
+    TEST_ASSERT(rcc->AHB1ENR & RCC_AHB1ENR_GPIOBEN);
+}
+
+void runGpioWaveformTests()
+{
+    startConfiguresTimerAndStream();
+    invalidArgumentsAreRejected();
+    streamIsClaimedFromTheDMAManager();
+    clocksOutliveTheOtherUsers();
+    cpuCostDoesNotDependOnWaveformLength();
+}
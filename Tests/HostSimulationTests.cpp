@@ -0,0 +1,140 @@
+#include <IOPin.hh>
+#include <STM32PeripheralBase.hh>
+#include <vector>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+static void instancesLiveInHostMemory()
+{
+    resetHostPeripherals();
+
+    // Every way a driver reaches an instance ends in the same block
+    TEST_ASSERT((GPIOA == PeripheralRegisters<GPIO_TypeDef, GPIOA_BASE>::get()));
+    TEST_ASSERT(GPIOC == getPeripheralInstance<GPIO_TypeDef>(GPIOC_BASE));
+    TEST_ASSERT(USART2 == std::get<1>(PeripheralMap<USART_TypeDef>::instances()));
+    TEST_ASSERT(getPeripheralInstance<USART_TypeDef>(GPIOA_BASE) == nullptr);
+    TEST_ASSERT(reinterpret_cast<uintptr_t>(RCC) != RCC_BASE);
+
+    // Reset values of RM0383
+    TEST_ASSERT(GPIOA->MODER == 0xA8000000U && GPIOB->PUPDR == 0x00000100U && GPIOC->MODER == 0x0U);
+    TEST_ASSERT((RCC->CR & RCC_CR_HSIRDY) && RCC->PLLCFGR == 0x24003010U);
+    TEST_ASSERT(USART1->SR == (USART_SR_TXE | USART_SR_TC));
+    TEST_ASSERT(PWR->CR == 0x00008000U && FLASH->OPTCR == 0x0FFFAAEDU && (FLASH->CR & FLASH_CR_LOCK));
+    TEST_ASSERT((EXTI == PeripheralRegisters<EXTI_TypeDef, EXTI_BASE>::get()));
+}
+
+/** @brief The blocks the drivers only reach through PeripheralRegisters are reset with the others */
+static void everyReachedInstanceIsReset()
+{
+    resetHostPeripherals();
+    EXTI->IMR = 0x1U << 13U;
+    SYSCFG->EXTICR[3] = 0x2U << 4U;
+    FLASH->ACR = FLASH_ACR_LATENCY_3WS | FLASH_ACR_PRFTEN;
+    TIM1->CR1 = TIM_CR1_CEN;
+    PeripheralRegisters<NVIC_Type, NVIC_BASE>::get()->ISER[1] = 0x1U;
+    PeripheralRegisters<SCB_Type, SCB_BASE>::get()->SCR = SCB_SCR_SLEEPDEEP_Msk;
+    PWR->CSR = PWR_CSR_WUF;
+    PWR->CR = PWR->CR | PWR_CR_CWUF;
+    stepHostPeripherals();
+    TEST_ASSERT(PWR->CSR == 0x0U && !(PWR->CR & PWR_CR_CWUF));
+
+    resetHostPeripherals();
+    TEST_ASSERT(EXTI->IMR == 0x0U && SYSCFG->EXTICR[3] == 0x0U && FLASH->ACR == 0x0U && TIM1->CR1 == 0x0U);
+    TEST_ASSERT((PeripheralRegisters<NVIC_Type, NVIC_BASE>::get()->ISER[1] == 0x0U));
+    TEST_ASSERT((PeripheralRegisters<SCB_Type, SCB_BASE>::get()->SCR == 0x0U));
+}
+
+static void hooksApplyTheHardwareSideEffects()
+{
+    resetHostPeripherals();
+
+    RCC->CR = RCC->CR | RCC_CR_HSEON | RCC_CR_PLLON;
+    RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | RCC_CFGR_SW_PLL;
+    TEST_ASSERT(!(RCC->CR & RCC_CR_HSERDY));
+    stepHostPeripherals();
+    TEST_ASSERT((RCC->CR & RCC_CR_HSERDY) && (RCC->CR & RCC_CR_PLLRDY));
+    TEST_ASSERT((RCC->CFGR & RCC_CFGR_SWS) == RCC_CFGR_SWS_PLL);
+    RCC->CR = RCC->CR & ~RCC_CR_HSEON;
+    stepHostPeripherals();
+    TEST_ASSERT(!(RCC->CR & RCC_CR_HSERDY));
+
+    GPIOD->MODER = 0x1U << (12U * 2U);
+    GPIOD->BSRR = (0x1U << 12U) | (0x1U << 3U);
+    stepHostPeripherals();
+    TEST_ASSERT(GPIOD->ODR == ((0x1U << 12U) | (0x1U << 3U)) && GPIOD->BSRR == 0x0U);
+    // Only the output pin is seen on IDR
+    TEST_ASSERT(GPIOD->IDR == (0x1U << 12U));
+    GPIOD->BSRR = 0x1U << (12U + 16U);
+    stepHostPeripherals();
+    TEST_ASSERT(GPIOD->ODR == (0x1U << 3U) && GPIOD->IDR == 0x0U);
+}
+
+static std::vector<uint8_t> transmitted {};
+
+/** @brief Custom hook: records the bytes written to DR and models SR as write-1-to-clear instead of rc_w0 */
+static void usartCaptureHook(USART_TypeDef& registers, const USART_TypeDef& previous)
+{
+    if(registers.DR != previous.DR)
+        transmitted.push_back(static_cast<uint8_t>(registers.DR));
+    const uint32_t written = registers.SR ^ previous.SR;
+    if(written)
+        registers.SR = previous.SR & ~(written & previous.SR);
+}
+
+static void hooksCanBeReplaced()
+{
+    resetHostPeripherals();
+    transmitted.clear();
+    HostPeripheral<USART_TypeDef, USART2_BASE>::setHook(&usartCaptureHook);
+
+    for(const char byte : { 'o', 'k' })
+    {
+        USART2->DR = static_cast<uint8_t>(byte);
+        stepHostPeripherals();
+    }
+    TEST_ASSERT(transmitted.size() == 2 && transmitted[0] == 'o' && transmitted[1] == 'k');
+
+    USART2->SR = USART_SR_TXE;
+    stepHostPeripherals();
+    TEST_ASSERT(USART2->SR == USART_SR_TXE);
+
+    // Other instances keep their default hook, and reset restores it
+    TEST_ASSERT(USART1->SR == (USART_SR_TXE | USART_SR_TC));
+    resetHostPeripherals();
+    USART2->DR = 'x';
+    stepHostPeripherals();
+    TEST_ASSERT(transmitted.size() == 2);
+}
+
+static void ioPinRunsOnTheHost()
+{
+    constexpr std::size_t iterations { 100000 };
+    resetHostPeripherals();
+
+    IOPin pin {};
+    TEST_ASSERT(pin.setPort(GpioPort::C) == IOPinStatusCodes::Ready);
+    TEST_ASSERT(pin.setPin(GpioPin::_13) == IOPinStatusCodes::Ready);
+    TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_GPIOCEN);
+    TEST_ASSERT(pin.setOutputMode() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(((GPIOC->MODER >> 26U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+    TEST_ASSERT(pin.setPullup() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(((GPIOC->PUPDR >> 26U) & 0x3U) == static_cast<uint32_t>(GpioPUPD::pullUp));
+
+    const double setModeNs = benchmarkNanoseconds(iterations, [&](const std::size_t& i)
+    {
+        pin.setMode((i & 0x1U) ? GpioMode::output : GpioMode::input);
+    });
+    TEST_ASSERT(((GPIOC->MODER >> 26U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+
+    std::cout << "[bench] IOPin::setMode on the simulated GPIOC (host): " << setModeNs << " ns" << std::endl;
+}
+
+void runHostSimulationTests()
+{
+    instancesLiveInHostMemory();
+    everyReachedInstanceIsReset();
+    hooksApplyTheHardwareSideEffects();
+    hooksCanBeReplaced();
+    ioPinRunsOnTheHost();
+    resetHostPeripherals();
+}
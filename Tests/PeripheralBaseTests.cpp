@@ -0,0 +1,320 @@
+#include <IOPin.hh>
+#include <Container.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+/** @brief IOPin's configuration steps on the simulated port A, shared by both dispatch schemes */
+struct PinConfigFunctions
+{
+    template<typename Pin>
+    static IOPinStatusCodes configPort(const GpioPort& port, Pin& pin)
+    {
+        pin.gpio = port == GpioPort::A ? SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get() : nullptr;
+        return pin.gpio ? IOPinStatusCodes::Ready : IOPinStatusCodes::notReadyNotReset;
+    }
+    template<typename Pin>
+    static IOPinStatusCodes configPin(const GpioPin& pin, Pin&)
+    {
+        return pin == GpioPin::null ? IOPinStatusCodes::notReadyNotReset : IOPinStatusCodes::Ready;
+    }
+    template<typename Pin>
+    static IOPinStatusCodes configMode(const GpioMode& mode, Pin& pin)
+    {
+        if(!pin.gpio)
+            return IOPinStatusCodes::notReadyNotReset;
+        if(mode == GpioMode::null)
+            return IOPinStatusCodes::Ready;
+        const uint32_t shift = static_cast<uint32_t>(pin.getPin()) * 2U;
+        pin.gpio->MODER = (static_cast<uint32_t>(pin.gpio->MODER) & ~(0x3U << shift)) | (static_cast<uint32_t>(mode) << shift);
+        return IOPinStatusCodes::Ready;
+    }
+    template<typename Pin>
+    static IOPinStatusCodes configState(const GpioState& state, Pin& pin)
+    {
+        if(!pin.gpio)
+            return IOPinStatusCodes::notReadyNotReset;
+        if(state == GpioState::null)
+            return IOPinStatusCodes::Ready;
+        const uint32_t bit = 0x1U << static_cast<uint32_t>(pin.getPin());
+        pin.gpio->BSRR = state == GpioState::high ? bit : bit << 16U;
+        return IOPinStatusCodes::Ready;
+    }
+};
+
+/** @brief IOPin's parameters on the CRTP PeripheralBase */
+class TestPin : public PeripheralBase<TestPin, IOPinStatusCodes, IOPinMandatoryParameters, IOPinPropertiesContainer>
+{
+    public:
+
+        using Parent = PeripheralBase<TestPin, IOPinStatusCodes, IOPinMandatoryParameters, IOPinPropertiesContainer>;
+
+        TestPin() : Parent(GpioPort::null, GpioPin::null, GpioMode::null, GpioState::null) { }
+        TestPin(const GpioPort& port, const GpioPin& pin, const GpioMode& mode, const GpioState& state) : TestPin() { setAllParametersValue(port, pin, mode, state); }
+
+        using Parent::init;
+        using Parent::setParameterValue;
+        using Parent::setParametersValues;
+        using Parent::setAllParametersDirty;
+        using Parent::getDirtyParameters;
+        using Parent::areMandatoryParametersSet;
+        using Parent::isValueSet;
+        using Parent::assertArgumentType;
+        GpioPin getPin() const { return getParameterValue<IOPinProperties::pin>(); }
+
+        SimulatedGpio* gpio { nullptr };
+
+    private:
+
+        friend Parent;
+        static constexpr ConfigFunctionsType getConfigFunctions()
+        {
+            return { &PinConfigFunctions::configPort<TestPin>, &PinConfigFunctions::configPin<TestPin>, &PinConfigFunctions::configMode<TestPin>, &PinConfigFunctions::configState<TestPin> };
+        }
+};
+
+/**
+ * @brief The dispatch PeripheralBase used before: parameters and config functions in Containers reached through
+ * pointers, one indirect call per parameter
+ */
+class LegacyPin
+{
+    public:
+
+        using Functions = Container<IOPinProperties, IOPinStatusCodes(*)(const GpioPort&, LegacyPin&), IOPinStatusCodes(*)(const GpioPin&, LegacyPin&),
+                                    IOPinStatusCodes(*)(const GpioMode&, LegacyPin&), IOPinStatusCodes(*)(const GpioState&, LegacyPin&)>;
+        using Parameters = Container<IOPinProperties, GpioPort, GpioPin, GpioMode, GpioState>;
+
+        LegacyPin(Parameters* parameters, Functions* functions) : parameters(parameters), functions(functions) { }
+
+        std::array<IOPinStatusCodes, 4> init()
+        {
+            return { invoke<IOPinProperties::port>(), invoke<IOPinProperties::pin>(), invoke<IOPinProperties::mode>(), invoke<IOPinProperties::state>() };
+        }
+        GpioPin getPin() { return parameters->getMemberValue<IOPinProperties::pin>(); }
+
+        SimulatedGpio* gpio { nullptr };
+
+    private:
+
+        template<IOPinProperties Parameter>
+        IOPinStatusCodes invoke() { return functions->getMemberValue<Parameter>()(parameters->getMemberValue<Parameter>(), *this); }
+
+        Parameters* parameters;
+        Functions* functions;
+};
+
+static_assert(!std::is_polymorphic_v<TestPin>);
+static_assert(TestPin::assertArgumentType<GpioMode>() && !TestPin::assertArgumentType<GpioPUPD>());
+
+static void configFunctionsRunInLabelOrder()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    gpio->MODER.value = 0;
+    gpio->ODR.value = 0;
+    gpio->resetCounters();
+
+    TestPin pin { GpioPort::A, GpioPin::_5, GpioMode::output, GpioState::high };
+    const auto responses = pin.init();
+    for(const IOPinStatusCodes& response : responses)
+        TEST_ASSERT(response == IOPinStatusCodes::Ready);
+    TEST_ASSERT(pin.gpio == gpio);
+    TEST_ASSERT(((gpio->MODER.value >> 10U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+    TEST_ASSERT(gpio->ODR.value == (0x1U << 5U));
+    TEST_ASSERT(pin.isValueSet(GpioMode::output).first() == static_cast<uint8_t>(IOPinProperties::mode));
+
+    pin.setParameterValue<IOPinProperties::port>(GpioPort::B);
+    const auto failed = pin.init();
+    TEST_ASSERT(failed[static_cast<std::size_t>(IOPinProperties::port)] == IOPinStatusCodes::notReadyNotReset);
+    TEST_ASSERT(failed[static_cast<std::size_t>(IOPinProperties::pin)] == IOPinStatusCodes::Ready);
+    // Only the port changed: state is not written again
+    TEST_ASSERT(failed[static_cast<std::size_t>(IOPinProperties::state)] == IOPinStatusCodes::Ready);
+    pin.setAllParametersDirty();
+    TEST_ASSERT(pin.init()[static_cast<std::size_t>(IOPinProperties::state)] == IOPinStatusCodes::notReadyNotReset);
+}
+
+static void dispatchIsResolvedAtCompileTime()
+{
+    constexpr std::size_t iterations { 200000 };
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+
+    LegacyPin::Parameters legacyParameters { GpioPort::A, GpioPin::_5, GpioMode::output, GpioState::high };
+    LegacyPin::Functions legacyFunctions { &PinConfigFunctions::configPort<LegacyPin>, &PinConfigFunctions::configPin<LegacyPin>,
+                                           &PinConfigFunctions::configMode<LegacyPin>, &PinConfigFunctions::configState<LegacyPin> };
+    LegacyPin legacy { &legacyParameters, &legacyFunctions };
+    TestPin pin { GpioPort::A, GpioPin::_5, GpioMode::output, GpioState::high };
+
+    gpio->resetCounters();
+    const double legacyNs = benchmarkNanoseconds(iterations, [&](const std::size_t&) { legacy.init(); });
+    const uint32_t legacyAccesses = gpio->getAccesses();
+    gpio->resetCounters();
+    const double crtpNs = benchmarkNanoseconds(iterations, [&](const std::size_t&) { pin.setAllParametersDirty(); pin.init(); });
+    const uint32_t crtpAccesses = gpio->getAccesses();
+
+    // Same register traffic, different dispatch
+    TEST_ASSERT(legacyAccesses == crtpAccesses);
+
+    std::cout << "[bench] IOPin-style init, 4 parameters (host): function pointer Containers " << legacyNs << " ns, 4 indirect calls, "
+              << sizeof(LegacyPin::Functions) + sizeof(LegacyPin::Parameters) << " bytes of tables and parameters; CRTP " << crtpNs << " ns, no indirect call, "
+              << sizeof(IOPinPropertiesContainer) << " bytes of parameters" << std::endl;
+}
+
+static void onlyChangedParametersAreWritten()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    gpio->resetCounters();
+
+    // Port and pin are mandatory: nothing runs until both are set
+    TestPin pin {};
+    for(const IOPinStatusCodes& response : pin.init())
+        TEST_ASSERT(response == IOPinStatusCodes::Reset);
+    TEST_ASSERT(gpio->getAccesses() == 0);
+    pin.setParameterValue<IOPinProperties::port>(GpioPort::A);
+    TEST_ASSERT(!pin.areMandatoryParametersSet());
+    pin.setParameterValue<IOPinProperties::pin>(GpioPin::_3);
+    TEST_ASSERT(pin.areMandatoryParametersSet());
+
+    pin.setParametersValues(GpioMode::output, GpioState::low);
+    pin.init();
+    TEST_ASSERT(pin.getDirtyParameters().none());
+    const uint32_t fullAccesses = gpio->getAccesses();
+
+    // Clean: no register access at all
+    gpio->resetCounters();
+    pin.init();
+    TEST_ASSERT(gpio->getAccesses() == 0);
+
+    // Same value: stays clean
+    pin.setParameterValue<IOPinProperties::mode>(GpioMode::output);
+    pin.setParametersValues(GpioState::low);
+    TEST_ASSERT(pin.getDirtyParameters().none());
+
+    // Only the state changed: one BSRR store
+    pin.setParameterValue<IOPinProperties::state>(GpioState::high);
+    TEST_ASSERT(pin.getDirtyParameters() == ContainerMask<4>{ 0x1U << static_cast<uint32_t>(IOPinProperties::state) });
+    pin.init();
+    TEST_ASSERT(gpio->BSRR.writes == 1 && gpio->MODER.reads == 0 && gpio->MODER.writes == 0);
+    TEST_ASSERT(gpio->ODR.value & (0x1U << 3U));
+
+    // A failing config function keeps its parameter dirty
+    pin.setParameterValue<IOPinProperties::port>(GpioPort::B);
+    pin.init();
+    TEST_ASSERT(pin.getDirtyParameters().test(static_cast<std::size_t>(IOPinProperties::port)));
+    pin.setParameterValue<IOPinProperties::port>(GpioPort::A);
+    pin.init();
+    TEST_ASSERT(pin.getDirtyParameters().none());
+
+    std::cout << "[bench] IOPin-style re-init after a state change: " << fullAccesses << " register accesses for a full init, "
+              << gpio->BSRR.writes << " for the incremental one" << std::endl;
+}
+
+/** @brief The real IOPin, not a stand-in: its config functions have to point the pin at its GPIO themselves */
+static void ioPinInitializesFromItsConstructor()
+{
+    resetHostPeripherals();
+
+    IOPin unset {};
+    TEST_ASSERT(unset.init() == IOPinStatusCodes::notReadyNotReset);
+
+    IOPin pin { GpioPort::A, GpioPin::_5, GpioMode::output, GpioState::high };
+    TEST_ASSERT(pin.init() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_GPIOAEN);
+    TEST_ASSERT(((GPIOA->MODER >> 10U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+    stepHostPeripherals();
+    TEST_ASSERT(GPIOA->ODR & (0x1U << 5U));
+}
+
+/** @brief Moving a pin invalidates what mode, state and the queued settings wrote: they follow it to the new pin */
+static void rePinnedIOPinMovesItsSettings()
+{
+    resetHostPeripherals();
+    const uint32_t resetModer = GPIOA->MODER;
+
+    IOPin pin {};
+    pin.setPort(GpioPort::A);
+    pin.setPin(GpioPin::_5);
+    pin.setMode(GpioMode::output);
+    pin.setPullup();
+    TEST_ASSERT(pin.init() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(GPIOA->MODER == (resetModer | (0x1U << 10U)));
+
+    pin.setPin(GpioPin::_6);
+    TEST_ASSERT(pin.init() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(GPIOA->MODER == (resetModer | (0x1U << 12U)));
+    TEST_ASSERT(((GPIOA->PUPDR >> 12U) & 0x3U) == static_cast<uint32_t>(GpioPUPD::pullUp));
+
+    // To another port: the former one is released before its clock handle
+    pin.setPort(GpioPort::B);
+    TEST_ASSERT(pin.init() == IOPinStatusCodes::Ready);
+    TEST_ASSERT(GPIOA->MODER == resetModer);
+    TEST_ASSERT(((GPIOB->MODER >> 12U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+}
+
+/** @brief A pin is held by one IOPin from configuration to destruction; the others are refused and never write it */
+static void ioPinHoldsItsPin()
+{
+    resetHostPeripherals();
+    const uint32_t resetModer = GPIOA->MODER;
+    {
+        IOPin first { GpioPort::A, GpioPin::_7, GpioMode::input };
+        TEST_ASSERT(first.init() == IOPinStatusCodes::Ready);
+        TEST_ASSERT(IOPin::isAllocated(GpioPort::A, GpioPin::_7) && IOPin::isAllocated(GPIOA, GpioPin::_7));
+
+        IOPin second { GpioPort::A, GpioPin::_7, GpioMode::output };
+        TEST_ASSERT(second.init() == IOPinStatusCodes::alreadyAllocatedPin);
+        TEST_ASSERT(second.setOutputMode() == IOPinStatusCodes::Reset);
+        TEST_ASSERT(GPIOA->MODER == resetModer);
+
+        TEST_ASSERT(second.setPin(GpioPin::_8) == IOPinStatusCodes::Ready);
+        TEST_ASSERT(second.init() == IOPinStatusCodes::Ready);
+        TEST_ASSERT(GPIOA->MODER == (resetModer | (0x1U << 16U)));
+        TEST_ASSERT(first.setPin(GpioPin::_8) == IOPinStatusCodes::alreadyAllocatedPin);
+        TEST_ASSERT(IOPin::isAllocated(GpioPort::A, GpioPin::_7) && IOPin::isAllocated(GpioPort::A, GpioPin::_8));
+    }
+    TEST_ASSERT(!IOPin::isAllocated(GpioPort::A, GpioPin::_7) && !IOPin::isAllocated(GpioPort::A, GpioPin::_8));
+}
+
+static void countInterrupt(void* context) { ++*static_cast<uint32_t*>(context); }
+
+/** @brief The EXTI line of an IOPin follows the pin it holds: moving or destroying the pin masks and releases it */
+static void ioPinReleasesItsInterruptLine()
+{
+    resetHostPeripherals();
+    auto* exti = PeripheralRegisters<EXTI_TypeDef, EXTI_BASE>::get();
+    uint32_t calls { 0 };
+    {
+        IOPin button { GpioPort::C, GpioPin::_13, GpioMode::input };
+        TEST_ASSERT(button.enableInterrupt(GpioTrigger::falling, &countInterrupt, &calls) == IOPinStatusCodes::notReadyNotReset);
+        TEST_ASSERT(button.init() == IOPinStatusCodes::Ready);
+        TEST_ASSERT(button.enableInterrupt(GpioTrigger::falling, &countInterrupt, &calls) == IOPinStatusCodes::Ready);
+        TEST_ASSERT(exti->IMR & (0x1U << 13U));
+        TEST_ASSERT(ExternalInterrupt<>::isEnabled(GpioPin::_13));
+
+        TEST_ASSERT(button.setPin(GpioPin::_12) == IOPinStatusCodes::Ready);
+        TEST_ASSERT(!(exti->IMR & (0x1U << 13U)));
+        TEST_ASSERT(!ExternalInterrupt<>::isEnabled(GpioPin::_13));
+        exti->PR = 0x1U << 13U;
+        ExternalInterrupt<>::dispatchLines(0x1U << 13U);
+        TEST_ASSERT(calls == 0U);
+
+        // The line is free for another port, and the moved pin arms its own
+        IOPin other { GpioPort::A, GpioPin::_13, GpioMode::input };
+        TEST_ASSERT(other.init() == IOPinStatusCodes::Ready);
+        TEST_ASSERT(other.enableInterrupt(GpioTrigger::rising, &countInterrupt, &calls) == IOPinStatusCodes::Ready);
+        TEST_ASSERT(button.enableInterrupt(GpioTrigger::falling, &countInterrupt, &calls) == IOPinStatusCodes::Ready);
+        TEST_ASSERT(exti->IMR & (0x1U << 12U));
+    }
+    TEST_ASSERT(!(exti->IMR & ((0x1U << 12U) | (0x1U << 13U))));
+    TEST_ASSERT(!ExternalInterrupt<>::isEnabled(GpioPin::_12) && !ExternalInterrupt<>::isEnabled(GpioPin::_13));
+}
+
+void runPeripheralBaseTests()
+{
+    configFunctionsRunInLabelOrder();
+    dispatchIsResolvedAtCompileTime();
+    onlyChangedParametersAreWritten();
+    ioPinInitializesFromItsConstructor();
+    rePinnedIOPinMovesItsSettings();
+    ioPinHoldsItsPin();
+    ioPinReleasesItsInterruptLine();
+}
@@ -0,0 +1,116 @@
+#include <PinGroup.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using DataBus = PortBus<GpioPort::B, GpioPin::_8, 8, SimulatedRegisters>;
+using ControlLines = PinGroupOn<SimulatedRegisters, GpioPort::B, GpioPin::_0, GpioPin::_2, GpioPin::_5>;
+
+static_assert(DataBus::mask == 0xFF00U);
+static_assert(ControlLines::mask == 0x0025U);
+static_assert(PinGroup<GpioPort::A, GpioPin::_15, GpioPin::_0>::mask == 0x8001U);
+
+static SimulatedGpio* getPortB() { return SimulatedRegisters<GPIO_TypeDef, GPIOB_BASE>::get(); }
+
+static void busWriteIsOneStore()
+{
+    SimulatedGpio* gpio = getPortB();
+    gpio->ODR.value = 0x00FFU;
+    gpio->resetCounters();
+
+    DataBus::writeValue(0xA5U);
+    TEST_ASSERT(gpio->getAccesses() == 1);
+    TEST_ASSERT(gpio->BSRR.value == 0x5A00A500U);
+    TEST_ASSERT(gpio->ODR.value == 0xA5FFU);
+
+    DataBus::writeValue(0x1FFU);
+    TEST_ASSERT(gpio->ODR.value == 0xFFFFU);
+}
+
+static void busReadIsOneLoad()
+{
+    SimulatedGpio* gpio = getPortB();
+    gpio->IDR.value = 0x3C5AU;
+    gpio->resetCounters();
+
+    TEST_ASSERT(DataBus::readValue() == 0x3CU);
+    TEST_ASSERT(ControlLines::read() == 0x0000U);
+    gpio->IDR.value = 0x0027U;
+    TEST_ASSERT(ControlLines::read() == 0x0025U);
+    TEST_ASSERT(gpio->IDR.reads == 3);
+    TEST_ASSERT(gpio->getAccesses() == 3);
+}
+
+static void groupOnlyDrivesItsOwnPins()
+{
+    SimulatedGpio* gpio = getPortB();
+    gpio->ODR.value = 0x0000U;
+
+    ControlLines::set(0xFFFFU);
+    TEST_ASSERT(gpio->ODR.value == 0x0025U);
+    ControlLines::clear(0x0004U);
+    TEST_ASSERT(gpio->ODR.value == 0x0021U);
+    ControlLines::write(0x0004U);
+    TEST_ASSERT(gpio->ODR.value == 0x0004U);
+
+    gpio->ODR.value = 0x8004U;
+    gpio->resetCounters();
+    ControlLines::toggle();
+    TEST_ASSERT(gpio->ODR.value == 0x8021U);
+    TEST_ASSERT(gpio->getAccesses() == 2);
+
+    gpio->MODER.value = 0xFFFFFFFFU;
+    ControlLines::setMode(GpioMode::output);
+    TEST_ASSERT(gpio->MODER.value == 0xFFFFF7DDU);
+}
+
+/** @brief 8-bit parallel bus: one byte per iteration, per-pin (ODR read-modify-write and BSRR) vs grouped */
+static void benchmarkBusWrites()
+{
+    constexpr std::size_t iterations { 100000 };
+    SimulatedGpio* gpio = getPortB();
+
+    gpio->resetCounters();
+    const double perPinReadModifyWrite = benchmarkNanoseconds(iterations, [gpio](const std::size_t& i) {
+        for(uint32_t bit = 0; bit < 8U; ++bit)
+        {
+            const uint32_t pinMask = 0x1U << (8U + bit);
+            const uint32_t odr = gpio->ODR;
+            gpio->ODR = ((i >> bit) & 0x1U) ? (odr | pinMask) : (odr & ~pinMask);
+        }
+    });
+    printBenchmark("8-bit bus, per-pin ODR read-modify-write", perPinReadModifyWrite, static_cast<double>(gpio->getAccesses()) / iterations);
+
+    gpio->resetCounters();
+    const double perPinBsrr = benchmarkNanoseconds(iterations, [](const std::size_t& i) {
+        StaticPin<GpioPort::B, GpioPin::_8, SimulatedRegisters>::write(i & 0x01U);
+        StaticPin<GpioPort::B, GpioPin::_9, SimulatedRegisters>::write(i & 0x02U);
+        StaticPin<GpioPort::B, GpioPin::_10, SimulatedRegisters>::write(i & 0x04U);
+        StaticPin<GpioPort::B, GpioPin::_11, SimulatedRegisters>::write(i & 0x08U);
+        StaticPin<GpioPort::B, GpioPin::_12, SimulatedRegisters>::write(i & 0x10U);
+        StaticPin<GpioPort::B, GpioPin::_13, SimulatedRegisters>::write(i & 0x20U);
+        StaticPin<GpioPort::B, GpioPin::_14, SimulatedRegisters>::write(i & 0x40U);
+        StaticPin<GpioPort::B, GpioPin::_15, SimulatedRegisters>::write(i & 0x80U);
+    });
+    const uint32_t perPinBsrrAccesses = gpio->getAccesses();
+    printBenchmark("8-bit bus, per-pin BSRR", perPinBsrr, static_cast<double>(perPinBsrrAccesses) / iterations);
+
+    gpio->resetCounters();
+    const double grouped = benchmarkNanoseconds(iterations, [](const std::size_t& i) {
+        DataBus::writeValue(static_cast<uint16_t>(i));
+    });
+    const uint32_t groupedAccesses = gpio->getAccesses();
+    printBenchmark("8-bit bus, PortBus", grouped, static_cast<double>(groupedAccesses) / iterations);
+
+    TEST_ASSERT(perPinBsrrAccesses == 8 * iterations);
+    TEST_ASSERT(groupedAccesses == iterations);
+    TEST_ASSERT((gpio->ODR.value >> 8U) == ((iterations - 1) & 0xFFU));
+}
+
+void runPinGroupTests()
+{
+    busWriteIsOneStore();
+    busReadIsOneLoad();
+    groupOnlyDrivesItsOwnPins();
+    benchmarkBusWrites();
+}
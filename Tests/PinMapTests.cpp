@@ -0,0 +1,54 @@
+#include <PinMap.hh>
+#include <BoardPinMap.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using TestPinMap = PinMap<
+    PinAssignment{ GpioPort::A, GpioPin::_9, GpioMode::alternateFunction, 7 },
+    PinAssignment{ GpioPort::A, GpioPin::_10, GpioMode::alternateFunction, 7 },
+    PinAssignment{ GpioPort::B, GpioPin::_0, GpioMode::output },
+    PinAssignment{ GpioPort::H, GpioPin::_1, GpioMode::input }
+>;
+
+static_assert(TestPinMap::numberOfPins == 4);
+static_assert(TestPinMap::contains(GpioPort::A, GpioPin::_9));
+static_assert(!TestPinMap::contains(GpioPort::B, GpioPin::_9));
+static_assert(TestPinMap::getAllocatedPins(GpioPort::A) == 0x0600U);
+static_assert(TestPinMap::getAllocatedPins(GpioPort::H) == 0x0002U);
+static_assert(TestPinMap::getAllocatedPins(GpioPort::C) == 0x0000U);
+static_assert(TestPinMap::getAllocatedPins(GpioPort::null) == 0x0000U);
+static_assert(TestPinMap::getAssignment(GpioPort::A, GpioPin::_10).alternateFunction == 7);
+static_assert(TestPinMap::getAssignment(GpioPort::C, GpioPin::_0).mode == GpioMode::null);
+static_assert(BoardPinMap::contains(GpioPort::A, GpioPin::_5));
+
+template<typename Map, GpioPort Port, GpioPin Pin>
+concept DeclaredPin = requires { typename Map::template StaticPinType<Port, Pin>; };
+
+static_assert(DeclaredPin<TestPinMap, GpioPort::B, GpioPin::_0>);
+static_assert(!DeclaredPin<TestPinMap, GpioPort::B, GpioPin::_1>);
+
+static void staticPinFromMapDrivesThePin()
+{
+    using OutputPin = TestPinMap::StaticPinType<GpioPort::B, GpioPin::_0, SimulatedRegisters>;
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOB_BASE>::get();
+    gpio->ODR.value = 0;
+
+    OutputPin::set();
+    TEST_ASSERT(gpio->ODR.value == 0x0001U);
+}
+
+static void runtimeLookupsMatchTheMap()
+{
+    for(const PinAssignment& assignment : BoardPinMap::assignments)
+    {
+        TEST_ASSERT(BoardPinMap::contains(assignment.port, assignment.pin));
+        TEST_ASSERT(BoardPinMap::getAllocatedPins(assignment.port) & (0x1U << static_cast<uint32_t>(assignment.pin)));
+    }
+}
+
+void runPinMapTests()
+{
+    staticPinFromMapDrivesThePin();
+    runtimeLookupsMatchTheMap();
+}
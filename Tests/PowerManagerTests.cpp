@@ -0,0 +1,215 @@
+#include <PowerManager.hh>
+#include <BoardClockConfiguration.hh>
+#include <USART.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+/**
+ * @brief Core whose WFI lasts sleepCycles and, in deep sleep, comes back on the HSI as a stop exit does. The cycle
+ * counter stops in deep sleep, as DWT CYCCNT does
+ */
+struct SimulatedCore
+{
+    static inline uint32_t cycles { 0 };
+    static inline uint32_t sleepCycles { 0 };
+    static inline uint32_t powerControlAtWfi { 0 };
+    static inline bool deepSleepAtWfi { false };
+
+    static void enableCycleCounter() { }
+    static uint32_t getCycleCount() { return cycles; }
+    static void waitForInterrupt()
+    {
+        powerControlAtWfi = SimulatedRegisters<PWR_TypeDef, PWR_BASE>::get()->CR;
+        deepSleepAtWfi = SimulatedRegisters<SCB_Type, SCB_BASE>::get()->SCR & SCB_SCR_SLEEPDEEP_Msk;
+        if(!deepSleepAtWfi)
+            cycles += sleepCycles;
+        if(deepSleepAtWfi)
+        {
+            SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+            const bool hseOscillatorPresent = rcc->CR.hseOscillatorPresent;
+            rcc->reset();
+            rcc->CR.hseOscillatorPresent = hseOscillatorPresent;
+            SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get()->reset();
+        }
+    }
+};
+
+using Power = PowerManager<SimulatedRegisters, SimulatedCore>;
+using SimulatedClockTree = ClockTree<SimulatedRegisters>;
+
+static_assert(getDeepestPowerMode(0) == PowerMode::run);
+static_assert(getDeepestPowerMode(10) == PowerMode::sleep);
+static_assert(getDeepestPowerMode(50) == PowerMode::stop);
+static_assert(getDeepestPowerMode(200) == PowerMode::stopLowPowerRegulator);
+static_assert(getDeepestPowerMode(Power::noConstraint) == PowerMode::standby);
+
+static void deepestModeFollowsTheTightestConstraint()
+{
+    // Standby resets the chip: without constraint, idle stops at the low-power regulator until it is allowed
+    TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+    TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::stopLowPowerRegulator);
+    Power::allowStandby(true);
+    TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::standby);
+    Power::allowStandby(false);
+    const uint8_t radio = Power::addWakeLatencyConstraint(200);
+    const uint8_t uart = Power::addWakeLatencyConstraint(20);
+    TEST_ASSERT(radio != Power::invalidConstraint && uart != Power::invalidConstraint && radio != uart);
+    TEST_ASSERT(Power::getWakeLatencyBudget() == 20);
+    TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::stop);
+
+    Power::removeWakeLatencyConstraint(uart);
+    TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::stopLowPowerRegulator);
+    Power::removeWakeLatencyConstraint(radio);
+    TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+
+    uint8_t ids[Power::maxConstraints];
+    for(uint8_t& id : ids)
+        id = Power::addWakeLatencyConstraint(1000);
+    TEST_ASSERT(Power::addWakeLatencyConstraint(0) == Power::invalidConstraint);
+    for(const uint8_t& id : ids)
+        Power::removeWakeLatencyConstraint(id);
+}
+
+static void sleepKeepsOnlyTheRequestedClocks()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+    rcc->AHB1LPENR = 0x0061900FU;
+    Power::init();
+    TEST_ASSERT(rcc->APB1ENR.value & RCC_APB1ENR_PWREN);
+    // LPENR is only written on the way into sleep
+    TEST_ASSERT(rcc->AHB1LPENR.value == 0x0061900FU);
+
+    SimulatedCore::sleepCycles = 500;
+    const uint8_t serial = Power::addWakeLatencyConstraint(Power::sleepOnly, peripheralClockMask<APB1BridgePeripherals::_USART2, AHB1BridgePeripherals::_DMA1>);
+    TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::sleep);
+    TEST_ASSERT(Power::idle<boardClockConfiguration>() == PowerManagerStatusCodes::Ready);
+    TEST_ASSERT(!SimulatedCore::deepSleepAtWfi);
+    TEST_ASSERT(rcc->APB1LPENR.value == RCC_APB1LPENR_USART2LPEN && rcc->APB2LPENR.value == 0);
+    TEST_ASSERT(rcc->AHB1LPENR.value == (RCC_AHB1LPENR_DMA1LPEN | RCC_AHB1LPENR_FLITFLPEN | RCC_AHB1LPENR_SRAM1LPEN));
+
+    // Same constraints, no new write
+    rcc->APB1LPENR.resetCounters();
+    Power::enter<boardClockConfiguration>(PowerMode::sleep);
+    TEST_ASSERT(rcc->APB1LPENR.writes == 0);
+
+    // Clocks of constraints sharing a peripheral stay until the last of them goes
+    const uint8_t stream = Power::addWakeLatencyConstraint(Power::sleepOnly, peripheralClockMask<AHB1BridgePeripherals::_DMA1>);
+    Power::removeWakeLatencyConstraint(serial);
+    Power::enter<boardClockConfiguration>(PowerMode::sleep);
+    TEST_ASSERT(rcc->APB1LPENR.value == 0 && (rcc->AHB1LPENR.value & RCC_AHB1LPENR_DMA1LPEN));
+    Power::removeWakeLatencyConstraint(stream);
+    Power::enter<boardClockConfiguration>(PowerMode::sleep);
+    TEST_ASSERT(rcc->AHB1LPENR.value == 0);
+}
+
+static void transfersInFlightKeepTheirClocks()
+{
+    resetHostPeripherals();
+    static std::array<uint8_t, 16> source {};
+    static volatile uint32_t data { 0 };
+    {
+        // A busy stream keeps its controller clock in sleep, and the idle path out of stop
+        DMAStream stream { DMARequest::USART2_TX };
+        TEST_ASSERT(stream.init() == DMAStatusCodes::Ready);
+        TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+        TEST_ASSERT(stream.start(DMATransfer{ .direction = DMADirection::memoryToPeripheral, .peripheral = &data, .memory = source.data(), .length = 4 }) == DMAStatusCodes::Ready);
+        TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::sleep);
+        TEST_ASSERT(Power::getSleepClocks() == peripheralClockMask<AHB1BridgePeripherals::_DMA1>);
+        TEST_ASSERT(stream.stop());
+        TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+
+        // The interrupt that finds the one-shot transfer done drops it
+        TEST_ASSERT(stream.start(DMATransfer{ .direction = DMADirection::memoryToPeripheral, .peripheral = &data, .memory = source.data(), .length = 4 }) == DMAStatusCodes::Ready);
+        DMA1_Stream6->CR = DMA1_Stream6->CR & ~DMA_SxCR_EN;
+        DMA1->HISR = DMA_HISR_TCIF6;
+        stream.handleInterrupt();
+        TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+    }
+    {
+        // A receiving USART keeps its own clock, its DMA controller and its pin port
+        USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+        TEST_ASSERT(serial.init() == USARTStatusCodes::Ready);
+        TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+        static uint8_t buffer[16] {};
+        TEST_ASSERT(serial.startReceiving(buffer, sizeof(buffer), [](const uint8_t*, const uint16_t&, void*) { }) == USARTStatusCodes::Ready);
+        TEST_ASSERT(Power::getAllowedPowerMode() == PowerMode::sleep);
+        TEST_ASSERT((Power::getSleepClocks() == peripheralClockMask<APB1BridgePeripherals::_USART2, AHB1BridgePeripherals::_DMA1, AHB1BridgePeripherals::_GPIOA>));
+        serial.stopReceiving();
+        TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint);
+        TEST_ASSERT(serial.startReceiving(buffer, sizeof(buffer), [](const uint8_t*, const uint16_t&, void*) { }) == USARTStatusCodes::Ready);
+    }
+    // Destroyed while receiving
+    TEST_ASSERT(Power::getWakeLatencyBudget() == Power::noConstraint && Power::getSleepClocks().isEmpty());
+}
+
+static void stopRestoresTheClockTree()
+{
+    SimulatedClockTree::apply<boardClockConfiguration>();
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::MainPLL);
+
+    TEST_ASSERT(Power::enter<boardClockConfiguration>(PowerMode::stopLowPowerRegulator) == PowerManagerStatusCodes::Ready);
+    TEST_ASSERT(SimulatedCore::deepSleepAtWfi);
+    TEST_ASSERT((SimulatedCore::powerControlAtWfi & (PWR_CR_LPDS | PWR_CR_FPDS | PWR_CR_PDDS)) == (PWR_CR_LPDS | PWR_CR_FPDS));
+    // Woke up on the HSI, back on the PLL with its wait states
+    TEST_ASSERT(SimulatedClockTree::getSystemClockSource() == rccClockSource::MainPLL);
+    TEST_ASSERT((SimulatedRegisters<FLASH_TypeDef, FLASH_R_BASE>::get()->ACR.value & FLASH_ACR_LATENCY) == FLASH_ACR_LATENCY_3WS);
+    TEST_ASSERT(!(SimulatedRegisters<SCB_Type, SCB_BASE>::get()->SCR & SCB_SCR_SLEEPDEEP_Msk));
+
+    TEST_ASSERT(Power::enter<boardClockConfiguration>(PowerMode::stop) == PowerManagerStatusCodes::Ready);
+    TEST_ASSERT(!(SimulatedCore::powerControlAtWfi & (PWR_CR_LPDS | PWR_CR_FPDS | PWR_CR_PDDS)));
+
+    // Entered on request even though idle does not pick it
+    TEST_ASSERT(Power::enter<boardClockConfiguration>(PowerMode::standby) == PowerManagerStatusCodes::Ready);
+    TEST_ASSERT(SimulatedCore::powerControlAtWfi & PWR_CR_PDDS);
+
+    // The HSE of this configuration never starts
+    SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->CR.hseOscillatorPresent = false;
+    constexpr ClockConfiguration hse { .source = rccClockSource::HSE, .sourceFrequency = 8000000UL, .sysclk = 8000000UL, .hclk = 8000000UL, .pclk1 = 8000000UL, .pclk2 = 8000000UL };
+    TEST_ASSERT(Power::enter<hse>(PowerMode::stop) == PowerManagerStatusCodes::clockRestoreFailed);
+    SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->CR.hseOscillatorPresent = true;
+}
+
+static void cyclesAreAccountedPerMode()
+{
+    Power::resetStatistics();
+    const uint8_t constraint = Power::addWakeLatencyConstraint(50);
+
+    // 1000 cycles of work, then idle for 4000, three times
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        SimulatedCore::cycles += 1000;
+        SimulatedCore::sleepCycles = 4000;
+        Power::idle<boardClockConfiguration>();
+    }
+    SimulatedCore::sleepCycles = 250;
+    Power::enter<boardClockConfiguration>(PowerMode::sleep);
+
+    // The time in stop is not seen by the counter: only the entries are
+    TEST_ASSERT(Power::getStatistics(PowerMode::stop).entries == 3 && Power::getStatistics(PowerMode::stop).cycles == 0);
+    TEST_ASSERT(Power::getStatistics(PowerMode::sleep).entries == 1 && Power::getStatistics(PowerMode::sleep).cycles == 250);
+    TEST_ASSERT(Power::getStatistics(PowerMode::run).cycles == 3000);
+    // Standby wakes up through a reset
+    Power::enter<boardClockConfiguration>(PowerMode::standby);
+    TEST_ASSERT(Power::getStatistics(PowerMode::standby).entries == 0 && Power::getStatistics(PowerMode::run).cycles == 3000);
+    std::cout << "[bench] idle loop, 1000 run / 4000 idle cycles: " << Power::getStatistics(PowerMode::run).cycles << " run cycles accounted" << std::endl;
+
+    // The 32-bit counter wraps between two transitions
+    Power::resetStatistics();
+    SimulatedCore::cycles = 0xFFFFFF00U;
+    SimulatedCore::sleepCycles = 0x200U;
+    Power::enter<boardClockConfiguration>(PowerMode::sleep);
+    TEST_ASSERT(Power::getStatistics(PowerMode::sleep).cycles == 0x200U);
+
+    Power::removeWakeLatencyConstraint(constraint);
+}
+
+void runPowerManagerTests()
+{
+    deepestModeFollowsTheTightestConstraint();
+    sleepKeepsOnlyTheRequestedClocks();
+    transfersInFlightKeepTheirClocks();
+    stopRestoresTheClockTree();
+    cyclesAreAccountedPerMode();
+}
@@ -0,0 +1,186 @@
+#include <RingBuffer.hh>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+static void elementsComeOutInOrder()
+{
+    RingBuffer<uint8_t, 8> queue {};
+    uint8_t value { 0 };
+    TEST_ASSERT(queue.isEmpty() && !queue.pop(value));
+    for(uint8_t i = 0; i < 8; ++i)
+        TEST_ASSERT(queue.push(i));
+    // Every slot is usable
+    TEST_ASSERT(queue.isFull() && !queue.push(8));
+    TEST_ASSERT(queue.pop(value) && value == 0);
+
+    // Bulk accesses split at the end of the storage
+    const std::array<uint8_t, 4> more { 8, 9, 10, 11 };
+    TEST_ASSERT(queue.push(std::span<const uint8_t>(more)) == 1);
+    std::array<uint8_t, 16> out {};
+    TEST_ASSERT(queue.pop(std::span<uint8_t>(out)) == 8);
+    TEST_ASSERT(out[0] == 1 && out[6] == 7 && out[7] == 8);
+    TEST_ASSERT(queue.push(std::span<const uint8_t>(more)) == 4);
+    TEST_ASSERT(queue.pop(std::span<uint8_t>(out.data(), 2)) == 2 && out[0] == 8 && out[1] == 9);
+
+    // In-place accesses: write and read spans stop at the wrap
+    std::span<uint8_t> free = queue.getWriteSpan();
+    TEST_ASSERT(free.size() == 3);
+    free[0] = 12;
+    queue.commitWrite(1);
+    std::span<const uint8_t> filled = queue.getReadSpan();
+    TEST_ASSERT(filled.size() == 3 && filled[0] == 10 && filled[2] == 12);
+    queue.commitRead(filled.size());
+    TEST_ASSERT(queue.isEmpty());
+    TEST_ASSERT(queue.getWriteSpan().size() == 2);
+}
+
+static void indicesWrapAround()
+{
+    RingBuffer<uint32_t, 4> queue {};
+    uint32_t value { 0 };
+    bool ordered { true };
+    for(uint32_t i = 0; i < 100000; ++i)
+    {
+        queue.push(i);
+        queue.push(i);
+        ordered = ordered && queue.pop(value) && value == i && queue.pop(value) && value == i;
+    }
+    TEST_ASSERT(ordered && queue.isEmpty());
+}
+
+/** @brief Producer and consumer on two threads, with bulk and single accesses of varying sizes */
+static void concurrentProducerAndConsumer()
+{
+    constexpr uint32_t elements { 200000 };
+    static RingBuffer<uint32_t, 64> queue {};
+
+    std::thread producer([]()
+    {
+        std::array<uint32_t, 13> block {};
+        uint32_t next { 0 };
+        while(next < elements)
+        {
+            if(next % 3U == 0)
+            {
+                if(queue.push(next))
+                    ++next;
+                else
+                    std::this_thread::yield();
+                continue;
+            }
+            const std::size_t size = std::min<std::size_t>(1U + next % block.size(), elements - next);
+            for(std::size_t i = 0; i < size; ++i)
+                block[i] = next + static_cast<uint32_t>(i);
+            const std::size_t pushed = queue.push(std::span<const uint32_t>(block.data(), size));
+            if(!pushed)
+                std::this_thread::yield();
+            next += static_cast<uint32_t>(pushed);
+        }
+    });
+
+    uint32_t expected { 0 };
+    bool ordered { true };
+    std::array<uint32_t, 7> block {};
+    while(expected < elements)
+    {
+        if(queue.isEmpty())
+        {
+            // The test host may have a single core: let the producer run instead of spinning out the time slice
+            std::this_thread::yield();
+            continue;
+        }
+        if(expected % 2U)
+        {
+            for(const uint32_t value : queue.getReadSpan())
+            {
+                ordered = ordered && value == expected;
+                ++expected;
+                queue.commitRead(1);
+            }
+            continue;
+        }
+        const std::size_t count = queue.pop(std::span<uint32_t>(block));
+        for(std::size_t i = 0; i < count; ++i)
+            ordered = ordered && block[i] == expected++;
+    }
+    producer.join();
+    TEST_ASSERT(ordered && expected == elements && queue.isEmpty());
+}
+
+/** @brief The same queue behind a lock, as a critical section around a shared array would be */
+class LockedQueue
+{
+    public:
+
+        std::size_t push(std::span<const uint8_t> values)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return queue.push(values);
+        }
+        std::size_t pop(std::span<uint8_t> values)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return queue.pop(values);
+        }
+
+    private:
+
+        std::mutex mutex {};
+        RingBuffer<uint8_t, 1024> queue {};
+};
+
+template<typename Queue>
+static double streamBytes(Queue& queue, const std::size_t& bytes, const std::size_t& chunk)
+{
+    std::thread producer([&]()
+    {
+        std::vector<uint8_t> data(chunk, 0x55U);
+        std::size_t sent { 0 };
+        while(sent < bytes)
+        {
+            const std::size_t pushed = queue.push(std::span<const uint8_t>(data.data(), std::min(chunk, bytes - sent)));
+            if(!pushed)
+                std::this_thread::yield();
+            sent += pushed;
+        }
+    });
+    std::vector<uint8_t> data(chunk);
+    std::size_t received { 0 };
+    const double ns = benchmarkNanoseconds(1, [&](const std::size_t&)
+    {
+        while(received < bytes)
+        {
+            const std::size_t popped = queue.pop(std::span<uint8_t>(data));
+            if(!popped)
+                std::this_thread::yield();
+            received += popped;
+        }
+    });
+    producer.join();
+    TEST_ASSERT(received == bytes);
+    return static_cast<double>(bytes) * 1000.0 / ns;
+}
+
+static void lockFreeThroughput()
+{
+    constexpr std::size_t bytes { 8U << 20U };
+    constexpr std::size_t chunk { 64 };
+    static RingBuffer<uint8_t, 1024> lockFree {};
+    static LockedQueue locked {};
+
+    const double lockFreeMBs = streamBytes(lockFree, bytes, chunk);
+    const double lockedMBs = streamBytes(locked, bytes, chunk);
+    std::cout << "[bench] SPSC stream of " << (bytes >> 20U) << " MiB in " << chunk << "-byte chunks, 2 threads (host): lock-free "
+              << lockFreeMBs << " MB/s, mutex " << lockedMBs << " MB/s" << std::endl;
+}
+
+void runRingBufferTests()
+{
+    elementsComeOutInOrder();
+    indicesWrapAround();
+    concurrentProducerAndConsumer();
+    lockFreeThroughput();
+}
@@ -0,0 +1,176 @@
+#include <STM32PeripheralBase.hh>
+#include <IOPin.hh>
+#include <cstddef>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using GpioShadow = ShadowRegisters<GPIO_TypeDef, offsetof(GPIO_TypeDef, MODER), offsetof(GPIO_TypeDef, OTYPER),
+                                   offsetof(GPIO_TypeDef, OSPEEDR), offsetof(GPIO_TypeDef, PUPDR)>;
+
+class ShadowedPin;
+using ShadowedPinBase = PeripheralBase<ShadowedPin, IOPinStatusCodes, IOPinMandatoryParameters, IOPinPropertiesContainer>;
+
+/**
+ * @brief IOPin-like driver whose configuration registers are shadowed. The port is a host GPIO_TypeDef standing in
+ * for the peripheral, so every register holds plain memory that the test can change behind the driver's back
+ */
+class ShadowedPin : public STM32PeripheralBase<GPIO_TypeDef, ShadowedPinBase, GpioShadow>
+{
+    public:
+
+        using Parent = STM32PeripheralBase<GPIO_TypeDef, ShadowedPinBase, GpioShadow>;
+
+        explicit ShadowedPin(GPIO_TypeDef* port) : Parent(GpioPort::A, GpioPin::null, GpioMode::null, GpioState::null) { instance = port; }
+
+        using Parent::readRegister;
+        using Parent::writeRegister;
+        using Parent::modifyRegister;
+        using Parent::loadShadowRegisters;
+        using Parent::flushShadowRegisters;
+        using Parent::setInstancePtr;
+        using Parent::setParameterValue;
+
+        /** @brief Re-initializes the dirty parameters and writes the changed registers back */
+        void apply()
+        {
+            init();
+            flushShadowRegisters();
+        }
+        void applyWithoutFlush() { init(); }
+
+    private:
+
+        friend ShadowedPinBase;
+        static IOPinStatusCodes configPort(const GpioPort&, ShadowedPin&) { return IOPinStatusCodes::Ready; }
+        static IOPinStatusCodes configPin(const GpioPin& pin, ShadowedPin&) { return pin == GpioPin::null ? IOPinStatusCodes::notReadyNotReset : IOPinStatusCodes::Ready; }
+        static IOPinStatusCodes configMode(const GpioMode& mode, ShadowedPin& pin)
+        {
+            const uint32_t shift = static_cast<uint32_t>(pin.getParameterValue<IOPinProperties::pin>()) * 2U;
+            pin.modifyRegister<offsetof(GPIO_TypeDef, MODER)>(0x3U << shift, static_cast<uint32_t>(mode) << shift);
+            return IOPinStatusCodes::Ready;
+        }
+        static IOPinStatusCodes configState(const GpioState& state, ShadowedPin& pin)
+        {
+            if(state == GpioState::null)
+                return IOPinStatusCodes::Ready;
+            const uint32_t bit = 0x1U << static_cast<uint32_t>(pin.getParameterValue<IOPinProperties::pin>());
+            pin.writeRegister<offsetof(GPIO_TypeDef, BSRR)>(state == GpioState::high ? bit : bit << 16U);
+            return IOPinStatusCodes::Ready;
+        }
+        static constexpr ConfigFunctionsType getConfigFunctions() { return { &configPort, &configPin, &configMode, &configState }; }
+};
+
+// No shadowed register: the default layer takes no room
+static_assert(std::is_empty_v<ShadowRegisters<GPIO_TypeDef>>);
+static_assert(GpioShadow::isShadowed<offsetof(GPIO_TypeDef, PUPDR)>() && !GpioShadow::isShadowed<offsetof(GPIO_TypeDef, ODR)>());
+
+static void shadowedRegistersAreServedFromRam()
+{
+    GPIO_TypeDef port {};
+    port.MODER = 0xA8000000U;
+    port.PUPDR = 0x64000000U;
+    ShadowedPin pin { &port };
+
+    // Loaded on first use
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, MODER)>() == 0xA8000000U);
+    port.MODER = 0x0U;
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, MODER)>() == 0xA8000000U);
+
+    // Writes stay in RAM until the flush
+    pin.modifyRegister<offsetof(GPIO_TypeDef, OSPEEDR)>(0x0U, 0x3U << 4U);
+    TEST_ASSERT(port.OSPEEDR == 0x0U);
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, OSPEEDR)>() == (0x3U << 4U));
+
+    // Only the modified register is written back: MODER, changed behind the shadow, keeps its hardware value
+    port.PUPDR = 0x1U;
+    pin.flushShadowRegisters();
+    TEST_ASSERT(port.OSPEEDR == (0x3U << 4U));
+    TEST_ASSERT(port.MODER == 0x0U);
+    TEST_ASSERT(port.PUPDR == 0x1U);
+
+    // A new load drops the stale copies
+    pin.loadShadowRegisters();
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, MODER)>() == 0x0U);
+
+    // Registers outside the shadow go straight to the peripheral
+    pin.writeRegister<offsetof(GPIO_TypeDef, ODR)>(0x20U);
+    TEST_ASSERT(port.ODR == 0x20U);
+    port.IDR = 0x8U;
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, IDR)>() == 0x8U);
+}
+
+static void configFunctionsFlushInOneBurst()
+{
+    GPIO_TypeDef port {};
+    ShadowedPin pin { &port };
+    pin.setParameterValue<IOPinProperties::port>(GpioPort::A);
+    pin.setParameterValue<IOPinProperties::pin>(GpioPin::_5);
+    pin.setParameterValue<IOPinProperties::mode>(GpioMode::output);
+    pin.setParameterValue<IOPinProperties::state>(GpioState::high);
+
+    pin.applyWithoutFlush();
+    // MODER is pending, the BSRR strobe is not shadowed
+    TEST_ASSERT(port.MODER == 0x0U);
+    TEST_ASSERT(port.BSRR == (0x1U << 5U));
+    pin.flushShadowRegisters();
+    TEST_ASSERT(((port.MODER >> 10U) & 0x3U) == static_cast<uint32_t>(GpioMode::output));
+
+    // Setting the same mode again ends in no write at all
+    port.MODER = 0x0U;
+    pin.setParameterValue<IOPinProperties::mode>(GpioMode::input);
+    pin.setParameterValue<IOPinProperties::mode>(GpioMode::output);
+    pin.apply();
+    TEST_ASSERT(port.MODER == 0x0U);
+}
+
+static void shadowedReadModifyWrite()
+{
+    constexpr std::size_t iterations { 200000 };
+    constexpr uint32_t fields { 4 };
+    GPIO_TypeDef port {};
+    ShadowedPin pin { &port };
+
+    const double directNs = benchmarkNanoseconds(iterations, [&](const std::size_t& i)
+    {
+        const uint32_t value = static_cast<uint32_t>(i) & 0x3U;
+        port.MODER = (static_cast<uint32_t>(port.MODER) & ~0x3U) | value;
+        port.OTYPER = (static_cast<uint32_t>(port.OTYPER) & ~0x1U) | (value & 0x1U);
+        port.OSPEEDR = (static_cast<uint32_t>(port.OSPEEDR) & ~0x3U) | value;
+        port.PUPDR = (static_cast<uint32_t>(port.PUPDR) & ~0x3U) | (value & 0x1U);
+    });
+    const double shadowNs = benchmarkNanoseconds(iterations, [&](const std::size_t& i)
+    {
+        const uint32_t value = static_cast<uint32_t>(i) & 0x3U;
+        pin.modifyRegister<offsetof(GPIO_TypeDef, MODER)>(0x3U, value);
+        pin.modifyRegister<offsetof(GPIO_TypeDef, OTYPER)>(0x1U, value & 0x1U);
+        pin.modifyRegister<offsetof(GPIO_TypeDef, OSPEEDR)>(0x3U, value);
+        pin.modifyRegister<offsetof(GPIO_TypeDef, PUPDR)>(0x3U, value & 0x1U);
+        pin.flushShadowRegisters();
+    });
+    TEST_ASSERT(port.MODER == ((iterations - 1U) & 0x3U));
+
+    std::cout << "[bench] " << fields << " read-modify-writes + flush (host): volatile registers " << directNs << " ns, "
+              << 2U * fields << " bus accesses; shadowed " << shadowNs << " ns, 0 bus reads and at most " << fields << " writes" << std::endl;
+}
+
+/** @brief Rebinding to another instance writes the pending copies to the former one before loading the new one */
+static void rebindingFlushesThePendingWrites()
+{
+    resetHostPeripherals();
+    ShadowedPin pin { GPIOA };
+    pin.modifyRegister<offsetof(GPIO_TypeDef, OSPEEDR)>(0x0U, 0x3U << 4U);
+    TEST_ASSERT(GPIOA->OSPEEDR == 0x0C000000U);
+
+    TEST_ASSERT(pin.setInstancePtr(GPIOB));
+    TEST_ASSERT(GPIOA->OSPEEDR == (0x0C000000U | (0x3U << 4U)));
+    TEST_ASSERT(pin.readRegister<offsetof(GPIO_TypeDef, OSPEEDR)>() == 0x000000C0U);
+    TEST_ASSERT(GPIOB->OSPEEDR == 0x000000C0U);
+}
+
+void runShadowRegistersTests()
+{
+    shadowedRegistersAreServedFromRam();
+    rebindingFlushesThePendingWrites();
+    configFunctionsFlushInOneBurst();
+    shadowedReadModifyWrite();
+}
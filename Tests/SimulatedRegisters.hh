@@ -0,0 +1,233 @@
+#ifndef __SIMULATEDREGISTERS_H__
+#define __SIMULATEDREGISTERS_H__
+
+/**
+ * @file SimulatedRegisters.hh
+ * @brief Host-memory register blocks used in place of the memory mapped peripherals.
+ * SimulatedRegisters is a drop-in replacement for PeripheralRegisters: every base address gets its own
+ * zero-initialized instance. GPIO ports are backed by counting registers so tests can assert how many
+ * bus accesses a driver operation performs.
+ */
+
+#include <PeripheralBaseTypes.hh>
+#include <initializer_list>
+
+/** @brief 32-bit register that counts every load and store performed through it */
+struct CountingRegister
+{
+    uint32_t value { 0 };
+    uint32_t reads { 0 };
+    uint32_t writes { 0 };
+
+    operator uint32_t() { ++reads; return value; }
+    CountingRegister& operator=(const uint32_t& newValue) { ++writes; value = newValue; return *this; }
+    void resetCounters() { reads = 0; writes = 0; }
+};
+
+/** @brief BSRR: a store sets/resets bits of ODR as the hardware does (set wins over reset) */
+struct BitSetResetRegister : CountingRegister
+{
+    explicit BitSetResetRegister(CountingRegister& odr) : odr(odr) { }
+    BitSetResetRegister& operator=(const uint32_t& newValue)
+    {
+        CountingRegister::operator=(newValue);
+        odr.value = (odr.value & ~(newValue >> 16U)) | (newValue & 0xFFFFU);
+        return *this;
+    }
+    CountingRegister& odr;
+};
+
+/** @brief Write-1-to-clear register, e.g. EXTI PR */
+struct WriteOneToClearRegister : CountingRegister
+{
+    WriteOneToClearRegister& operator=(const uint32_t& newValue) { ++writes; value &= ~newValue; return *this; }
+};
+
+/** @brief EXTI_TypeDef layout with counting registers. Tests raise lines by setting bits of PR.value */
+struct SimulatedExti
+{
+    CountingRegister IMR;
+    CountingRegister EMR;
+    CountingRegister RTSR;
+    CountingRegister FTSR;
+    CountingRegister SWIER;
+    WriteOneToClearRegister PR;
+
+    uint32_t getAccesses() { return IMR.reads + IMR.writes + EMR.reads + EMR.writes + RTSR.reads + RTSR.writes + FTSR.reads + FTSR.writes + SWIER.reads + SWIER.writes + PR.reads + PR.writes; }
+    void resetCounters() { IMR.resetCounters(); EMR.resetCounters(); RTSR.resetCounters(); FTSR.resetCounters(); SWIER.resetCounters(); PR.resetCounters(); }
+};
+
+/** @brief RCC CR: every oscillator/PLL enable bit is reflected in its ready bit right away. The HSE and the PLL can be made to never start */
+struct RccControlRegister : CountingRegister
+{
+    RccControlRegister& operator=(const uint32_t& newValue)
+    {
+        ++writes;
+        uint32_t ready = ((newValue & RCC_CR_HSION) ? RCC_CR_HSIRDY : 0U) | (((newValue & RCC_CR_PLLON) && pllLocks) ? RCC_CR_PLLRDY : 0U)
+                       | ((newValue & RCC_CR_PLLI2SON) ? RCC_CR_PLLI2SRDY : 0U) | (((newValue & RCC_CR_HSEON) && hseOscillatorPresent) ? RCC_CR_HSERDY : 0U);
+        value = (newValue & ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY | RCC_CR_PLLI2SRDY)) | ready;
+        return *this;
+    }
+    bool hseOscillatorPresent { true };
+    bool pllLocks { true };
+};
+
+/** @brief RCC CFGR: SWS follows SW right away */
+struct RccConfigurationRegister : CountingRegister
+{
+    RccConfigurationRegister& operator=(const uint32_t& newValue)
+    {
+        ++writes;
+        value = (newValue & ~RCC_CFGR_SWS) | ((newValue & RCC_CFGR_SW) << RCC_CFGR_SWS_Pos);
+        return *this;
+    }
+};
+
+/** @brief RCC_TypeDef layout with counting registers. Starts in the reset state: HSI on and selected */
+struct SimulatedRcc
+{
+    RccControlRegister CR { { RCC_CR_HSION | RCC_CR_HSIRDY } };
+    CountingRegister PLLCFGR { 0x24003010U };
+    RccConfigurationRegister CFGR;
+    CountingRegister CIR;
+    CountingRegister AHB1RSTR;
+    CountingRegister AHB2RSTR;
+    CountingRegister APB1RSTR;
+    CountingRegister APB2RSTR;
+    CountingRegister AHB1ENR;
+    CountingRegister AHB2ENR;
+    CountingRegister APB1ENR;
+    CountingRegister APB2ENR;
+    CountingRegister AHB1LPENR;
+    CountingRegister AHB2LPENR;
+    CountingRegister APB1LPENR;
+    CountingRegister APB2LPENR;
+    CountingRegister BDCR;
+    CountingRegister CSR;
+    CountingRegister SSCGR;
+    CountingRegister PLLI2SCFGR;
+    CountingRegister DCKCFGR;
+
+    uint32_t getAccesses()
+    {
+        uint32_t accesses { 0 };
+        for(CountingRegister* reg : { static_cast<CountingRegister*>(&CR), &PLLCFGR, static_cast<CountingRegister*>(&CFGR), &CIR, &AHB1RSTR, &AHB2RSTR, &APB1RSTR, &APB2RSTR,
+                                      &AHB1ENR, &AHB2ENR, &APB1ENR, &APB2ENR, &AHB1LPENR, &AHB2LPENR, &APB1LPENR, &APB2LPENR, &BDCR, &CSR, &SSCGR, &PLLI2SCFGR, &DCKCFGR })
+            accesses += reg->reads + reg->writes;
+        return accesses;
+    }
+    void reset() { *this = SimulatedRcc{}; }
+};
+
+/** @brief FLASH ACR: counts the cache resets that take effect, i.e. ICRST/DCRST written while the cache is disabled */
+struct FlashAccessControlRegister : CountingRegister
+{
+    FlashAccessControlRegister& operator=(const uint32_t& newValue)
+    {
+        ++writes;
+        if((newValue & FLASH_ACR_ICRST) && !(newValue & FLASH_ACR_ICEN) && !(value & FLASH_ACR_ICEN))
+            ++instructionCacheResets;
+        if((newValue & FLASH_ACR_DCRST) && !(newValue & FLASH_ACR_DCEN) && !(value & FLASH_ACR_DCEN))
+            ++dataCacheResets;
+        value = newValue;
+        return *this;
+    }
+    uint32_t instructionCacheResets { 0 };
+    uint32_t dataCacheResets { 0 };
+};
+
+/** @brief FLASH_TypeDef layout with a counting access control register */
+struct SimulatedFlash
+{
+    FlashAccessControlRegister ACR;
+    CountingRegister KEYR;
+    CountingRegister OPTKEYR;
+    CountingRegister SR;
+    CountingRegister CR;
+    CountingRegister OPTCR;
+
+    void reset() { *this = SimulatedFlash{}; }
+};
+
+/** @brief GPIO_TypeDef layout with counting registers */
+struct SimulatedGpio
+{
+    CountingRegister MODER;
+    CountingRegister OTYPER;
+    CountingRegister OSPEEDR;
+    CountingRegister PUPDR;
+    CountingRegister IDR;
+    CountingRegister ODR;
+    BitSetResetRegister BSRR { ODR };
+    CountingRegister LCKR;
+    CountingRegister AFR[2];
+
+    uint32_t getReads() { return MODER.reads + OTYPER.reads + OSPEEDR.reads + PUPDR.reads + IDR.reads + ODR.reads + BSRR.reads + LCKR.reads + AFR[0].reads + AFR[1].reads; }
+    uint32_t getWrites() { return MODER.writes + OTYPER.writes + OSPEEDR.writes + PUPDR.writes + IDR.writes + ODR.writes + BSRR.writes + LCKR.writes + AFR[0].writes + AFR[1].writes; }
+    uint32_t getAccesses() { return getReads() + getWrites(); }
+    void resetCounters()
+    {
+        MODER.resetCounters(); OTYPER.resetCounters(); OSPEEDR.resetCounters(); PUPDR.resetCounters(); IDR.resetCounters();
+        ODR.resetCounters(); BSRR.resetCounters(); LCKR.resetCounters(); AFR[0].resetCounters(); AFR[1].resetCounters();
+    }
+};
+
+template<typename Peripheral, uint32_t BaseAddress>
+struct SimulatedRegisters
+{
+    static Peripheral* get() { static Peripheral instance{}; return &instance; }
+};
+
+template<uint32_t BaseAddress>
+struct SimulatedRegisters<GPIO_TypeDef, BaseAddress>
+{
+    static SimulatedGpio* get() { static SimulatedGpio instance{}; return &instance; }
+};
+
+template<uint32_t BaseAddress>
+struct SimulatedRegisters<RCC_TypeDef, BaseAddress>
+{
+    static SimulatedRcc* get() { static SimulatedRcc instance{}; return &instance; }
+};
+
+/** @brief PWR CR: counts the VOS changes made while the main PLL is on, which the hardware does not allow */
+struct PowerControlRegister : CountingRegister
+{
+    PowerControlRegister& operator=(const uint32_t& newValue)
+    {
+        if(((newValue ^ value) & PWR_CR_VOS) && (SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get()->CR.value & RCC_CR_PLLON))
+            ++voltageScaleWritesWithPllOn;
+        CountingRegister::operator=(newValue);
+        return *this;
+    }
+    uint32_t voltageScaleWritesWithPllOn { 0 };
+};
+
+/** @brief PWR_TypeDef layout with counting registers */
+struct SimulatedPwr
+{
+    PowerControlRegister CR;
+    CountingRegister CSR;
+
+    void reset() { *this = SimulatedPwr{}; }
+};
+
+template<uint32_t BaseAddress>
+struct SimulatedRegisters<PWR_TypeDef, BaseAddress>
+{
+    static SimulatedPwr* get() { static SimulatedPwr instance{}; return &instance; }
+};
+
+template<uint32_t BaseAddress>
+struct SimulatedRegisters<FLASH_TypeDef, BaseAddress>
+{
+    static SimulatedFlash* get() { static SimulatedFlash instance{}; return &instance; }
+};
+
+template<uint32_t BaseAddress>
+struct SimulatedRegisters<EXTI_TypeDef, BaseAddress>
+{
+    static SimulatedExti* get() { static SimulatedExti instance{}; return &instance; }
+};
+
+#endif // __SIMULATEDREGISTERS_H__
@@ -0,0 +1,126 @@
+#include <StaticPin.hh>
+#include "SimulatedRegisters.hh"
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+using Led = StaticPin<GpioPort::A, GpioPin::_5, SimulatedRegisters>;
+using Button = StaticPin<GpioPort::C, GpioPin::_13, SimulatedRegisters>;
+
+static_assert(sizeof(Led) == 1, "StaticPin must not carry any state");
+static_assert(!std::is_polymorphic_v<Led>, "StaticPin must not carry a vtable");
+static_assert(Led::mask == 0x0020U);
+static_assert(Led::baseAddress == GPIOA_BASE);
+static_assert(Button::baseAddress == GPIOC_BASE);
+static_assert(StaticPin<GpioPort::H, GpioPin::_1>::baseAddress == GPIOH_BASE);
+
+static void outputOperationsTouchOnlyBSRR()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    gpio->resetCounters();
+
+    Led::set();
+    TEST_ASSERT(gpio->getAccesses() == 1);
+    TEST_ASSERT(gpio->BSRR.writes == 1);
+    TEST_ASSERT(gpio->BSRR.value == 0x00000020U);
+    TEST_ASSERT(gpio->ODR.value & Led::mask);
+
+    gpio->resetCounters();
+    Led::clear();
+    TEST_ASSERT(gpio->getAccesses() == 1);
+    TEST_ASSERT(gpio->BSRR.value == 0x00200000U);
+    TEST_ASSERT(!(gpio->ODR.value & Led::mask));
+
+    gpio->resetCounters();
+    Led::write(true);
+    TEST_ASSERT(gpio->getAccesses() == 1);
+    TEST_ASSERT(gpio->BSRR.value == 0x00000020U);
+
+    gpio->resetCounters();
+    Led::write(false);
+    TEST_ASSERT(gpio->getAccesses() == 1);
+    TEST_ASSERT(gpio->BSRR.value == 0x00200000U);
+}
+
+static void toggleIsOneLoadAndOneStore()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOA_BASE>::get();
+    gpio->ODR.value = 0x0001U;
+    gpio->resetCounters();
+
+    Led::toggle();
+    TEST_ASSERT(gpio->ODR.reads == 1);
+    TEST_ASSERT(gpio->BSRR.writes == 1);
+    TEST_ASSERT(gpio->getAccesses() == 2);
+    TEST_ASSERT(gpio->ODR.value == 0x0021U);
+
+    Led::toggle();
+    TEST_ASSERT(gpio->ODR.value == 0x0001U);
+}
+
+static void inputOperationsTouchOnlyIDR()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOC_BASE>::get();
+    gpio->IDR.value = 0x2000U;
+    gpio->resetCounters();
+
+    TEST_ASSERT(Button::read());
+    TEST_ASSERT(gpio->IDR.reads == 1);
+    TEST_ASSERT(gpio->getAccesses() == 1);
+
+    gpio->IDR.value = 0xDFFFU;
+    TEST_ASSERT(!Button::read());
+}
+
+static void configurationOnlyTouchesOwnField()
+{
+    SimulatedGpio* gpio = SimulatedRegisters<GPIO_TypeDef, GPIOC_BASE>::get();
+    gpio->MODER.value = 0xFFFFFFFFU;
+    gpio->PUPDR.value = 0x0U;
+    gpio->OTYPER.value = 0x0U;
+    gpio->OSPEEDR.value = 0x0U;
+    gpio->resetCounters();
+
+    Button::setMode(GpioMode::input);
+    TEST_ASSERT(gpio->MODER.value == 0xF3FFFFFFU);
+    TEST_ASSERT(gpio->MODER.reads == 1 && gpio->MODER.writes == 1);
+
+    Button::setPUPD(GpioPUPD::pullUp);
+    TEST_ASSERT(gpio->PUPDR.value == 0x04000000U);
+
+    Button::setOutputType(GpioOutputType::openDrain);
+    TEST_ASSERT(gpio->OTYPER.value == 0x2000U);
+
+    Button::setOutputSpeed(GpioOutputSpeed::high);
+    TEST_ASSERT(gpio->OSPEEDR.value == 0x0C000000U);
+    TEST_ASSERT(gpio->getAccesses() == 8);
+
+    Button::setMode(GpioMode::null);
+    TEST_ASSERT(gpio->getAccesses() == 8);
+}
+
+/** @brief The pin type is one user of the port clock, whatever the number of enableClock calls */
+static void pinTypeHoldsThePortClock()
+{
+    SimulatedRcc* rcc = SimulatedRegisters<RCC_TypeDef, RCC_BASE>::get();
+    rcc->reset();
+
+    Button::enableClock();
+    Button::enableClock();
+    TEST_ASSERT(PeripheralClockCounter<SimulatedRegisters>::getUsers(AvailablePeripherals::_GPIOC) == 1);
+    {
+        // A driver of the same port comes and goes
+        PeripheralClockHandle<SimulatedRegisters> pin { AvailablePeripherals::_GPIOC };
+    }
+    TEST_ASSERT(rcc->AHB1ENR.value & RCC_AHB1ENR_GPIOCEN);
+    Button::disableClock();
+    TEST_ASSERT(!(rcc->AHB1ENR.value & RCC_AHB1ENR_GPIOCEN));
+}
+
+void runStaticPinTests()
+{
+    outputOperationsTouchOnlyBSRR();
+    toggleIsOneLoadAndOneStore();
+    inputOperationsTouchOnlyIDR();
+    configurationOnlyTouchesOwnField();
+    pinTypeHoldsThePortClock();
+}
@@ -0,0 +1,46 @@
+#ifndef __TESTUTILS_H__
+#define __TESTUTILS_H__
+
+#include <iostream>
+#include <cstddef>
+#include <chrono>
+
+/**
+ * @brief Minimal host-side assertion helpers shared by every test file.
+ * Failures are reported but do not abort, so one run lists every broken check.
+ */
+inline std::size_t testChecks{0};
+inline std::size_t testFailures{0};
+
+inline void testCheck(const bool& condition, const char* expression, const char* file, const int& line)
+{
+    ++testChecks;
+    if(!condition)
+    {
+        ++testFailures;
+        std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+    }
+}
+
+#define TEST_ASSERT(condition) testCheck(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+/**
+ * @brief Runs action the given number of times and returns the mean wall-clock time of one run, in nanoseconds.
+ * Host timings are only meaningful relative to each other within the same run.
+ */
+template<typename Action>
+double benchmarkNanoseconds(const std::size_t& iterations, const Action& action)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < iterations; ++i)
+        action(i);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(iterations);
+}
+
+inline void printBenchmark(const char* name, const double& nanoseconds, const double& busAccesses)
+{
+    std::cout << "[bench] " << name << ": " << nanoseconds << " ns, " << busAccesses << " register accesses" << std::endl;
+}
+
+#endif // __TESTUTILS_H__
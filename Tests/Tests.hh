@@ -0,0 +1,29 @@
+#ifndef __TESTS_H__
+#define __TESTS_H__
+
+/**
+ * @brief Entry points of every host test suite. Each one is defined in its own file under Tests/
+ */
+void runStaticPinTests();
+void runPinGroupTests();
+void runPinMapTests();
+void runGpioConfigBatchTests();
+void runExternalInterruptTests();
+void runAlternateFunctionMapTests();
+void runGpioWaveformTests();
+void runClockTreeTests();
+void runClockFrequenciesTests();
+void runFlashAcceleratorTests();
+void runClockGatingTests();
+void runPowerManagerTests();
+void runFlatContainerTests();
+void runContainerQueryTests();
+void runPeripheralBaseTests();
+void runShadowRegistersTests();
+void runHostSimulationTests();
+void runDMATests();
+void runUSARTTests();
+void runRingBufferTests();
+void runMemoryTransferTests();
+
+#endif // __TESTS_H__
@@ -0,0 +1,209 @@
+#include <USART.hh>
+#include <array>
+#include <string>
+#include <vector>
+#include "TestUtils.hh"
+#include "Tests.hh"
+
+extern "C" void USART2_IRQHandler();
+extern "C" void DMA1_Stream5_IRQHandler();
+extern "C" void DMA1_Stream6_IRQHandler();
+
+/** @brief Moves the simulated hardware one step and runs the interrupt handlers of USART2, as the NVIC would */
+static void stepUsart2()
+{
+    stepHostPeripherals();
+    DMA1_Stream5_IRQHandler();
+    DMA1_Stream6_IRQHandler();
+    USART2_IRQHandler();
+}
+
+struct ReceivedData
+{
+    std::vector<uint8_t> bytes {};
+    std::vector<const uint8_t*> views {};
+    uint32_t calls { 0 };
+};
+
+static void collect(const uint8_t* data, const uint16_t& length, void* context)
+{
+    ReceivedData& received = *static_cast<ReceivedData*>(context);
+    received.bytes.insert(received.bytes.end(), data, data + length);
+    received.views.push_back(data);
+    ++received.calls;
+}
+
+static void countCompletion(void* context)
+{
+    ++*static_cast<uint32_t*>(context);
+}
+
+static void initConfiguresUsartAndStreams()
+{
+    resetHostPeripherals();
+    {
+        USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+        uint8_t buffer[8] {};
+        TEST_ASSERT(serial.transmit(buffer, 1) == USARTStatusCodes::notReadyNotReset);
+        TEST_ASSERT(serial.init() == USARTStatusCodes::Ready);
+        TEST_ASSERT(USART::getDriver(USARTInstance::_2) == &serial);
+        TEST_ASSERT(RCC->APB1ENR & RCC_APB1ENR_USART2EN);
+        TEST_ASSERT(RCC->AHB1ENR & RCC_AHB1ENR_DMA1EN);
+        // PCLK1 = 50 MHz
+        TEST_ASSERT(USART2->BRR == 434U);
+        TEST_ASSERT((USART2->CR1 & (USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE)) == (USART_CR1_UE | USART_CR1_TE | USART_CR1_RE | USART_CR1_IDLEIE));
+        TEST_ASSERT(USART2->CR3 == (USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_EIE));
+        // PA2/PA3 on AF7, RX pulled up
+        TEST_ASSERT(((GPIOA->MODER >> 4U) & 0xFU) == 0xAU && ((GPIOA->AFR[0] >> 8U) & 0xFFU) == 0x77U);
+        TEST_ASSERT(((GPIOA->PUPDR >> 6U) & 0x3U) == static_cast<uint32_t>(GpioPUPD::pullUp));
+        TEST_ASSERT(IOPin::isAllocated(GpioPort::A, GpioPin::_2) && IOPin::isAllocated(GpioPort::A, GpioPin::_3));
+
+        TEST_ASSERT(serial.setBaudRate(usartBaudRate<USARTInstance::_2, 1000000U>) == USARTStatusCodes::Ready);
+        TEST_ASSERT(USART2->BRR == 50U);
+        // 5 Mbaud needs oversampling by 8 from 50 MHz: USARTDIV = 1.25
+        TEST_ASSERT((serial.setBaudRate(usartBaudRate<USARTInstance::_2, 5000000U, true>)) == USARTStatusCodes::Ready);
+        TEST_ASSERT(USART2->BRR == 0x12U && (USART2->CR1 & USART_CR1_OVER8) && (USART2->CR1 & USART_CR1_UE));
+        // Computed for the 100 MHz APB2 clock of USART1
+        TEST_ASSERT(serial.setBaudRate(usartBaudRate<USARTInstance::_1, 115200U>) == USARTStatusCodes::invalidBaudRate);
+
+        USART other { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 9600U> };
+        TEST_ASSERT(other.init() == USARTStatusCodes::instanceInUse);
+    }
+    // The clocks go with the last driver
+    TEST_ASSERT(USART::getDriver(USARTInstance::_2) == nullptr);
+    TEST_ASSERT(!(RCC->APB1ENR & RCC_APB1ENR_USART2EN));
+    TEST_ASSERT(!IOPin::isAllocated(GpioPort::A, GpioPin::_2));
+
+    // TX pin held by another driver
+    IOPin led { GpioPort::A, GpioPin::_2, GpioMode::output };
+    TEST_ASSERT(led.init() == IOPinStatusCodes::Ready);
+    USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+    TEST_ASSERT(serial.init() == USARTStatusCodes::pinInUse);
+}
+
+static void transmitReadsTheCallerBuffer()
+{
+    resetHostPeripherals();
+    HostSerialLine& line = *getHostSerialLine(USART2);
+    USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+    serial.init();
+
+    const std::string message { "zero-copy transmission" };
+    uint32_t completions { 0 };
+    TEST_ASSERT(serial.transmit(reinterpret_cast<const uint8_t*>(message.data()), static_cast<uint16_t>(message.size()), &countCompletion, &completions) == USARTStatusCodes::Ready);
+    TEST_ASSERT(HostBusAddresses::resolve(static_cast<uint32_t>(DMA1_Stream6->M0AR)) == message.data());
+    TEST_ASSERT(serial.isTransmitting());
+    TEST_ASSERT(serial.transmit(reinterpret_cast<const uint8_t*>(message.data()), 1) == USARTStatusCodes::busy);
+
+    stepUsart2();
+    TEST_ASSERT(std::string(line.transmitted.begin(), line.transmitted.end()) == message);
+    TEST_ASSERT(completions == 1 && !serial.isTransmitting());
+    // Flags were cleared through HIFCR
+    stepHostPeripherals();
+    TEST_ASSERT(!(DMA1->HISR & (DMA_HISR_TCIF6 | DMA_HISR_HTIF6)));
+}
+
+static void receptionIsContinuous()
+{
+    resetHostPeripherals();
+    HostSerialLine& line = *getHostSerialLine(USART2);
+    USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+    serial.init();
+
+    std::array<uint8_t, 64> buffer {};
+    ReceivedData received {};
+    TEST_ASSERT(serial.startReceiving(buffer.data(), static_cast<uint16_t>(buffer.size()), &collect, &received) == USARTStatusCodes::Ready);
+
+    // A short burst is delivered by the IDLE interrupt, in place
+    line.send(std::string { "hello" });
+    stepUsart2();
+    TEST_ASSERT(std::string(received.bytes.begin(), received.bytes.end()) == "hello");
+    TEST_ASSERT(received.views.size() == 1 && received.views[0] == buffer.data());
+
+    // Bursts across the end of the buffer arrive in order, split at the wrap
+    std::vector<uint8_t> sent { received.bytes };
+    for(uint32_t burst = 0; burst < 5; ++burst)
+    {
+        std::vector<uint8_t> bytes(40);
+        for(std::size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<uint8_t>(burst * 40U + i);
+        line.send(bytes);
+        sent.insert(sent.end(), bytes.begin(), bytes.end());
+        stepUsart2();
+    }
+    TEST_ASSERT(received.bytes == sent);
+    for(const uint8_t* view : received.views)
+        TEST_ASSERT(view >= buffer.data() && view < buffer.data() + buffer.size());
+
+    serial.stopReceiving();
+    TEST_ASSERT(!(DMA1_Stream5->CR & DMA_SxCR_EN));
+}
+
+/** @brief Errors are counted and reception goes on: a stream error restarts the stream, a line error is cleared */
+static void receptionRecoversFromErrors()
+{
+    resetHostPeripherals();
+    HostSerialLine& line = *getHostSerialLine(USART2);
+    USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 115200U> };
+    serial.init();
+
+    std::array<uint8_t, 64> buffer {};
+    ReceivedData received {};
+    serial.startReceiving(buffer.data(), static_cast<uint16_t>(buffer.size()), &collect, &received);
+    line.send(std::string { "before" });
+    stepUsart2();
+
+    // The hardware clears EN on a transfer error
+    line.send(std::string { "lost" });
+    DMA1_Stream5->CR = DMA1_Stream5->CR & ~DMA_SxCR_EN;
+    DMA1->HISR = DMA1->HISR | DMA_HISR_TEIF5;
+    DMA1_Stream5_IRQHandler();
+    TEST_ASSERT(serial.getReceiveErrors() == 1 && (DMA1_Stream5->CR & DMA_SxCR_EN));
+    stepUsart2();
+    TEST_ASSERT(std::string(received.bytes.begin(), received.bytes.end()) == "beforelost");
+    TEST_ASSERT(received.views.back() == buffer.data());
+
+    USART2->SR = USART2->SR | USART_SR_ORE;
+    USART2_IRQHandler();
+    TEST_ASSERT(serial.getReceiveErrors() == 2);
+    // Cleared by the SR then DR reads of the handler, which the host model does not see
+    USART2->SR = USART2->SR & ~USART_SR_ORE;
+    line.send(std::string { "after" });
+    stepUsart2();
+    TEST_ASSERT(std::string(received.bytes.begin(), received.bytes.end()) == "beforelostafter" && serial.getReceiveErrors() == 2);
+}
+
+static void receptionInterruptsPerByte()
+{
+    constexpr std::size_t bytes { 1U << 16U };
+    constexpr std::size_t burst { 256 };
+    resetHostPeripherals();
+    HostSerialLine& line = *getHostSerialLine(USART2);
+    USART serial { USARTInstance::_2, usartBaudRate<USARTInstance::_2, 1000000U> };
+    serial.init();
+
+    std::array<uint8_t, 512> buffer {};
+    ReceivedData received {};
+    serial.startReceiving(buffer.data(), static_cast<uint16_t>(buffer.size()), &collect, &received);
+    std::vector<uint8_t> chunk(burst);
+    const double ns = benchmarkNanoseconds(bytes / burst, [&](const std::size_t& i)
+    {
+        chunk[0] = static_cast<uint8_t>(i);
+        line.send(chunk);
+        stepUsart2();
+    });
+    TEST_ASSERT(received.bytes.size() == bytes);
+
+    std::cout << "[bench] USART2 DMA reception of " << bytes << " bytes in " << burst << "-byte bursts (host model): " << received.calls
+              << " callbacks, " << ns / burst << " ns per byte; an RXNE interrupt per byte would be " << bytes << " interrupts" << std::endl;
+}
+
+void runUSARTTests()
+{
+    initConfiguresUsartAndStreams();
+    transmitReadsTheCallerBuffer();
+    receptionIsContinuous();
+    receptionRecoversFromErrors();
+    receptionInterruptsPerByte();
+    resetHostPeripherals();
+}
@@ -1,9 +1,31 @@
 #include <iostream>
-#include <type_traits>
-#include <concepts>
+#include "TestUtils.hh"
+#include "Tests.hh"
 
 int main(void)
 {
-    std::cout << "hola " << std::endl;
-    return 0;
-}
\ No newline at end of file
+    runStaticPinTests();
+    runPinGroupTests();
+    runPinMapTests();
+    runGpioConfigBatchTests();
+    runExternalInterruptTests();
+    runAlternateFunctionMapTests();
+    runGpioWaveformTests();
+    runClockTreeTests();
+    runClockFrequenciesTests();
+    runFlashAcceleratorTests();
+    runClockGatingTests();
+    runPowerManagerTests();
+    runFlatContainerTests();
+    runContainerQueryTests();
+    runPeripheralBaseTests();
+    runShadowRegistersTests();
+    runHostSimulationTests();
+    runDMATests();
+    runUSARTTests();
+    runRingBufferTests();
+    runMemoryTransferTests();
+
+    std::cout << testChecks - testFailures << "/" << testChecks << " checks passed" << std::endl;
+    return testFailures ? 1 : 0;
+}